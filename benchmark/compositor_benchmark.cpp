@@ -0,0 +1,84 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "compositor/optimal_compositor/optimal_compositor.h"
+#include "compositor/simple_compositor/simple_compositor.h"
+#include "document/document.h"
+
+// Compares composing documents of large paragraphs by SimpleCompositor and
+// OptimalCompositor: the whole document with a new row width, then again
+// with the same one, and typing in the middle of a paragraph.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t kTextLength = 1 << 20;
+const int kEditsCount = 100;
+
+double GetMilliseconds(Clock::time_point start, size_t operations = 1) {
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+    return elapsed.count() / operations;
+}
+
+std::string MakeText(size_t paragraphLength) {
+    std::string text;
+    while (text.size() < kTextLength) {
+        for (size_t i = 0; i + 1 < paragraphLength; ++i) {
+            // words of different length make breaks matter
+            text.push_back((i * 7 + i / 5) % 11 == 0 ? ' ' : 'a' + i % 26);
+        }
+        text.push_back('\n');
+    }
+    return text;
+}
+
+void RunBenchmark(const char* name, std::shared_ptr<Compositor> compositor,
+                  const std::string& text, size_t paragraphLength) {
+    Document document(compositor);
+    std::istringstream is(text);
+    document.ImportText(is);
+    document.LoadAll();
+
+    // another row width makes the breaks of all paragraphs be found again
+    compositor->SetLeftIndent(compositor->GetLeftIndent() + 1);
+    Clock::time_point start = Clock::now();
+    compositor->Compose();
+    double compose = GetMilliseconds(start);
+
+    start = Clock::now();
+    compositor->Compose();
+    double recompose = GetMilliseconds(start);
+
+    // the cursor goes to the middle of the second paragraph
+    for (size_t i = 0; i < paragraphLength * 3 / 2; ++i) {
+        document.MoveCursorRight();
+    }
+    start = Clock::now();
+    for (int i = 0; i < kEditsCount; ++i) {
+        document.InsertChar(i % 6 == 5 ? ' ' : 'x');
+    }
+    double edit = GetMilliseconds(start, kEditsCount);
+
+    std::printf("%10zu %10s %14.1f %14.1f %14.3f   (%zu pages)\n",
+                paragraphLength, name, compose, recompose, edit,
+                document.GetPagesCount());
+}
+
+}  // namespace
+
+int main() {
+    std::printf("%10s %10s %14s %14s %14s\n", "paragraph", "compositor",
+                "new width, ms", "again, ms", "edit, ms");
+    for (size_t paragraphLength : {1000, 10000, 100000}) {
+        std::string text = MakeText(paragraphLength);
+        RunBenchmark("simple", std::make_shared<SimpleCompositor>(), text,
+                     paragraphLength);
+        RunBenchmark("optimal", std::make_shared<OptimalCompositor>(), text,
+                     paragraphLength);
+    }
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include "compositor/simple_compositor/simple_compositor.h"
+#include "document/document.h"
+#include "document/glyphs/character.h"
+#include "document/glyphs/column.h"
+#include "document/glyphs/glyph_visitor.h"
+#include "document/glyphs/page.h"
+#include "document/glyphs/row.h"
+
+// Compares the cost per character of walking the glyphs of a document and
+// finding their classes by dynamic_cast, by kinds and by a visitor, and of
+// drawing the document and moving the cursor through it.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t kTextLength = 1 << 20;
+const int kRepeats = 10;
+
+double GetNanoseconds(Clock::time_point start, size_t operations) {
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return elapsed.count() / operations;
+}
+
+void PrintResult(const char* name, double nanoseconds) {
+    std::printf("%-24s %10.2f\n", name, nanoseconds);
+}
+
+// the walks return the sum of symbols, so they are not optimized out
+
+size_t WalkByDynamicCast(Glyph& glyph) {
+    if (auto character = dynamic_cast<Character*>(&glyph)) {
+        return character->GetChar();
+    }
+    size_t sum = 0;
+    if (auto container = dynamic_cast<GlyphContainer*>(&glyph)) {
+        for (const auto& component : container->GetChildren()) {
+            sum += WalkByDynamicCast(*component);
+        }
+    }
+    return sum;
+}
+
+size_t WalkByKind(Glyph& glyph) {
+    if (Character* character = glyph.As<Character>()) {
+        return character->GetChar();
+    }
+    size_t sum = 0;
+    if (glyph.IsContainer()) {
+        for (const auto& component : glyph.GetChildren()) {
+            sum += WalkByKind(*component);
+        }
+    }
+    return sum;
+}
+
+class SumVisitor : public GlyphVisitor {
+   public:
+    size_t sum = 0;
+
+    void VisitCharacter(Character& character) override {
+        sum += character.GetChar();
+    }
+    void VisitRow(Row& row) override { VisitComponents(row); }
+    void VisitColumn(Column& column) override { VisitComponents(column); }
+    void VisitPage(Page& page) override { VisitComponents(page); }
+
+   private:
+    void VisitComponents(Glyph& glyph) {
+        for (const auto& component : glyph.GetChildren()) {
+            component->Accept(*this);
+        }
+    }
+};
+
+template <class Walk>
+void RunWalk(const char* name, Document& document, Walk walk) {
+    size_t sum = 0;
+    Clock::time_point start = Clock::now();
+    for (int i = 0; i < kRepeats; ++i) {
+        for (const auto& page : document.GetPages()) {
+            sum += walk(*page);
+        }
+    }
+    PrintResult(name, GetNanoseconds(start, kRepeats * kTextLength));
+    if (sum == 0) {
+        std::printf("no characters\n");
+    }
+}
+
+}  // namespace
+
+int main() {
+    std::string text;
+    for (size_t i = 0; i < kTextLength; ++i) {
+        text.push_back(i % 97 == 96 ? '\n' : 'a' + i % 26);
+    }
+    Document document(std::make_shared<SimpleCompositor>());
+    std::istringstream is(text);
+    document.ImportText(is);
+    document.LoadAll();
+
+    std::printf("%-24s %10s\n", "operation", "ns/char");
+    RunWalk("walk, dynamic_cast", document, WalkByDynamicCast);
+    RunWalk("walk, kinds", document, WalkByKind);
+    RunWalk("walk, visitor", document, [](Glyph& page) {
+        SumVisitor visitor;
+        page.Accept(visitor);
+        return visitor.sum;
+    });
+
+    // the cursor starts before the first character; the document is not drawn
+    // yet, so moves don't collect dirty areas and only navigation is measured
+    const size_t moves = kTextLength / 4;
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < moves; ++i) {
+        document.MoveCursorRight();
+    }
+    PrintResult("move cursor right", GetNanoseconds(start, moves));
+    if (document.GetCursorOffset() == 0) {
+        std::printf("the cursor has not moved\n");
+    }
+
+    start = Clock::now();
+    for (int i = 0; i < kRepeats; ++i) {
+        document.DrawDocument();
+    }
+    PrintResult("draw", GetNanoseconds(start, kRepeats * kTextLength));
+    return 0;
+}
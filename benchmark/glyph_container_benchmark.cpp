@@ -0,0 +1,73 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+
+#include "document/glyphs/character.h"
+#include "document/glyphs/row.h"
+
+// Measures walking over the children of a row, as DrawDocument and the
+// compositor do, for rows of different length.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double GetNanoseconds(Clock::time_point start, size_t operations) {
+    std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+    return elapsed.count() / operations;
+}
+
+std::shared_ptr<Row> MakeRow(int glyphsCount) {
+    auto row = std::make_shared<Row>(0, 0, glyphsCount, 1);
+    for (int i = 0; i < glyphsCount; ++i) {
+        row->Add(std::make_shared<Character>(i, 0, 1, 1, 'a' + i % 26));
+    }
+    return row;
+}
+
+void RunBenchmark(int glyphsCount) {
+    std::shared_ptr<Row> row = MakeRow(glyphsCount);
+    // repeat short rows to get measurable time
+    int repeats = 1000000 / glyphsCount + 1;
+    long checksum = 0;
+
+    Clock::time_point start = Clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (Glyph::GlyphPtr glyph = row->GetFirstGlyph(); glyph != nullptr;
+             glyph = row->GetNextGlyph(glyph)) {
+            checksum += glyph->GetWidth();
+        }
+    }
+    double next = GetNanoseconds(start, size_t(repeats) * glyphsCount);
+
+    start = Clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (Glyph::GlyphPtr glyph = row->GetLastGlyph(); glyph != nullptr;
+             glyph = row->GetPreviousGlyph(glyph)) {
+            checksum += glyph->GetWidth();
+        }
+    }
+    double previous = GetNanoseconds(start, size_t(repeats) * glyphsCount);
+
+    start = Clock::now();
+    for (int r = 0; r < repeats; ++r) {
+        for (int i = 0; i < glyphsCount; ++i) {
+            checksum += row->GetGlyphByIndex(i)->GetWidth();
+        }
+    }
+    double byIndex = GetNanoseconds(start, size_t(repeats) * glyphsCount);
+
+    std::printf("%8d %16.1f %16.1f %16.1f   (%ld)\n", glyphsCount, next,
+                previous, byIndex, checksum);
+}
+
+}  // namespace
+
+int main() {
+    std::printf("%8s %16s %16s %16s\n", "glyphs", "next, ns/glyph",
+                "previous, ns/glyph", "index, ns/glyph");
+    for (int glyphsCount : {100, 1000, 10000}) {
+        RunBenchmark(glyphsCount);
+    }
+    return 0;
+}
@@ -37,8 +37,30 @@ class Compositor {
 
     void SetDocument(Document* document);
 
+    /**
+     * @brief           Composes the whole document and marks it as changed.
+     */
     virtual void Compose() = 0;
 
+    /**
+     * @brief           Recomposes the document after the glyph has been
+     * inserted into or removed from the page. The areas of the glyphs that
+     * have been moved are marked as changed in the document. By default the
+     * whole document is composed again.
+     * @param page      Page the glyph was inserted into or removed from.
+     * @param glyph     Pointer to the inserted or removed glyph.
+     */
+    virtual void Compose(const Page::PagePtr& page,
+                         const Glyph::GlyphPtr& glyph);
+
+    /**
+     * @brief           Creates a compositor of the same class with the same
+     * settings. It is not set to a document and keeps nothing of the
+     * composed layout.
+     * @return          Shared pointer to the new compositor.
+     */
+    virtual std::shared_ptr<Compositor> Clone() const = 0;
+
     void SetTopIndent(int value);
     void SetBottomIndent(int value);
     void SetLeftIndent(int value);
@@ -46,8 +68,17 @@ class Compositor {
     void SetAlignment(Alignment value);
     void SetLineSpacing(int value);
 
+    int GetTopIndent() const;
+    int GetBottomIndent() const;
+    int GetLeftIndent() const;
+    int GetRightIndent() const;
+    Alignment GetAlignment() const;
+    int GetLineSpacing() const;
+
    protected:
     Document* document;
+    // false until the document is composed with the current settings
+    bool isLayoutValid = false;
 
     int topIndent;
     int bottomIndent;
@@ -61,11 +92,9 @@ class Compositor {
     template<class Archive>
     void serialize(Archive &ar, const unsigned int version)
     {
-        std::cout << "0 Compositor\n";
         ar & document;
         ar & topIndent & bottomIndent & leftIndent;
         ar & rightIndent & alignment & lineSpacing;
-        std::cout << "1 Compositor\n";
     }
 
 };
@@ -0,0 +1,142 @@
+#ifndef TEXT_EDITOR_OPTIMALCOMPOSITOR_H_
+#define TEXT_EDITOR_OPTIMALCOMPOSITOR_H_
+
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/export.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "compositor/simple_compositor/simple_compositor.h"
+
+/**
+ * Compositor breaking paragraphs into rows by total fit: the breaks of a
+ * paragraph are chosen together so that the sum of squared free space of
+ * its rows except the last one is minimal. Rows break after spaces, and
+ * inside a word only if it is wider than the row.
+ *
+ * Breaks of paragraphs are cached by their content and the row width, so
+ * only the edited paragraph is solved again after an edit.
+ */
+class OptimalCompositor : public SimpleCompositor {
+   public:
+    explicit OptimalCompositor() : SimpleCompositor() {}
+
+    explicit OptimalCompositor(int topIndent, int bottomIndent,
+                               int leftIndent, int rightIndent,
+                               Alignment alignment, int lineSpacing)
+        : SimpleCompositor(topIndent, bottomIndent, leftIndent, rightIndent,
+                           alignment, lineSpacing) {}
+
+    ~OptimalCompositor() override = default;
+
+    void Compose() override;
+
+    /**
+     * @brief           Breaks the paragraph with the edited glyph again. If
+     * it keeps the number of rows, only its rows whose characters change are
+     * filled again, otherwise the rows below it are moved as well.
+     * @param page      Page the glyph was inserted into or removed from.
+     * @param glyph     Pointer to the inserted or removed glyph.
+     */
+    void Compose(const Page::PagePtr& page,
+                 const Glyph::GlyphPtr& glyph) override;
+
+    /**
+     * @brief           Creates a compositor with the same settings and an
+     * empty cache of breaks, sharing the thread pool with this one.
+     */
+    std::shared_ptr<Compositor> Clone() const override;
+
+    /**
+     * @brief           Returns number of paragraphs whose breaks have been
+     * found rather than taken from the cache.
+     */
+    size_t GetSolvedParagraphsCount() const;
+    size_t GetCachedParagraphsCount() const;
+
+   protected:
+    size_t BreakRow(const GlyphContainer::GlyphList& list, int width) override;
+
+   private:
+    /**
+     * Paragraph of the cache: hash of its symbols and widths, its length and
+     * the row width.
+     */
+    struct ParagraphKey {
+        uint64_t hash;
+        size_t length;
+        int width;
+
+        bool operator==(const ParagraphKey& key) const;
+    };
+
+    struct ParagraphKeyHash {
+        size_t operator()(const ParagraphKey& key) const;
+    };
+
+    struct CachedBreaks {
+        // number of characters in each row of the paragraph
+        std::vector<size_t> rowLengths;
+        std::list<ParagraphKey>::iterator use;
+    };
+
+    // lengths of the rows left of the paragraph being composed
+    std::deque<size_t> pendingBreaks;
+    std::unordered_map<ParagraphKey, CachedBreaks, ParagraphKeyHash> cache;
+    // keys of the cache, the least recently used are at the end
+    std::list<ParagraphKey> uses;
+    size_t cachedRowsCount = 0;
+    size_t solvedCount = 0;
+
+    /**
+     * @brief           Finds lengths of the rows of the paragraph or takes
+     * them from the cache.
+     * @param first     Iterator to the first character of the paragraph.
+     * @param last      Iterator after the last character of the paragraph.
+     * @param width     Width of the rows.
+     * @param rowLengths    Vector the lengths are appended to.
+     */
+    template <class Iterator>
+    void BreakParagraph(Iterator first, Iterator last, int width,
+                        std::vector<size_t>& rowLengths);
+
+    /**
+     * @brief           Finds lengths of the rows of all paragraphs of the
+     * characters.
+     */
+    template <class Iterator>
+    std::vector<size_t> BreakParagraphs(Iterator first, Iterator last,
+                                        int width);
+
+    /**
+     * @brief           Finds the total fit breaks of a paragraph.
+     * @param widths    Widths of the characters, none of them wider than the
+     * row.
+     * @param isSpace   Whether a row can break after the character.
+     * @param width     Width of the rows.
+     * @return          Number of characters in each row.
+     */
+    static std::vector<size_t> Solve(const std::vector<int>& widths,
+                                     const std::vector<bool>& isSpace,
+                                     int width);
+
+    /**
+     * @brief           Drops the least recently used paragraphs while the
+     * cache holds too many rows.
+     */
+    void TrimCache();
+
+    friend class boost::serialization::access;
+    template <class Archive>
+    void serialize(Archive& ar, const unsigned int version) {
+        ar& boost::serialization::base_object<SimpleCompositor>(*this);
+    }
+};
+BOOST_CLASS_EXPORT_KEY(OptimalCompositor)
+
+#endif  // TEXT_EDITOR_OPTIMALCOMPOSITOR_H_
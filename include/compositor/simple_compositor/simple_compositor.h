@@ -8,6 +8,7 @@
 
 #include "compositor/compositor.h"
 #include "document/document.h"
+#include "utils/thread_pool.h"
 
 class SimpleCompositor : public Compositor {
    public:
@@ -25,17 +26,124 @@ class SimpleCompositor : public Compositor {
 
     void Compose() override;
 
+    /**
+     * @brief           Sets the pool the whole document is composed with. Line
+     * breaks are found sequentially, then characters of the rows are placed
+     * in parallel, so the layout is the same as without the pool.
+     * @param threadPool    Pointer to the pool or nullptr to compose on the
+     * calling thread only.
+     */
+    void SetThreadPool(std::shared_ptr<ThreadPool> threadPool);
+    std::shared_ptr<ThreadPool> GetThreadPool() const;
+
+    /**
+     * @brief           Recomposes only the rows affected by the edit. Reflow
+     * starts from the row preceding the edited one and stops as soon as line
+     * breaks match the previous layout again, so untouched pages, columns and
+     * rows are left alone.
+     * @param page      Page the glyph was inserted into or removed from.
+     * @param glyph     Pointer to the inserted or removed glyph.
+     */
+    void Compose(const Page::PagePtr& page,
+                 const Glyph::GlyphPtr& glyph) override;
+
+    /**
+     * @brief           Creates a compositor with the same settings sharing
+     * the thread pool with this one.
+     */
+    std::shared_ptr<Compositor> Clone() const override;
+
+   protected:
+    /**
+     * Location of a row in the document.
+     */
+    struct RowPosition {
+        Page::PagePtr page;
+        Glyph::GlyphPtr column;
+        Glyph::GlyphPtr row;
+    };
+
+    /**
+     * @brief           Chooses how many characters from the beginning of the
+     * list go to the row. Characters wider than the row count as wide as the
+     * row. By default the row is filled greedily till the next character
+     * doesn't fit or the paragraph ends.
+     * @param list      Characters left to be composed.
+     * @param width     Width of the row.
+     * @return          Number of characters, at least one if the list is not
+     * empty.
+     */
+    virtual size_t BreakRow(const GlyphContainer::GlyphList& list, int width);
+
+    /**
+     * @brief           Fills the row with the characters from the list and
+     * places them, or leaves placing them till the end of composition.
+     */
+    void ComposeRow(Glyph::GlyphPtr& row, int x, int y, int width,
+                    GlyphContainer::GlyphList& list);
+
+    /**
+     * @brief           Continues composition of the document from the row
+     * exactly as Compose() would do it.
+     * @param position  The row to continue from.
+     * @param y         Vertical coordinate of the row.
+     * @param list      Characters left to be composed.
+     */
+    void ComposeTail(RowPosition& position, int y,
+                     GlyphContainer::GlyphList& list);
+
+    /**
+     * @brief           Checks whether the glyph is a newline character, the
+     * row it is placed in ends after it.
+     */
+    static bool IsLineBreak(const Glyph::GlyphPtr& glyph);
+
+    bool FindRow(const Page::PagePtr& page, const Glyph::GlyphPtr& glyph,
+                 RowPosition& position);
+    bool GetNextRow(RowPosition& position);
+    bool GetPreviousRow(RowPosition& position);
+
+    void CutCharacters(Glyph::GlyphPtr& row, GlyphContainer::GlyphList& list);
+
    private:
+    std::shared_ptr<ThreadPool> threadPool;
+    // rows filled by the composition whose characters are placed at its end
+    Glyph::GlyphVector deferredRows;
+    bool isPlacingDeferred = false;
+    // characters going to the row being filled
+    Glyph::GlyphVector rowCharacters;
+
+    void ComposePages(Page::PagePtr page, GlyphContainer::GlyphList& list);
     void ComposePage(Page::PagePtr& page, GlyphContainer::GlyphList& list);
+    void ComposeColumns(Page::PagePtr& page, Glyph::GlyphPtr column, int x,
+                        GlyphContainer::GlyphList& list);
     void ComposeColumn(Glyph::GlyphPtr& column, int x, int y, int width,
                        int height, GlyphContainer::GlyphList& list);
-    void ComposeRow(Glyph::GlyphPtr& row, int x, int y, int width,
-                    GlyphContainer::GlyphList& list);
-    void ComposeCharacter(Glyph::GlyphPtr& character, int x, int y);
+    void ComposeRows(Glyph::GlyphPtr& column, Glyph::GlyphPtr row, int y,
+                     GlyphContainer::GlyphList& list);
+
+    /**
+     * @brief           Places characters of the row due to the alignment.
+     * Changes only the characters, so rows can be placed concurrently.
+     */
+    void PlaceCharacters(Glyph::GlyphPtr& row);
+
+    /**
+     * @brief           Places characters of the rows filled during
+     * composition on the threads of the pool.
+     */
+    void PlaceDeferredRows();
+    void ComposeCharacter(const Glyph::GlyphPtr& character, int x, int y);
+
+    int GetColumnWidth(const Page::PagePtr& page) const;
+    int GetListWidth(const GlyphContainer::GlyphList& list,
+                     int rowWidth) const;
 
-    size_t GetNestedGlyphsCount(Glyph::GlyphPtr& glyph);
-    int GetNestedGlyphsWidth(Glyph::GlyphPtr& glyph);
-    int GetNestedGlyphsHeight(Glyph::GlyphPtr& glyph);
+    /**
+     * @brief           Checks whether the characters end with a newline, so
+     * no characters of the following rows can join them.
+     */
+    static bool EndsParagraph(const GlyphContainer::GlyphList& list);
 
     GlyphContainer::GlyphList CutAllCharacters();
 
@@ -43,9 +151,7 @@ class SimpleCompositor : public Compositor {
     template<class Archive>
     void serialize(Archive &ar, const unsigned int version)
     {
-        std::cout << "0 SimpleCompositor\n";
         ar & boost::serialization::base_object<Compositor>(*this);
-        std::cout << "1 SimpleCompositor\n";
     }
 };
 BOOST_CLASS_EXPORT_KEY(SimpleCompositor)
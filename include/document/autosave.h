@@ -0,0 +1,88 @@
+#ifndef TEXT_EDITOR_AUTOSAVE_H_
+#define TEXT_EDITOR_AUTOSAVE_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+#include "document.h"
+#include "utils/latest_task_worker.h"
+
+/**
+ * Saves the document in the background. The editing thread only takes a
+ * snapshot of the document, it is written on a worker thread into a temporary
+ * file which then replaces the saved one. So the file always contains a
+ * complete document, and editing continues while it is written.
+ */
+class Autosave {
+   public:
+    struct Metrics {
+        size_t savesCount = 0;
+        size_t failuresCount = 0;
+        // snapshots replaced by newer ones before they were written
+        size_t skippedCount = 0;
+        // time the editing thread has spent on taking a snapshot
+        std::chrono::microseconds lastSnapshotTime{0};
+        std::chrono::microseconds maxSnapshotTime{0};
+        // time from taking a snapshot till the file is replaced
+        std::chrono::microseconds lastSaveLatency{0};
+        std::chrono::microseconds maxSaveLatency{0};
+    };
+
+    /**
+     * @brief           Called on the worker thread after a snapshot has been
+     * written, so the saved file can be used before the next one replaces
+     * it.
+     * @param number    Number of the save returned by Save.
+     * @param isWritten Whether the file has been replaced.
+     */
+    using Callback = std::function<void(uint64_t number, bool isWritten)>;
+
+    /**
+     * @param path      Path to the file the document is saved in.
+     * @param saved     Callback for the written snapshots, may be empty.
+     */
+    explicit Autosave(std::string path, Callback saved = nullptr);
+
+    /**
+     * @brief           Writes the pending snapshot and stops the worker.
+     */
+    ~Autosave() = default;
+
+    Autosave(const Autosave&) = delete;
+    Autosave& operator=(const Autosave&) = delete;
+
+    /**
+     * @brief           Takes a snapshot of the document and schedules writing
+     * it. If the previous snapshot is not being written yet, it is replaced.
+     * @param document  The document.
+     * @return          Number of the save, it grows with every call.
+     */
+    uint64_t Save(const Document& document);
+
+    /**
+     * @brief           Waits till all scheduled snapshots are written.
+     */
+    void Flush();
+
+    Metrics GetMetrics() const;
+    const std::string& GetPath() const;
+
+   private:
+    using Worker = LatestTaskWorker<DocumentSnapshot>;
+
+    std::string path;
+    Callback saved;
+    mutable std::mutex mutex;
+    Metrics metrics;
+    // stopped first, while the members its tasks use still exist
+    Worker worker;
+
+    void Write(DocumentSnapshot& snapshot, uint64_t number,
+               Worker::Clock::time_point taken);
+};
+
+#endif  // TEXT_EDITOR_AUTOSAVE_H_
@@ -0,0 +1,105 @@
+#ifndef TEXT_EDITOR_BACKGROUND_COMPOSITOR_H_
+#define TEXT_EDITOR_BACKGROUND_COMPOSITOR_H_
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+#include "document_snapshot.h"
+#include "layout_snapshot.h"
+#include "utils/latest_task_worker.h"
+
+class Document;
+
+/**
+ * Composes the document on a worker thread. The editing thread only takes a
+ * snapshot of the document content, the worker repeats the changes of the
+ * text on glyphs of its own, composes only their rows and publishes their
+ * places as a layout sharing the unchanged pages with the previous one. If
+ * the document is edited faster than it is composed, only the latest
+ * snapshot is composed and the intermediate ones are dropped.
+ */
+class BackgroundCompositor {
+   public:
+    struct Metrics {
+        size_t composedCount = 0;
+        // snapshots replaced by newer ones before they were composed
+        size_t skippedCount = 0;
+        // time the editing thread has spent on taking a snapshot
+        std::chrono::microseconds lastSnapshotTime{0};
+        std::chrono::microseconds maxSnapshotTime{0};
+        // time from taking a snapshot till its layout is published
+        std::chrono::microseconds lastComposeLatency{0};
+        std::chrono::microseconds maxComposeLatency{0};
+    };
+
+    BackgroundCompositor();
+
+    /**
+     * @brief           Drops the pending snapshot and stops the worker.
+     */
+    ~BackgroundCompositor();
+
+    BackgroundCompositor(const BackgroundCompositor&) = delete;
+    BackgroundCompositor& operator=(const BackgroundCompositor&) = delete;
+
+    /**
+     * @brief           Takes a snapshot of the document and schedules
+     * composing it. If the previous snapshot is not being composed yet, it is
+     * replaced and its change is merged with the new one.
+     * @param document  The document.
+     * @param change    Change of the text since the previous snapshot.
+     */
+    void Submit(const Document& document, const TextChange& change);
+
+    /**
+     * @brief           Waits till all scheduled snapshots are composed.
+     */
+    void Flush();
+
+    /**
+     * @brief           Returns the latest composed layout or nullptr if none
+     * has been composed yet.
+     */
+    std::shared_ptr<const LayoutSnapshot> GetLayout() const;
+
+    Metrics GetMetrics() const;
+
+   private:
+    // snapshot with the change of the text since the snapshot composed last
+    // time
+    struct Task {
+        DocumentSnapshot snapshot;
+        TextChange change;
+    };
+
+    using Worker = LatestTaskWorker<Task>;
+
+    mutable std::mutex mutex;
+    std::shared_ptr<const LayoutSnapshot> layout;
+    Metrics metrics;
+    // glyphs of the composed snapshot, used only by the worker
+    std::unique_ptr<Document> document;
+    // stopped first, while the members its tasks use still exist
+    Worker worker;
+
+    /**
+     * @brief           Composes the snapshot of the task on the worker and
+     * replaces the published layout by its one.
+     * @param task      The task.
+     * @param taken     Time the snapshot has been taken at.
+     */
+    void Publish(Task& task, Worker::Clock::time_point taken);
+
+    /**
+     * @brief           Makes the change of the snapshot to the composed
+     * glyphs, or composes them anew with a copy of the compositor of the
+     * snapshot if the whole text or the compositor has changed.
+     * @return          Places of the characters of the snapshot.
+     */
+    std::shared_ptr<const LayoutSnapshot> Compose(DocumentSnapshot snapshot,
+                                                  const TextChange& change);
+};
+
+#endif  // TEXT_EDITOR_BACKGROUND_COMPOSITOR_H_
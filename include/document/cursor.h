@@ -0,0 +1,24 @@
+#ifndef TEXT_EDITOR_CURSOR_H_
+#define TEXT_EDITOR_CURSOR_H_
+
+#include <cstddef>
+
+/**
+ * Logical position of a cursor in the text of a document. It refers to no
+ * glyphs, so composing the document never changes it, and its place on a
+ * page is found from the glyphs only when it is drawn.
+ */
+struct Cursor {
+    /**
+     * Side the cursor keeps to when its offset is on a row boundary: after
+     * the character before it at the end of the previous row, or before the
+     * character after it at the beginning of the next row.
+     */
+    enum Affinity { UPSTREAM, DOWNSTREAM };
+
+    // number of characters before the cursor
+    size_t offset = 0;
+    Affinity affinity = UPSTREAM;
+};
+
+#endif  // TEXT_EDITOR_CURSOR_H_
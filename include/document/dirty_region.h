@@ -0,0 +1,60 @@
+#ifndef TEXT_EDITOR_DIRTY_REGION_H_
+#define TEXT_EDITOR_DIRTY_REGION_H_
+
+#include <unordered_map>
+#include <vector>
+
+#include "glyphs/glyph.h"
+#include "utils/rect.h"
+
+/**
+ * Areas of pages changed since they were drawn last time. Areas of a page
+ * are coalesced: a rectangle touching a dirty one is joined with it, so edits
+ * next to each other give a single area. Coordinates are relative to the
+ * page.
+ */
+class DirtyRegion {
+   public:
+    /**
+     * @brief           Marks the area of the page as changed.
+     * @param page      Page the area belongs to.
+     * @param rect      Changed area.
+     */
+    void Add(const Glyph* page, const Rect& rect);
+
+    /**
+     * @brief           Marks all pages as changed, areas added after that are
+     * ignored till the region is cleared.
+     */
+    void AddAll();
+
+    /**
+     * @brief           Forgets the areas of the page that are contained in the
+     * drawn rectangle. Areas crossing its border stay dirty as a whole.
+     * @param page      Page the area belongs to.
+     * @param drawn     Area that has been drawn.
+     */
+    void Remove(const Glyph* page, const Rect& drawn);
+
+    /**
+     * @brief           Forgets all areas of the page, e.g. when the page is
+     * removed from the document.
+     */
+    void RemovePage(const Glyph* page);
+
+    /**
+     * @brief           Returns coalesced areas of the page. Doesn't take into
+     * account that all pages may be dirty.
+     */
+    const std::vector<Rect>& GetRects(const Glyph* page) const;
+
+    bool IsAllDirty() const;
+    bool IsEmpty() const;
+    void Clear();
+
+   private:
+    std::unordered_map<const Glyph*, std::vector<Rect>> pages;
+    bool isAllDirty = false;
+};
+
+#endif  // TEXT_EDITOR_DIRTY_REGION_H_
@@ -5,10 +5,27 @@
 #include <boost/serialization/assume_abstract.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
+#include <cstdint>
 #include <functional>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
+#include "cursor.h"
+#include "dirty_region.h"
+#include "document_snapshot.h"
+#include "document_walker.h"
+#include "glyphs/character_factory.h"
 #include "glyphs/glyph.h"
 #include "glyphs/page.h"
+#include "layout_snapshot.h"
+#include "memory_pool.h"
+#include "renderer/null_renderer/null_renderer.h"
+#include "text_buffer.h"
 
 const int pageWidth = 500;
 const int pageHeight = 1000;
@@ -26,30 +43,126 @@ class IDocument {
     virtual void CutGlyphs(const Point& start, const Point& end) = 0;
     virtual void InsertChar(char symbol) = 0;
     virtual char RemoveChar() = 0;
+    virtual void InsertText(const std::string& text) = 0;
+    virtual std::string RemoveRange(size_t begin, size_t end) = 0;
     virtual void DrawDocument() = 0;
     virtual ~IDocument() = default;
     virtual void MoveCursorLeft() = 0;
     virtual void MoveCursorRight() = 0;
+    virtual size_t GetCursorOffset() const = 0;
+    virtual void SetCursorOffset(size_t offset) = 0;
+    virtual void BeginBatch() = 0;
+    virtual void EndBatch() = 0;
 
    private:
     friend class boost::serialization::access;
     template <class Archive>
-    void serialize(Archive& ar, const unsigned int version) {
-        std::cout << "IDocument\n";
-    }
+    void serialize(Archive& ar, const unsigned int version) {}
 };
 BOOST_SERIALIZATION_ASSUME_ABSTRACT(IDocument)
 
+class BackgroundCompositor;
 class Compositor;
+class Character;
 
-class Document : public IDocument {
+class Document : public IDocument, private CharactersCountListener {
    public:
     using PageList = std::list<Page::PagePtr>;
 
     explicit Document(std::shared_ptr<Compositor> compositor);
+    ~Document() override;
 
     void SetCompositor(std::shared_ptr<Compositor> compositor);
-    std::shared_ptr<Compositor> GetCompositor();
+    std::shared_ptr<Compositor> GetCompositor() const;
+
+    /**
+     * @brief           Sets the device the document is drawn on.
+     * @param renderer  Pointer to the renderer.
+     */
+    void SetRenderer(std::shared_ptr<Renderer> renderer);
+    std::shared_ptr<Renderer> GetRenderer() const;
+
+    /**
+     * @brief           Switches the document to composing in the background.
+     * Edits at the cursor and of ranges change only the text and submit it
+     * to the background compositor, and the document is drawn from the
+     * latest layout it has completed. The glyphs catch up with the text when
+     * they are requested, and glyphs found by position are composed first,
+     * as their places are not updated after edits.
+     * @param backgroundCompositor  Pointer to the background compositor or
+     * nullptr to compose edits at once again.
+     */
+    void SetBackgroundCompositor(
+        std::shared_ptr<BackgroundCompositor> backgroundCompositor);
+    std::shared_ptr<BackgroundCompositor> GetBackgroundCompositor() const;
+
+    /**
+     * @brief           Returns number of changes of the document. Layouts
+     * composed in the background are marked with it.
+     */
+    uint64_t GetVersion() const;
+
+    /**
+     * @brief           Collects places of the characters of the composed
+     * pages.
+     */
+    LayoutSnapshot GetLayout() const;
+
+    /**
+     * @brief           Collects places of the characters as GetLayout, but
+     * only the pages changed since the previous call are collected again, the
+     * others are shared with the previous layout. Changes are found by the
+     * areas marked for drawing, so the document is not drawn between calls.
+     */
+    LayoutSnapshot UpdateLayout();
+
+    /**
+     * @brief           Checks whether the document has been changed since it
+     * was drawn last time or a newer layout has been composed in the
+     * background. Changes don't draw the document by themselves.
+     */
+    bool IsRedrawNeeded() const;
+
+    /**
+     * @brief           Draws the loaded pages of the document with the
+     * renderer. The rest of the text is not composed for it.
+     */
+    void DrawDocument() override;
+
+    /**
+     * @brief           Draws again only the changed rows that are visible.
+     * Pages are placed one under another, so page i occupies vertical
+     * coordinates from i * pageHeight of the document. Changes outside the
+     * viewport stay dirty till they become visible. When the document is
+     * composed in the background, the whole latest layout is drawn.
+     * @param viewport  Visible area in the document coordinates.
+     */
+    void Redraw(const Rect& viewport);
+
+    /**
+     * @brief           Marks the area occupied by the glyph as changed. Used by
+     * the compositor for the rows it places.
+     * @param glyph     Pointer to the glyph placed on a page of the document.
+     */
+    void Invalidate(const Glyph::GlyphPtr& glyph);
+    void Invalidate(const Glyph* glyph);
+
+    /**
+     * @brief           Marks the whole document as changed.
+     */
+    void InvalidateAll();
+
+    /**
+     * @brief           Starts a batch of edits. Edits in a batch are not
+     * composed, the document is composed once when the batch ends. Batches
+     * can be nested, only the outer one composes.
+     */
+    void BeginBatch() override;
+
+    /**
+     * @brief           Ends the batch of edits and composes them.
+     */
+    void EndBatch() override;
 
     /**
      * @brief           Moves the cursor one character to the right.
@@ -78,6 +191,36 @@ class Document : public IDocument {
      */
     char RemoveChar();
 
+    /**
+     * @brief           Creates and inserts characters into the document next
+     * to the cursor and moves the cursor after them. All of them are put into
+     * the row of the cursor at once and composed once.
+     * @param symbols   Symbols of the characters.
+     */
+    void InsertText(const std::string& symbols) override;
+
+    /**
+     * @brief           Removes characters of the document at once and places
+     * the cursor where they were.
+     * @param begin     Offset of the first removed character.
+     * @param end       Offset after the last removed character.
+     * @return          Symbols of the removed characters.
+     */
+    std::string RemoveRange(size_t begin, size_t end) override;
+
+    /**
+     * @brief           Replaces characters of the document at once and places
+     * the cursor after the inserted ones. Only the rows of the replaced
+     * characters are composed.
+     * @param begin     Offset of the first replaced character.
+     * @param end       Offset after the last replaced character.
+     * @param symbols   Symbols of the inserted characters.
+     * @param runs      Sizes of the inserted characters, their counts sum up
+     * to the number of symbols.
+     */
+    void ReplaceRange(size_t begin, size_t end, const std::string& symbols,
+                      const std::vector<CharacterRun>& runs);
+
     /**
      * @brief           Remove glyph from the document by pointer.
      * @param glyph     Pointer to the glyph.
@@ -108,9 +251,20 @@ class Document : public IDocument {
      */
     void CutGlyphs(const Point& start, const Point& end);
 
+    /**
+     * @brief           Returns glyphs selected by SelectGlyphs or CutGlyphs,
+     * they are inserted by PasteGlyphs.
+     */
+    const GlyphContainer::GlyphList& GetSelectedGlyphs() const;
+    void SetSelectedGlyphs(GlyphContainer::GlyphList glyphs);
+
     void SetCurrentPage(Page::PagePtr page);
     Page::PagePtr GetCurrentPage();
 
+    /**
+     * @brief           Finds the glyph edits at the cursor are made after: the
+     * character before the cursor or the first row if there is none.
+     */
     Glyph::GlyphPtr GetSelectedGlyph();  // will be deleted
 
     size_t GetPagesCount() const;
@@ -119,33 +273,395 @@ class Document : public IDocument {
 
     void AddPage(const Page::PagePtr& page);
 
+    /**
+     * @brief           Returns characters of the document in the order they
+     * are placed on pages.
+     */
+    const TextBuffer& GetText() const;
+
+    /**
+     * @brief           Returns number of characters before the cursor.
+     */
+    size_t GetCursorOffset() const override;
+
+    /**
+     * @brief           Moves the cursor to the offset in the text. The cursor
+     * keeps to the character before it.
+     * @param offset    Number of characters before the cursor.
+     */
+    void SetCursorOffset(size_t offset) override;
+
+    Cursor GetCursor() const;
+
+    /**
+     * @brief           Moves the cursor to the position in the text.
+     * @param cursor    Offset and affinity of the cursor.
+     */
+    void SetCursor(const Cursor& cursor);
+
+    /**
+     * @brief           Returns sizes of the characters in the document order.
+     * @return          Runs of characters of the same size.
+     */
+    std::vector<CharacterRun> GetCharacterRuns() const;
+
+    /**
+     * @brief           Copies the content of the document for saving. The
+     * text shares its pieces with the document, so it takes O(1) and can be
+     * done between edits without a pause.
+     */
+    DocumentSnapshot GetSnapshot() const;
+
+    /**
+     * @brief           Replaces all characters of the document. Glyphs are
+     * created and composed lazily: at once only for the first pages and the
+     * cursor, and for the rest when their pages are requested or drawn.
+     * @param text      Symbols of the characters in the document order.
+     * @param runs      Sizes of the characters, their counts sum up to the
+     * length of the text.
+     * @param cursorOffset  Number of characters before the cursor.
+     * @param pagesCount    Number of pages composed at once.
+     */
+    void SetCharacters(TextBuffer text, const std::vector<CharacterRun>& runs,
+                       size_t cursorOffset, size_t pagesCount = 1);
+
+    /**
+     * @brief           Replaces all characters of the document with the text
+     * that keeps their sizes.
+     */
+    void SetCharacters(TextBuffer text, size_t cursorOffset,
+                       size_t pagesCount = 1);
+
+    /**
+     * @brief           Replaces all characters of the document with plain text
+     * read from the stream in chunks. Bytes are kept as they are, so UTF-8
+     * text is exported back unchanged, and every newline ends its row. Glyphs
+     * are created lazily as by SetCharacters.
+     * @param is        Input stream.
+     * @param pagesCount    Number of pages composed at once.
+     * @return          Whether the whole stream has been read, otherwise the
+     * document is left unchanged.
+     */
+    bool ImportText(std::istream& is, size_t pagesCount = 1);
+
+    /**
+     * @brief           Writes all characters of the document to the stream as
+     * plain text, including the ones that have no glyphs yet.
+     * @param os        Output stream.
+     * @return          Whether the text has been written.
+     */
+    bool ExportText(std::ostream& os) const;
+
+    /**
+     * @brief           Checks whether all characters of the text have glyphs
+     * placed on pages. Otherwise pages hold only the beginning of the text.
+     */
+    bool IsLoaded() const;
+
+    /**
+     * @brief           Composes pages till the specified number of them is
+     * complete or all characters are loaded.
+     * @param count     Number of pages.
+     */
+    void LoadPages(size_t count);
+
+    /**
+     * @brief           Creates and composes glyphs of all characters.
+     */
+    void LoadAll();
+
+    /**
+     * @brief           Returns the pool in which glyphs of the document are
+     * allocated.
+     */
+    const std::shared_ptr<MemoryPool>& GetGlyphPool() const;
+
+    const PageList& GetPages() const;
+
+    /**
+     * @brief           Returns rows of all pages in reading order.
+     */
+    DocumentRange GetRows() const;
+
+    /**
+     * @brief           Returns characters of all pages in reading order.
+     */
+    DocumentRange GetCharacters() const;
+
     Page::PagePtr GetFirstPage();
     Page::PagePtr GetNextPage(const Page::PagePtr& pagePtr);
+    Page::PagePtr GetPreviousPage(const Page::PagePtr& pagePtr);
 
    private:
     int currentCharSize = 1;
+    // glyphs created by the document and its compositor
+    std::shared_ptr<MemoryPool> glyphPool = std::make_shared<MemoryPool>();
+    CharacterFactory characterFactory{glyphPool};
     std::shared_ptr<Compositor> compositor;
+    std::shared_ptr<Renderer> renderer = std::make_shared<NullRenderer>();
+    // areas changed since the document was drawn
+    DirtyRegion dirtyRegion;
     Page::PagePtr currentPage;
     PageList pages;
-    Glyph::GlyphPtr selectedGlyph;
+    // numbers of characters of the pages in their order, so characters are
+    // found by offsets in O(log n); rebuilt when pages are added or removed
+    FenwickTree pagesIndex;
+    std::vector<Page*> indexedPages;
+    std::unordered_map<const GlyphContainer*, size_t> pageIndices;
+    bool isPagesIndexValid = false;
+    // characters in the document order with their sizes, kept in sync with
+    // the glyphs unless edits are composed in the background. The
+    // symbols of the loaded characters are stored twice, here and in the
+    // metrics of their rows, so the buffer makes editing by offsets cheap but
+    // doesn't reduce the memory taken by the glyphs
+    TextBuffer text;
+    // position of the cursor in the text, edits move it by their offsets
+    Cursor cursor;
+    // characters of the text after the loaded ones have no glyphs yet
+    size_t loadedLength = 0;
 
     GlyphContainer::GlyphList selectedGlyphs;
 
+    // nesting level of batches of edits
+    size_t batchDepth = 0;
+    // the first glyph edited in the batch, it is composed when the batch ends
+    Glyph::GlyphPtr batchGlyph;
+    const Glyph* batchRow = nullptr;
+    Page::PagePtr batchPage;
+    // all edits of the batch are in the same row, so composing from it is
+    // enough
+    bool isBatchInRow = true;
+
+    uint64_t version = 0;
+    // edits are composed on its thread if it is set
+    std::shared_ptr<BackgroundCompositor> backgroundCompositor;
+    // the pages have been edited since they were composed
+    bool isComposePending = false;
+    std::shared_ptr<const LayoutSnapshot> drawnLayout;
+    // change of the text since the document was submitted to the background
+    // compositor
+    TextChange submittedChange;
+
+    // edit of the text not made to the glyphs yet
+    struct TextEdit {
+        size_t offset;
+        size_t removedLength;
+        std::string symbols;
+        std::vector<CharacterRun> runs;
+    };
+    // edits composed in the background change only the text, the glyphs are
+    // left as they are for glyphsText till they are requested
+    std::vector<TextEdit> textEdits;
+    TextBuffer glyphsText;
+    // the edits are being made to the glyphs after they have been made to
+    // the text
+    bool isReplayingEdits = false;
+
+    // layouts of the pages collected by UpdateLayout
+    std::unordered_map<const Glyph*, LayoutSnapshot::PageLayoutPtr>
+        pageLayouts;
+
+    // glyph the cursor is drawn next to
+    struct CursorGlyph {
+        Glyph::GlyphPtr glyph;
+        // the cursor is drawn at the left side of the glyph rather than
+        // after it
+        bool isBefore = false;
+    };
+
     explicit Document() {}
+
+    /**
+     * @brief           Finds the glyph the cursor is drawn next to due to its
+     * affinity: the character before the cursor, the character after it or
+     * the first row of an empty document.
+     */
+    CursorGlyph FindCursorGlyph();
     Point GetCursorPosition();
 
-    void DrawDocument();
-    GlyphContainer::GlyphList GetCharactersList();
-    Glyph::GlyphPtr GetNextCharInDocument(Glyph::GlyphPtr& glyph);
-    Glyph::GlyphPtr GetPreviousCharInDocument(Glyph::GlyphPtr& glyph);
+    /**
+     * @brief           Marks the area of the cursor as changed.
+     */
+    void InvalidateCursor();
+
+    /**
+     * @brief           Draws characters of the row and the cursor if it is
+     * in the row.
+     */
+    void DrawRow(const Glyph::GlyphPtr& row, const CursorGlyph& cursorGlyph);
+
+    /**
+     * @brief           Draws dirty rows of the page within the visible area.
+     * @param page      Pointer to the page.
+     * @param index     Index of the page in the document.
+     * @param visible   Visible area of the page.
+     * @param cursorGlyph   Glyph the cursor is drawn next to.
+     */
+    void RedrawPage(const Page::PagePtr& page, size_t index,
+                    const Rect& visible, const CursorGlyph& cursorGlyph);
+
+    /**
+     * @brief           Inserts glyph into the row right after another glyph.
+     * Used in batches, as positions of glyphs are not updated till the end of
+     * the batch.
+     * @param glyph     Pointer to the glyph.
+     * @param previous  Pointer to a glyph of a row or to the row itself to
+     * insert the glyph at its beginning.
+     */
+    void InsertAfter(Glyph::GlyphPtr& glyph, const Glyph::GlyphPtr& previous);
+
+    /**
+     * @brief           Links the inserted glyph, moves the cursor after it and
+     * composes.
+     */
+    void CompleteInsert(const Glyph::GlyphPtr& glyph);
+
+    /**
+     * @brief           Finds the page of the document the glyph is placed on.
+     * @return          Pointer to the page or the current page if the glyph is
+     * not on any of them.
+     */
+    Page::PagePtr GetPage(const Glyph* glyph) const;
+
+    /**
+     * @brief           Finds the character at the offset in the text by the
+     * numbers of characters of the pages and their glyphs in O(log n). Loads
+     * the characters up to it if they are not loaded yet.
+     * @param offset    Offset of the character.
+     */
+    Glyph::GlyphPtr GetCharacterAt(size_t offset);
+
+    /**
+     * @brief           Calculates position of the character in the text by
+     * the numbers of characters placed before it in O(log n).
+     * @param glyph     The glyph.
+     * @param offset    Number of characters before it.
+     * @return          Whether the glyph is a character placed on a page of
+     * the document.
+     */
+    bool FindCharacterOffset(const Glyph& glyph, size_t& offset);
+
+    /**
+     * @brief           Returns numbers of characters of the pages in their
+     * order, rebuilding them if pages have been added or removed.
+     */
+    const FenwickTree& GetPagesIndex();
+
+    /**
+     * @brief           Keeps the numbers of characters of the pages in sync
+     * with their glyphs.
+     */
+    void OnCharactersCountChanged(const GlyphContainer& container,
+                                  ptrdiff_t delta) override;
+
+    /**
+     * @brief           Composes the page after the edit of the glyph or
+     * postpones it till the end of the batch.
+     * @param glyph     Pointer to the inserted or removed glyph.
+     * @param row       Row the glyph has been inserted into or removed from.
+     */
+    void ComposeEdit(const Glyph::GlyphPtr& glyph, const Glyph* row);
+
+    /**
+     * @brief           Composes the pages if they have been edited while
+     * composing in the background.
+     */
+    void ComposePending();
+
+    /**
+     * @brief           Removes characters from the text and their glyphs, if
+     * they have any, and composes.
+     * @param begin     Offset of the first removed character.
+     * @param end       Offset after the last removed character.
+     */
+    void RemoveCharacters(size_t begin, size_t end);
+
+    /**
+     * @brief           Inserts characters into the text and creates their
+     * glyphs if the characters around them have ones, then composes.
+     * @param offset    Offset of the first inserted character.
+     * @param symbols   Symbols of the characters.
+     * @param runs      Sizes of the characters.
+     */
+    void InsertCharacters(size_t offset, const std::string& symbols,
+                          const std::vector<CharacterRun>& runs);
+
+    /**
+     * @brief           Creates glyphs of the characters at the position.
+     */
+    Glyph::GlyphVector CreateCharacters(const std::string& symbols,
+                                        std::vector<CharacterRun> runs,
+                                        const Point& position);
+
+    /**
+     * @brief           Replaces characters of the text without touching the
+     * glyphs. The edit is kept to be made to the glyphs later.
+     */
+    void EditText(size_t begin, size_t end, const std::string& symbols,
+                  const std::vector<CharacterRun>& runs);
+
+    /**
+     * @brief           Makes the edits of the text to the glyphs in the order
+     * they have been made. The glyphs are not composed, and the untouched
+     * ones stay the same.
+     */
+    void SyncGlyphs();
+
+    /**
+     * @brief           Adds the change of the text to the one submitted to the
+     * background compositor next time.
+     */
+    void ChangeText(const TextChange& change);
+
+    /**
+     * @brief           Submits the document with the changes of its text to
+     * the background compositor.
+     */
+    void SubmitLayout();
+
+    /**
+     * @brief           Adds inserted character to the text at the offset it
+     * is placed at among the glyphs.
+     * @param glyph     Pointer to the inserted glyph.
+     * @param offset    Offset of the character in the text.
+     * @return          Whether the glyph is a character of the document.
+     */
+    bool AddToText(const Glyph::GlyphPtr& glyph, size_t& offset);
+
+    /**
+     * @brief           Removes the character from the text and moves the
+     * cursor if it is after the character.
+     * @param offset    Offset the character had in the text.
+     */
+    void RemoveFromText(size_t offset);
+
+    /**
+     * @brief           Creates glyphs of the next characters of the text,
+     * appends them to the last row and composes.
+     * @param count     Maximum number of characters.
+     * @return          Whether any characters have been loaded.
+     */
+    bool LoadCharacters(size_t count);
+
+    /**
+     * @brief           Rebuilds the text from the characters in the order
+     * they are placed on pages.
+     */
+    void IndexCharacters();
 
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive& ar, const unsigned int version) {
-        std::cout << "0 Document\n";
         ar& boost::serialization::base_object<IDocument>(*this);
-        ar & pages & currentPage & compositor & selectedGlyph;
-        std::cout << "1 Document\n";
+        if (Archive::is_saving::value) {
+            SyncGlyphs();
+        }
+        ar & pages & currentPage & compositor & cursor.offset &
+            cursor.affinity;
+        if (Archive::is_loading::value) {
+            IndexCharacters();
+            InvalidateAll();
+        }
     }
 };
 BOOST_CLASS_EXPORT_KEY(Document)
@@ -0,0 +1,81 @@
+#ifndef TEXT_EDITOR_DOCUMENT_FORMAT_H_
+#define TEXT_EDITOR_DOCUMENT_FORMAT_H_
+
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "document.h"
+
+/**
+ * Binary file format of the document. Only the content is stored: the
+ * characters in the document order, runs of their sizes, the cursor and the
+ * compositor settings. The layout is composed again on load.
+ *
+ * All numbers are little-endian:
+ *  - header: magic "LXDF", uint16 version, uint16 reserved;
+ *  - compositor: uint8 alignment, int32 top, bottom, left and right indents
+ *    and line spacing;
+ *  - uint64 cursor offset;
+ *  - uint64 text length followed by the symbols;
+ *  - uint64 runs count followed by uint64 count, int32 width and int32
+ *    height of every run.
+ */
+class DocumentFormat {
+   public:
+    static constexpr uint16_t kVersion = 1;
+
+    /**
+     * @brief           Writes the document to the stream.
+     * @param os        Binary output stream.
+     * @param document  The document.
+     * @return          Whether the document has been written.
+     */
+    static bool Write(std::ostream& os, const Document& document);
+
+    /**
+     * @brief           Writes the snapshot of a document to the stream.
+     * @param os        Binary output stream.
+     * @param snapshot  Content of the document.
+     * @return          Whether the snapshot has been written.
+     */
+    static bool Write(std::ostream& os, const DocumentSnapshot& snapshot);
+
+    /**
+     * @brief           Writes the snapshot to a temporary file beside the
+     * path and renames it over the file. The file is never left half-written,
+     * and a document mapped from it keeps reading the old contents while the
+     * new ones are written.
+     * @param path      Path to the file.
+     * @param snapshot  Content of the document.
+     * @return          Whether the file has been replaced.
+     */
+    static bool Save(const std::string& path,
+                     const DocumentSnapshot& snapshot);
+
+    /**
+     * @brief           Reads the document from the stream and composes it with
+     * a SimpleCompositor.
+     * @param is        Binary input stream.
+     * @return          The document or nullptr if the stream doesn't contain
+     * a document of a supported version.
+     */
+    static std::shared_ptr<Document> Read(std::istream& is);
+
+    /**
+     * @brief           Maps the file into memory and loads the document
+     * lazily. The text refers to the mapped file till it is edited, and only
+     * the first pages are composed, the rest are composed when they are
+     * requested. So opening takes the same time for files of any size.
+     * @param path      Path to the file.
+     * @param pagesCount    Number of pages composed at once.
+     * @return          The document or nullptr if the file cannot be read or
+     * doesn't contain a document of a supported version.
+     */
+    static std::shared_ptr<Document> Map(const std::string& path,
+                                         size_t pagesCount = 1);
+};
+
+#endif  // TEXT_EDITOR_DOCUMENT_FORMAT_H_
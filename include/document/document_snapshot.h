@@ -0,0 +1,49 @@
+#ifndef TEXT_EDITOR_DOCUMENT_SNAPSHOT_H_
+#define TEXT_EDITOR_DOCUMENT_SNAPSHOT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "text_buffer.h"
+
+class Compositor;
+
+/**
+ * Range of the text replaced by edits: the removed characters of the previous
+ * text are replaced by the inserted ones at the same offset. Edits following
+ * each other are merged into one range covering all of them.
+ */
+struct TextChange {
+    size_t offset = 0;
+    size_t removedLength = 0;
+    size_t insertedLength = 0;
+    // the whole text or the settings it is composed with have been replaced
+    bool isFull = false;
+
+    bool IsEmpty() const;
+
+    /**
+     * @brief           Extends the change by the next one made after it.
+     * @param next      Change of the text made by this one.
+     */
+    void Merge(const TextChange& next);
+};
+
+/**
+ * Copy of the document content that is saved. It owns no glyphs: the text
+ * with the sizes of the characters shares its pieces and characters with the
+ * document, so it is taken in O(1) and can be used on another thread while
+ * the document is edited.
+ */
+struct DocumentSnapshot {
+    TextBuffer text;
+    size_t cursorOffset = 0;
+    // version of the document the snapshot has been taken from
+    uint64_t version = 0;
+    // copy of the compositor of the document, so the text is composed by a
+    // compositor of the same class with the same settings
+    std::shared_ptr<const Compositor> compositor;
+};
+
+#endif  // TEXT_EDITOR_DOCUMENT_SNAPSHOT_H_
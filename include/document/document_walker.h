@@ -0,0 +1,67 @@
+#ifndef TEXT_EDITOR_DOCUMENT_WALKER_H_
+#define TEXT_EDITOR_DOCUMENT_WALKER_H_
+
+#include <cstddef>
+#include <iterator>
+#include <list>
+
+#include "glyphs/page.h"
+#include "utils/range.h"
+
+/**
+ * Forward iterator walking the glyph tree of a document depth-first and
+ * yielding glyphs of one level in reading order: columns, rows or characters
+ * of all pages. Glyphs are not copied, so walking doesn't touch reference
+ * counters. The walker is invalidated when the structure of the document is
+ * changed.
+ */
+class DocumentWalker {
+   public:
+    using PageList = std::list<Page::PagePtr>;
+
+    enum Level { COLUMNS = 1, ROWS, CHARACTERS };
+
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Glyph::GlyphPtr;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Glyph::GlyphPtr*;
+    using reference = const Glyph::GlyphPtr&;
+
+    DocumentWalker() = default;
+
+    /**
+     * @brief           Creates a walker pointing to the first glyph of the
+     * level on the pages starting from page.
+     * @param page      Iterator to the first page to walk.
+     * @param pagesEnd  Iterator past the last page.
+     * @param level     Level of the yielded glyphs.
+     */
+    DocumentWalker(PageList::const_iterator page,
+                   PageList::const_iterator pagesEnd, Level level);
+
+    reference operator*() const;
+    pointer operator->() const;
+    DocumentWalker& operator++();
+    DocumentWalker operator++(int);
+
+    bool operator==(const DocumentWalker& other) const;
+    bool operator!=(const DocumentWalker& other) const;
+
+   private:
+    PageList::const_iterator page;
+    PageList::const_iterator pagesEnd;
+    Level level = CHARACTERS;
+    // current position and end of children on each level below pages
+    Glyph::GlyphVector::const_iterator positions[CHARACTERS + 1];
+    Glyph::GlyphVector::const_iterator ends[CHARACTERS + 1];
+
+    /**
+     * @brief           Moves to the first glyph of the level at or after the
+     * current position of the specified level.
+     */
+    void Settle(int current);
+};
+
+using DocumentRange = Range<DocumentWalker>;
+
+#endif  // TEXT_EDITOR_DOCUMENT_WALKER_H_
@@ -7,6 +7,8 @@
 
 class Button : public Glyph {
    public:
+    static const GlyphKind kKind = BUTTON;
+
     /**
      * @brief           Creates a button with the specified parameters and name.
      * @param x         Horizontal coordinate.
@@ -36,6 +38,7 @@ class Button : public Glyph {
     bool IsPressed() const;
 
     std::shared_ptr<Glyph> Clone() const override;
+    void Accept(GlyphVisitor& visitor) override;
 
    private:
     std::string name;
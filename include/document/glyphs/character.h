@@ -9,6 +9,7 @@
 class Character : public Glyph {
    public:
     using CharPtr = std::shared_ptr<Character>;
+    static const GlyphKind kKind = CHARACTER;
     /**
      * @brief           Creates a character with the specified parameters and
      * symbol.
@@ -37,21 +38,26 @@ class Character : public Glyph {
     GlyphPtr GetPreviousGlyph(GlyphPtr& glyph) override;
 
     std::shared_ptr<Glyph> Clone() const override;
+    void Accept(GlyphVisitor& visitor) override;
 
     friend std::ostream& operator<<(std::ostream& os,
                                     const Character& character);
 
    private:
+    // kept while the character is not placed in a container
     char symbol;
+
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive& ar, const unsigned int version) {
-        std::cout << "0 Character\n";
         ar& boost::serialization::base_object<Glyph>(*this);
-        ar & symbol;
-        std::cout << "1 Character\n";
+        char c = GetChar();
+        ar & c;
+        if (Archive::is_loading::value) {
+            SetChar(c);
+        }
     }
-    explicit Character() {}
+    explicit Character() : Glyph(kKind) {}
 };
 BOOST_CLASS_EXPORT_KEY(Character)
 
@@ -0,0 +1,48 @@
+#ifndef TEXT_EDITOR_CHARACTER_FACTORY_H_
+#define TEXT_EDITOR_CHARACTER_FACTORY_H_
+
+#include "character.h"
+#include "document/memory_pool.h"
+
+/**
+ * Creates the characters of a document in its memory pool. Every character is
+ * a separate glyph: its symbol and size are kept in the metrics of its row
+ * once it is placed, so there is no intrinsic state left to share between
+ * characters.
+ */
+class CharacterFactory {
+   public:
+    /**
+     * @brief           Creates a factory.
+     * @param memoryPool    Pool for the created characters or nullptr to
+     * allocate them on the heap.
+     */
+    explicit CharacterFactory(std::shared_ptr<MemoryPool> memoryPool = nullptr);
+
+    /**
+     * @brief           Creates a character of the specified symbol and size.
+     * @param x         Horizontal coordinate.
+     * @param y         Vertical coordinate.
+     * @param width     Character width.
+     * @param height    Character height.
+     * @param symbol    Symbol.
+     * @return          Shared pointer to the new character.
+     */
+    Character::CharPtr CreateCharacter(int x, int y, int width, int height,
+                                       char symbol);
+
+    /**
+     * @brief           Creates a square character of the specified font size.
+     * @param x         Horizontal coordinate.
+     * @param y         Vertical coordinate.
+     * @param symbol    Symbol.
+     * @param size      Font size.
+     * @return          Shared pointer to the new character.
+     */
+    Character::CharPtr CreateCharacter(int x, int y, char symbol, int size);
+
+   private:
+    std::shared_ptr<MemoryPool> memoryPool;
+};
+
+#endif  // TEXT_EDITOR_CHARACTER_FACTORY_H_
@@ -13,6 +13,7 @@
 class Column : public GlyphContainer {
    public:
     using ColumnPtr = std::shared_ptr<Column>;
+    static const GlyphKind kKind = COLUMN;
 
     /**
      * @brief           Creates a column with the specified parameters.
@@ -30,6 +31,7 @@ class Column : public GlyphContainer {
     void Remove(const GlyphPtr& glyph) override;
 
     std::shared_ptr<Glyph> Clone() const override;
+    void Accept(GlyphVisitor& visitor) override;
 
     bool IsEmpty() const;
     bool IsFull() const;
@@ -55,12 +57,10 @@ class Column : public GlyphContainer {
     template<class Archive>
     void serialize(Archive &ar, const unsigned int version)
     {
-        std::cout << "0 Column\n";
         ar & boost::serialization::base_object<GlyphContainer>(*this);
         ar & usedHeight;
-        std::cout << "1 Column\n";
     }
-    explicit Column() {}
+    explicit Column() : GlyphContainer(kKind) {}
 };
 BOOST_CLASS_EXPORT_KEY(Column)
 
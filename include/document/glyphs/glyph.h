@@ -4,9 +4,19 @@
 #include <boost/serialization/assume_abstract.hpp>
 #include <boost/serialization/export.hpp>
 #include <boost/serialization/shared_ptr.hpp>
+#include <cstdint>
 #include <iostream>
+#include <list>
+#include <memory>
+#include <vector>
 
+#include "glyph_visitor.h"
 #include "utils/point.h"
+#include "utils/range.h"
+#include "utils/rect.h"
+
+class GlyphContainer;
+struct GlyphMetrics;
 
 /**
  * Base class for graphical elements.
@@ -15,6 +25,21 @@ class Glyph {
    public:
     using GlyphPtr = std::shared_ptr<Glyph>;
     using GlyphList = std::list<Glyph::GlyphPtr>;
+    using GlyphVector = std::vector<Glyph::GlyphPtr>;
+    using ChildrenRange = Range<GlyphVector::const_iterator>;
+
+    /**
+     * Class of a glyph. It is stored in every glyph, so code depending on
+     * the class compares it instead of using RTTI.
+     */
+    enum GlyphKind : uint8_t {
+        CHARACTER,
+        ROW,
+        COLUMN,
+        PAGE,
+        BUTTON,
+        MONOGLYPH
+    };
 
     /**
      * @brief           Creates glyph with specified position and size.
@@ -22,10 +47,19 @@ class Glyph {
      * @param x         Vertical coordinate.
      * @param width     Glyph width.
      * @param height    Glyph height.
+     * @param kind      Class of the glyph.
      */
-    explicit Glyph(const int x, const int y, const int width, const int height);
+    explicit Glyph(const int x, const int y, const int width, const int height,
+                   GlyphKind kind);
     virtual ~Glyph() = default;
 
+    /**
+     * @brief           Copies position and size of the glyph. The copy doesn't
+     * belong to any container.
+     */
+    Glyph(const Glyph& other);
+    Glyph& operator=(const Glyph& other);
+
     /**
      * @brief           Checks whether the point falls into the rectangle
      * occupied by the glyph.
@@ -69,6 +103,13 @@ class Glyph {
      */
     virtual void MoveGlyph(int x, int y);
 
+    /**
+     * @brief           Returns nested glyphs. Iterating over them doesn't copy
+     * pointers. The range is invalidated when the glyph is changed.
+     * @return          Range of pointers to the nested glyphs.
+     */
+    virtual ChildrenRange GetChildren() const;
+
     virtual GlyphPtr GetFirstGlyph() = 0;
     virtual Glyph::GlyphPtr GetLastGlyph() = 0;
     virtual GlyphPtr GetNextGlyph(GlyphPtr& glyph) = 0;
@@ -81,6 +122,37 @@ class Glyph {
      */
     virtual std::shared_ptr<Glyph> Clone() const = 0;
 
+    /**
+     * @brief           Calls the method of the visitor for the class of the
+     * glyph.
+     * @param visitor   The visitor.
+     */
+    virtual void Accept(GlyphVisitor& visitor) = 0;
+
+    GlyphKind GetKind() const { return kind; }
+
+    /**
+     * @brief           Checks whether the glyph is a row, a column or a page.
+     */
+    bool IsContainer() const {
+        return kind == ROW || kind == COLUMN || kind == PAGE;
+    }
+
+    /**
+     * @brief           Casts the glyph to the class T by its kind.
+     * @return          Pointer to the glyph or nullptr if the glyph is not of
+     * the class T.
+     */
+    template <class T>
+    T* As() {
+        return kind == T::kKind ? static_cast<T*>(this) : nullptr;
+    }
+
+    template <class T>
+    const T* As() const {
+        return kind == T::kKind ? static_cast<const T*>(this) : nullptr;
+    }
+
     void SetPosition(const Point& p);
     void SetPosition(int x, int y);
     void SetWidth(int width);
@@ -92,6 +164,17 @@ class Glyph {
     int GetHeight() const;
     Point GetPosition() const;
 
+    /**
+     * @brief           Returns the rectangle occupied by the glyph.
+     */
+    Rect GetRect() const;
+
+    /**
+     * @brief           Returns the container the glyph was added to last
+     * time or nullptr if it doesn't belong to any.
+     */
+    Glyph* GetParent() const;
+
     /**
      * @brief           Calculates and returns the vertical coordinate of the
      * lower border of the glyph.
@@ -109,22 +192,60 @@ class Glyph {
     friend std::ostream& operator<<(std::ostream& os, const Glyph& glyph);
 
    protected:
+    explicit Glyph(GlyphKind kind) : kind(kind) {}
+
+    /**
+     * @brief           Returns the metrics the glyph is described by if it is
+     * placed in a container.
+     * @param index     Receives the index of the glyph in the metrics.
+     * @return          Pointer to the metrics of the container or nullptr.
+     */
+    GlyphMetrics* GetContainerMetrics(size_t& index) const;
+
+   private:
     // glyph is set by the coordinates of the upper-left corner, width and
     // height
-    int x = 0;
-    int y = 0;
-    int width = 0;
-    int height = 0;
+    struct Bounds {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+    // the container and the position of the glyph among its components, lets
+    // the container find the glyph without search
+    struct Place {
+        GlyphContainer* parent;
+        size_t index;
+    };
+    // a glyph placed in a container is described only by the metrics of the
+    // container, the bounds are kept by the glyph while it is not placed
+    union {
+        Bounds bounds = {0, 0, 0, 0};
+        Place place;
+    };
+    bool isPlaced = false;
+    // not serialized, the constructors of the classes set it
+    GlyphKind kind;
+
+    GlyphContainer* GetContainer() const {
+        return isPlaced ? place.parent : nullptr;
+    }
 
-    explicit Glyph() {}
+    /**
+     * @brief           Sets position and size of the glyph wherever they are
+     * stored.
+     */
+    void SetBounds(int x, int y, int width, int height);
 
-   private:
+    friend class GlyphContainer;
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive& ar, const unsigned int version) {
-        std::cout << "0 Glyph\n";
-        ar & x & y & width & height;
-        std::cout << "1 Glyph\n";
+        Rect rect = GetRect();
+        ar & rect.x & rect.y & rect.width & rect.height;
+        if (Archive::is_loading::value) {
+            SetBounds(rect.x, rect.y, rect.width, rect.height);
+        }
     }
 };
 BOOST_SERIALIZATION_ASSUME_ABSTRACT(Glyph)
@@ -4,9 +4,23 @@
 #include <boost/serialization/assume_abstract.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
-#include <boost/serialization/list.hpp>
+#include <boost/serialization/vector.hpp>
+#include <vector>
 
 #include "glyph.h"
+#include "glyph_metrics.h"
+#include "utils/fenwick_tree.h"
+
+/**
+ * Receives changes of the number of characters of the containers that are not
+ * placed in other containers, e.g. of the pages of a document.
+ */
+class CharactersCountListener {
+   public:
+    virtual ~CharactersCountListener() = default;
+    virtual void OnCharactersCountChanged(const GlyphContainer& container,
+                                          ptrdiff_t delta) = 0;
+};
 
 /**
  * The class represents a complex glyph, i.e glyph that contains one or more
@@ -15,8 +29,16 @@
 class GlyphContainer : public Glyph {
    public:
     explicit GlyphContainer(const int x, const int y, const int width,
-                            const int height);
-    ~GlyphContainer() override = default;
+                            const int height, GlyphKind kind);
+    ~GlyphContainer() override;
+
+    /**
+     * @brief           Copies the container together with clones of its
+     * components, so the components of the other container are left as they
+     * are.
+     */
+    GlyphContainer(const GlyphContainer& other);
+    GlyphContainer& operator=(const GlyphContainer& other);
 
     virtual void Insert(GlyphPtr& glyph) = 0;
     virtual void Remove(const GlyphPtr& glyph) = 0;
@@ -27,23 +49,183 @@ class GlyphContainer : public Glyph {
     size_t GetGlyphIndex(const GlyphPtr& glyph);
     Glyph::GlyphPtr GetGlyphByIndex(int index);
 
+    ChildrenRange GetChildren() const override;
+
+    /**
+     * @brief           Returns positions, sizes and symbols of the components
+     * in their order. The references to the arrays are invalidated when
+     * components are inserted or removed.
+     */
+    const GlyphMetrics& GetMetrics() const;
+
+    /**
+     * @brief           Returns number of characters of the container including
+     * the characters of the nested containers.
+     */
+    size_t GetCharactersCount() const;
+
+    /**
+     * @brief           Finds the character by its index among the characters
+     * of the container in O(log n) on each level of nesting.
+     * @param index     Index of the character.
+     * @return          Pointer to the character or nullptr if the container
+     * has fewer characters.
+     */
+    GlyphPtr GetCharacter(size_t index) const;
+
+    /**
+     * @brief           Counts characters placed before the glyph in its
+     * outermost container in O(log n) on each level of nesting.
+     * @param glyph     The glyph.
+     * @param root      Receives the outermost container of the glyph or
+     * nullptr if the glyph doesn't belong to any.
+     * @return          Number of characters.
+     */
+    static size_t CountCharactersBefore(const Glyph& glyph,
+                                        const GlyphContainer*& root);
+
+    /**
+     * @brief           Sets the listener notified when the number of
+     * characters of the container changes while it is not placed in another
+     * container.
+     */
+    void SetCharactersCountListener(CharactersCountListener* listener);
+
     GlyphPtr GetFirstGlyph() override;
     Glyph::GlyphPtr GetLastGlyph() override;
     GlyphPtr GetNextGlyph(GlyphPtr& glyph) override;
     GlyphPtr GetPreviousGlyph(GlyphPtr& glyph) override;
 
    protected:
-    Glyph::GlyphList components;
-    explicit GlyphContainer() {}
+    // stored contiguously, so walking the children doesn't chase pointers
+    GlyphVector components;
+    // the only storage of positions, sizes and symbols of the components,
+    // which read and write their elements
+    GlyphMetrics metrics;
+    explicit GlyphContainer(GlyphKind kind) : Glyph(kind) {}
+
+    enum Axis { HORIZONTAL, VERTICAL };
+
+    /**
+     * @brief           Returns components that may intersect the glyph, i.e.
+     * whose borders on the axis overlap with the glyph ones. Components are
+     * expected to follow each other along the axis, as the compositor places
+     * them, so the range is found by binary search.
+     * @param glyph     Pointer to the glyph.
+     * @param axis      Axis along which components are placed.
+     */
+    Range<GlyphVector::iterator> GetComponentsOnAxis(const GlyphPtr& glyph,
+                                                     Axis axis);
+
+    /**
+     * @brief           Finds the first component intersecting the glyph.
+     * @param glyph     Pointer to the glyph.
+     * @param axis      Axis along which components are placed.
+     * @return          Iterator to the component or end of components.
+     */
+    GlyphVector::iterator FindIntersectingComponent(const GlyphPtr& glyph,
+                                                    Axis axis);
+
+    /**
+     * @brief           Finds the glyph among the components. The index kept by
+     * the glyph is checked first, so glyphs added to this container are found
+     * in O(1).
+     * @param glyph     Pointer to the glyph.
+     * @return          Iterator to the glyph or end of components.
+     */
+    GlyphVector::iterator FindComponent(const GlyphPtr& glyph);
+
+    /**
+     * @brief           Inserts the glyph into the components before position.
+     * @return          Iterator to the inserted glyph.
+     */
+    GlyphVector::iterator InsertComponent(GlyphVector::iterator position,
+                                          const GlyphPtr& glyph);
+
+    /**
+     * @brief           Inserts the glyphs into the components before position
+     * at once.
+     * @return          Iterator to the first inserted glyph.
+     */
+    GlyphVector::iterator InsertComponents(GlyphVector::iterator position,
+                                           const GlyphVector& glyphs);
+
+    /**
+     * @brief           Removes the glyph at position from the components.
+     * @return          Iterator to the glyph following the removed one.
+     */
+    GlyphVector::iterator EraseComponent(GlyphVector::iterator position);
+
+    /**
+     * @brief           Removes the glyphs in [first, last) from the components
+     * at once.
+     * @return          Iterator to the glyph following the removed ones.
+     */
+    GlyphVector::iterator EraseComponents(GlyphVector::iterator first,
+                                          GlyphVector::iterator last);
 
    private:
+    // number of characters of the container and its nested containers
+    size_t charactersCount = 0;
+    // counts of characters of the components, rebuilt on request after the
+    // components are inserted or removed
+    mutable FenwickTree charactersIndex;
+    mutable bool isCharactersIndexValid = false;
+    CharactersCountListener* charactersCountListener = nullptr;
+
+    /**
+     * @brief           Returns number of characters of the glyph: one for a
+     * character and the number of nested ones for a container.
+     */
+    static size_t CountCharacters(const Glyph& glyph);
+
+    /**
+     * @brief           Returns counts of characters of the components,
+     * rebuilding them if the components have changed.
+     */
+    const FenwickTree& GetCharactersIndex() const;
+
+    /**
+     * @brief           Changes number of characters of the container and its
+     * outer containers after components have been inserted or removed.
+     */
+    void ChangeCharactersCount(ptrdiff_t delta);
+
+    /**
+     * @brief           Counts characters of all components again.
+     */
+    void CountComponentsCharacters();
+
+    /**
+     * @brief           Replaces the components with clones of the components
+     * of the other container.
+     */
+    void CloneComponents(const GlyphContainer& other);
+
+    /**
+     * @brief           Stores positions of the components starting from the
+     * specified one and the container itself in the glyphs.
+     */
+    void UpdateIndices(size_t first);
+
+    /**
+     * @brief           Moves position, size and symbol of the component from
+     * the metrics to the component before it leaves the container.
+     */
+    void DetachComponent(size_t index);
+
+    friend class Glyph;
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive& ar, const unsigned int version) {
-        std::cout << "0 GlyphContainer\n";
         ar& boost::serialization::base_object<Glyph>(*this);
         ar & components;
-        std::cout << "1 GlyphContainer\n";
+        if (Archive::is_loading::value) {
+            // the loaded components keep their metrics till they are placed
+            metrics.Assign(components);
+            UpdateIndices(0);
+            CountComponentsCharacters();
+        }
     }
 };
 
@@ -0,0 +1,54 @@
+#ifndef TEXT_EDITOR_GLYPH_METRICS_H_
+#define TEXT_EDITOR_GLYPH_METRICS_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "glyph.h"
+#include "utils/rect.h"
+
+/**
+ * Positions, sizes and symbols of the components of a container kept as
+ * parallel arrays: the i-th element of every array belongs to the i-th
+ * component. They are the only storage of the components placed in the
+ * container: the components read and write their own elements and take them
+ * back when they are removed, so layout passes read metrics without visiting
+ * the glyphs.
+ */
+struct GlyphMetrics {
+    std::vector<int> x;
+    std::vector<int> y;
+    std::vector<int> width;
+    std::vector<int> height;
+    // symbols of characters, '\0' for other glyphs
+    std::vector<char> symbols;
+
+    size_t GetSize() const;
+    Rect GetRect(size_t index) const;
+
+    /**
+     * @brief           Inserts metrics of the glyphs before the index.
+     * @param index     Index of the first inserted glyph.
+     * @param glyphs    Pointers to the glyphs.
+     */
+    void Insert(size_t index, const Glyph::GlyphVector& glyphs);
+    void Insert(size_t index, const Glyph& glyph);
+
+    /**
+     * @brief           Removes metrics of the glyphs in [first, last).
+     */
+    void Erase(size_t first, size_t last);
+
+    /**
+     * @brief           Stores the position and size of the glyph that is being
+     * inserted at the index, the symbol is kept.
+     */
+    void Set(size_t index, const Glyph& glyph);
+
+    /**
+     * @brief           Replaces all metrics with the metrics of the glyphs.
+     */
+    void Assign(const Glyph::GlyphVector& glyphs);
+};
+
+#endif  // TEXT_EDITOR_GLYPH_METRICS_H_
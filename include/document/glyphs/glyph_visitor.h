@@ -0,0 +1,28 @@
+#ifndef TEXT_EDITOR_GLYPH_VISITOR_H_
+#define TEXT_EDITOR_GLYPH_VISITOR_H_
+
+class Button;
+class Character;
+class Column;
+class MonoGlyph;
+class Page;
+class Row;
+
+/**
+ * Operation depending on the class of glyphs. A glyph calls the method for
+ * its class from Accept, so the operation is chosen without RTTI. Methods
+ * do nothing by default, and visiting components is left to the visitor.
+ */
+class GlyphVisitor {
+   public:
+    virtual ~GlyphVisitor() = default;
+
+    virtual void VisitCharacter(Character&) {}
+    virtual void VisitRow(Row&) {}
+    virtual void VisitColumn(Column&) {}
+    virtual void VisitPage(Page&) {}
+    virtual void VisitButton(Button&) {}
+    virtual void VisitMonoGlyph(MonoGlyph&) {}
+};
+
+#endif  // TEXT_EDITOR_GLYPH_VISITOR_H_
@@ -10,6 +10,8 @@
  */
 class MonoGlyph : public Glyph {
    public:
+    static const GlyphKind kKind = MONOGLYPH;
+
     /**
      * @brief           Creates a glyph that stores a single glyph inside
      * itself.
@@ -29,6 +31,7 @@ class MonoGlyph : public Glyph {
     GlyphPtr GetPreviousGlyph(GlyphPtr& glyph) override;
 
     std::shared_ptr<Glyph> Clone() const override;
+    void Accept(GlyphVisitor& visitor) override;
 
    protected:
     GlyphPtr component;
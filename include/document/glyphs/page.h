@@ -9,6 +9,7 @@
 class Page : public GlyphContainer {
    public:
     using PagePtr = std::shared_ptr<Page>;
+    static const GlyphKind kKind = PAGE;
 
     // x and y can be used for saving position in document or can be ignored
     explicit Page(const int x, const int y, const int width, const int height);
@@ -19,6 +20,7 @@ class Page : public GlyphContainer {
     void Remove(const GlyphPtr& glyph) override;
 
     std::shared_ptr<Glyph> Clone() const override;
+    void Accept(GlyphVisitor& visitor) override;
 
     size_t GetColumnsCount();
 
@@ -26,11 +28,9 @@ class Page : public GlyphContainer {
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive& ar, const unsigned int version) {
-        std::cout << "0 Page\n";
         ar& boost::serialization::base_object<GlyphContainer>(*this);
-        std::cout << "1 Page\n";
     }
-    explicit Page() {}
+    explicit Page() : GlyphContainer(kKind) {}
 };
 BOOST_CLASS_EXPORT_KEY(Page)
 
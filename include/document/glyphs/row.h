@@ -14,6 +14,7 @@
 class Row : public GlyphContainer {
    public:
     using RowPtr = std::shared_ptr<Row>;
+    static const GlyphKind kKind = ROW;
     /**
      * @brief           Creates a row with the specified parameters.
      * @param x         Horizontal coordinate.
@@ -33,7 +34,49 @@ class Row : public GlyphContainer {
     void Insert(GlyphPtr& glyph);
     void Remove(const GlyphPtr& glyph) override;
 
+    /**
+     * @brief           Inserts a glyph right after another one regardless of
+     * positions. The glyphs after it move right, so the row stays ordered by
+     * position till it is composed, even if it becomes wider than its width.
+     * @param glyph     Pointer to the glyph.
+     * @param previous  Pointer to a glyph of the row or nullptr to insert the
+     * glyph at the beginning.
+     */
+    void InsertAfter(const GlyphPtr& glyph, const GlyphPtr& previous);
+
+    /**
+     * @brief           Inserts glyphs one after another right after the glyph
+     * regardless of positions. The glyphs after them are moved right once.
+     * @param glyphs    Pointers to the glyphs.
+     * @param previous  Pointer to a glyph of the row or nullptr to insert the
+     * glyphs at the beginning.
+     */
+    void InsertAfter(const GlyphVector& glyphs, const GlyphPtr& previous);
+
+    /**
+     * @brief           Removes the glyphs of the row from the first one to the
+     * last one inclusive at once.
+     * @param first     Pointer to the first removed glyph.
+     * @param last      Pointer to the last removed glyph.
+     */
+    void Remove(const GlyphPtr& first, const GlyphPtr& last);
+
+    /**
+     * @brief           Adds the glyph to the end of the row regardless of its
+     * position.
+     * @param glyph     Pointer to the glyph.
+     */
+    void Add(GlyphPtr glyph) override;
+
+    /**
+     * @brief           Adds the glyphs to the end of the row at once
+     * regardless of their positions.
+     * @param glyphs    Pointers to the glyphs.
+     */
+    void Add(const GlyphVector& glyphs);
+
     std::shared_ptr<Glyph> Clone() const override;
+    void Accept(GlyphVisitor& visitor) override;
 
     bool IsEmpty() const;
     bool IsFull() const;
@@ -59,12 +102,10 @@ class Row : public GlyphContainer {
     template<class Archive>
     void serialize(Archive &ar, const unsigned int version)
     {
-        std::cout << "0 Row\n";
         ar & boost::serialization::base_object<GlyphContainer>(*this);
         ar & usedWidth;
-        std::cout << "1 Row\n";
     }
-    explicit Row(){}
+    explicit Row() : GlyphContainer(kKind) {}
 };
 BOOST_CLASS_EXPORT_KEY(Row)
 
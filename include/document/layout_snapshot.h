@@ -0,0 +1,55 @@
+#ifndef TEXT_EDITOR_LAYOUT_SNAPSHOT_H_
+#define TEXT_EDITOR_LAYOUT_SNAPSHOT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "cursor.h"
+#include "renderer/renderer.h"
+#include "utils/rect.h"
+
+/**
+ * Places of the characters of a composed document. It owns no glyphs and is
+ * never changed after it is made, so it can be composed on one thread and
+ * drawn on another one while the document is edited.
+ */
+struct LayoutSnapshot {
+    struct CharacterBox {
+        char symbol;
+        // coordinates are relative to the page
+        Rect rect;
+    };
+
+    // characters of a page in the document order
+    struct PageLayout {
+        int width = 0;
+        int height = 0;
+        std::vector<CharacterBox> characters;
+    };
+
+    using PageLayoutPtr = std::shared_ptr<const PageLayout>;
+
+    // version of the document the layout has been composed from
+    uint64_t version = 0;
+    // pages that have not changed since the previous layout are shared with
+    // it rather than copied
+    std::vector<PageLayoutPtr> pages;
+    // the first row of the document, the cursor is there before all
+    // characters
+    Rect firstRow;
+
+    /**
+     * @brief           Draws all pages with the renderer and the cursor next
+     * to the character it keeps to. If the layout is older than the document,
+     * the cursor is kept within its characters.
+     * @param renderer  The renderer.
+     * @param cursor    Offset and affinity of the cursor.
+     */
+    void Draw(Renderer& renderer, const Cursor& cursor) const;
+
+    size_t GetCharactersCount() const;
+};
+
+#endif  // TEXT_EDITOR_LAYOUT_SNAPSHOT_H_
@@ -0,0 +1,130 @@
+#ifndef TEXT_EDITOR_MEMORY_POOL_H_
+#define TEXT_EDITOR_MEMORY_POOL_H_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * Slab allocator for small objects such as glyphs. Memory is taken from the
+ * system in large slabs and split into blocks of a few size classes. Freed
+ * blocks are kept in free lists and reused, and slabs are returned to the
+ * system all at once when the pool is destroyed.
+ */
+class MemoryPool {
+   public:
+    static constexpr size_t kAlignment = alignof(std::max_align_t);
+    static constexpr size_t kMaxBlockSize = 256;
+
+    /**
+     * @brief           Creates an empty pool.
+     * @param slabSize  Number of bytes requested from the system at once.
+     */
+    explicit MemoryPool(size_t slabSize = 64 * 1024);
+    MemoryPool(const MemoryPool&) = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+
+    /**
+     * @brief           Allocates memory for an object. Objects larger than
+     * kMaxBlockSize are allocated by operator new.
+     * @param size      Size of the object.
+     * @return          Pointer to the memory aligned by kAlignment.
+     */
+    void* Allocate(size_t size);
+
+    /**
+     * @brief           Returns memory to the pool.
+     * @param pointer   Pointer returned by Allocate.
+     * @param size      The same size that was passed to Allocate.
+     */
+    void Deallocate(void* pointer, size_t size);
+
+    /**
+     * @brief           Returns number of bytes requested from the system.
+     */
+    size_t GetReservedSize() const;
+
+    /**
+     * @brief           Returns number of blocks given out and not returned.
+     */
+    size_t GetUsedBlocksCount() const;
+
+   private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    size_t slabSize;
+    std::vector<std::unique_ptr<char[]>> slabs;
+    char* slabPosition = nullptr;
+    size_t slabRemainder = 0;
+    std::vector<FreeBlock*> freeLists;
+    size_t usedBlocksCount = 0;
+    // glyphs may be released from any thread holding the last reference
+    mutable std::mutex mutex;
+
+    static size_t GetSizeClass(size_t size);
+};
+
+/**
+ * Standard allocator taking memory from a MemoryPool. The allocator shares
+ * ownership of the pool, so objects created by std::allocate_shared keep it
+ * alive until they are destroyed.
+ */
+template <class T>
+class PoolAllocator {
+   public:
+    using value_type = T;
+
+    explicit PoolAllocator(std::shared_ptr<MemoryPool> pool)
+        : pool(std::move(pool)) {}
+
+    template <class U>
+    PoolAllocator(const PoolAllocator<U>& other) : pool(other.GetPool()) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(pool->Allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* pointer, size_t n) {
+        pool->Deallocate(pointer, n * sizeof(T));
+    }
+
+    const std::shared_ptr<MemoryPool>& GetPool() const { return pool; }
+
+    template <class U>
+    bool operator==(const PoolAllocator<U>& other) const {
+        return pool == other.GetPool();
+    }
+
+    template <class U>
+    bool operator!=(const PoolAllocator<U>& other) const {
+        return pool != other.GetPool();
+    }
+
+   private:
+    std::shared_ptr<MemoryPool> pool;
+};
+
+/**
+ * @brief           Creates an object in the pool or, if there is no pool, on
+ * the heap.
+ * @param pool      Pointer to the pool or nullptr.
+ * @param args      Arguments of the constructor.
+ * @return          Shared pointer to the object.
+ */
+template <class T, class... Args>
+std::shared_ptr<T> AllocateShared(const std::shared_ptr<MemoryPool>& pool,
+                                  Args&&... args) {
+    static_assert(alignof(T) <= MemoryPool::kAlignment,
+                  "Overaligned types are not supported by MemoryPool");
+    if (pool == nullptr) {
+        return std::make_shared<T>(std::forward<Args>(args)...);
+    }
+    return std::allocate_shared<T>(PoolAllocator<T>(pool),
+                                   std::forward<Args>(args)...);
+}
+
+#endif  // TEXT_EDITOR_MEMORY_POOL_H_
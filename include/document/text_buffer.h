@@ -0,0 +1,200 @@
+#ifndef TEXT_EDITOR_TEXT_BUFFER_H_
+#define TEXT_EDITOR_TEXT_BUFFER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * Sequence of characters of the same size following each other in the
+ * document.
+ */
+struct CharacterRun {
+    size_t count;
+    int width;
+    int height;
+};
+
+/**
+ * Piece table holding the character sequence of the document and the sizes
+ * of the characters. Text is never moved: the original text and all inserted
+ * characters are kept in buffers that are only appended to, and the sequence
+ * is described by pieces referring to ranges of them. Pieces are stored in a
+ * treap ordered by their position in the text, so insertion and removal at
+ * any offset take O(log n). Nodes of the treap are never changed, an edit
+ * copies only the nodes on its path, so a copy of the buffer shares all nodes
+ * and characters with it and is made in O(1). The buffer is kept beside the
+ * glyphs of the document rather than instead of them.
+ */
+class TextBuffer {
+   public:
+    TextBuffer();
+    explicit TextBuffer(std::string original);
+
+    /**
+     * @brief           Creates a buffer referring to the original text without
+     * copying it, e.g. to a mapped file. The characters are read only when
+     * they are requested.
+     * @param original  Pointer owning the characters or sharing their owner.
+     * @param length    Number of characters.
+     */
+    TextBuffer(std::shared_ptr<const char> original, size_t length);
+
+    /**
+     * @brief           Shares the pieces and the characters of the buffer in
+     * O(1). The copy may be read on another thread while the buffer is
+     * edited.
+     */
+    TextBuffer(const TextBuffer& other);
+    TextBuffer& operator=(const TextBuffer& other);
+    TextBuffer(TextBuffer&&) = default;
+    TextBuffer& operator=(TextBuffer&&) = default;
+
+    /**
+     * @brief           Inserts characters into the text.
+     * @param offset    Number of characters before the inserted ones.
+     * @param text      Pointer to the characters.
+     * @param length    Number of characters.
+     * @param width     Width of the characters, if they are not given the
+     * size is 0.
+     * @param height    Height of the characters.
+     */
+    void Insert(size_t offset, const char* text, size_t length, int width,
+                int height);
+    void Insert(size_t offset, const char* text, size_t length);
+    void Insert(size_t offset, const std::string& text);
+    void Insert(size_t offset, char symbol);
+
+    /**
+     * @brief           Removes characters from the text.
+     * @param offset    Offset of the first removed character.
+     * @param length    Number of characters.
+     */
+    void Remove(size_t offset, size_t length);
+
+    /**
+     * @brief           Changes the size of the characters.
+     * @param offset    Offset of the first character.
+     * @param length    Number of characters.
+     */
+    void SetSize(size_t offset, size_t length, int width, int height);
+
+    /**
+     * @brief           Sets sizes of the characters from the beginning of the
+     * text run by run.
+     */
+    void SetSizes(const std::vector<CharacterRun>& runs);
+
+    char GetChar(size_t offset) const;
+    std::string GetText() const;
+    std::string GetText(size_t offset, size_t length) const;
+
+    /**
+     * @brief           Returns sizes of the characters in O(pieces).
+     * @return          Runs of characters of the same size.
+     */
+    std::vector<CharacterRun> GetRuns() const;
+    std::vector<CharacterRun> GetRuns(size_t offset, size_t length) const;
+
+    /**
+     * @brief           Writes the characters to the stream piece by piece
+     * without copying them.
+     * @param os        Output stream.
+     * @return          Whether the characters have been written.
+     */
+    bool Write(std::ostream& os) const;
+
+    size_t GetLength() const;
+    size_t GetPiecesCount() const;
+
+    void Clear();
+
+   private:
+    // minimal number of characters a buffer for the inserted ones is
+    // allocated for
+    static const size_t kChunkSize = 4096;
+
+    struct Piece {
+        const char* data;
+        size_t length;
+        int width;
+        int height;
+    };
+
+    struct Node {
+        Piece piece;
+        // total length of pieces in the subtree
+        size_t length;
+        uint32_t priority;
+        std::shared_ptr<const Node> left;
+        std::shared_ptr<const Node> right;
+    };
+    using NodePtr = std::shared_ptr<const Node>;
+
+    // buffer of inserted characters, it keeps the previous buffers alive, so
+    // the last one owns all characters the pieces may refer to
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        size_t capacity;
+        std::shared_ptr<Chunk> previous;
+
+        ~Chunk();
+    };
+
+    // the original text is never changed, so copies of the buffer share it
+    std::shared_ptr<const char> original;
+    std::shared_ptr<Chunk> chunk;
+    // number of characters written to the last chunk
+    size_t chunkLength = 0;
+    // the characters after chunkLength may be written only by the buffer
+    // that has allocated the chunk, its copies allocate their own
+    bool isChunkOwner = false;
+    NodePtr root;
+    uint32_t seed = 2463534242u;
+
+    /**
+     * @brief           Copies the characters to the last chunk, allocating a
+     * new one if they don't fit.
+     * @return          Pointer to the copied characters.
+     */
+    const char* Append(const char* text, size_t length);
+    uint32_t NextPriority();
+    static NodePtr MakeNode(const Piece& piece, uint32_t priority,
+                            NodePtr left, NodePtr right);
+
+    static size_t GetLength(const NodePtr& node);
+    static NodePtr Merge(const NodePtr& left, const NodePtr& right);
+
+    /**
+     * @brief           Splits the tree so that the left part holds exactly
+     * offset characters. A piece crossing the offset is cut in two.
+     */
+    void Split(NodePtr node, size_t offset, NodePtr& left, NodePtr& right);
+
+    /**
+     * @brief           Returns the tree with the last piece extended if it
+     * ends right before the characters and has the same size.
+     * @return          The new tree or nullptr if the piece is not extended.
+     */
+    static NodePtr ExtendLastPiece(const NodePtr& node, const Piece& piece);
+
+    /**
+     * @brief           Returns copy of the tree with the size of all pieces
+     * changed.
+     */
+    static NodePtr Resize(const NodePtr& node, int width, int height);
+
+    /**
+     * @brief           Calls the function for the pieces overlapping the
+     * range in the text order with the offsets of the range within each
+     * piece. Only the nodes on the way to them are visited, so it takes
+     * O(log n + pieces in the range).
+     */
+    template <class Function>
+    void ForEachPiece(size_t offset, size_t length, Function& function) const;
+};
+
+#endif  // TEXT_EDITOR_TEXT_BUFFER_H_
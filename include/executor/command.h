@@ -1,14 +1,31 @@
 #ifndef TEXTEDITOR_INCLUDEEXECUTOR_COMMAND_H_
 #define TEXTEDITOR_INCLUDEEXECUTOR_COMMAND_H_
 
+#include <cstddef>
 #include <cstdio>
 
+#include "executor/journal_record.h"
+
 /*
  * Base class for commands that can be executed by Executor.
  */
 class Command {
    public:
     virtual void Execute() = 0;
+    /*
+     * Describes the command for the edit journal.
+     * Commands that don't change the document are recorded as NONE.
+     */
+    virtual JournalRecord GetRecord() const { return {}; }
+    /*
+     * Approximate memory taken by the command in the history.
+     */
+    virtual std::size_t GetSize() const { return sizeof(Command); }
+    /*
+     * Merges the next executed command into this one, so they are undone
+     * in one step. Returns false if they cannot be merged.
+     */
+    virtual bool Merge(const Command&) { return false; }
     virtual ~Command() {};
 };
 
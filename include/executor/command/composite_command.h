@@ -0,0 +1,42 @@
+#ifndef TEXTEDITOR_INCLUDEEXECUTOR_COMMAND_COMPOSITECOMMAND_H_
+#define TEXTEDITOR_INCLUDEEXECUTOR_COMMAND_COMPOSITECOMMAND_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "document/document.h"
+#include "executor/command.h"
+
+/*
+ * Sequence of commands executed and undone as one step. They are executed
+ * in a batch of the document, so it is composed once for all of them.
+ */
+class CompositeCommand : public ReversibleCommand {
+   public:
+    explicit CompositeCommand(std::shared_ptr<IDocument> doc);
+
+    CompositeCommand(CompositeCommand&&) = default;
+    CompositeCommand& operator=(CompositeCommand&&) = default;
+    CompositeCommand(const CompositeCommand&) = delete;
+    CompositeCommand& operator=(const CompositeCommand&) = delete;
+
+    /*
+     * Adds a command that has already been executed, it is merged into the
+     * last one if they can be merged.
+     */
+    void Add(std::shared_ptr<Command> command);
+    bool IsEmpty() const;
+
+    void Execute() override;
+    void Unexecute() override;
+    std::size_t GetSize() const override;
+
+    ~CompositeCommand() override;
+
+   private:
+    std::shared_ptr<IDocument> doc;
+    std::vector<std::shared_ptr<Command>> commands;
+};
+
+#endif  // TEXTEDITOR_INCLUDEEXECUTOR_COMMAND_COMPOSITECOMMAND_H_
@@ -16,6 +16,7 @@ public:
     Copy& operator=(const Copy&) = delete;
 
     void Execute() override;
+    JournalRecord GetRecord() const override;
 
     ~Copy() override;
 
@@ -0,0 +1,30 @@
+#ifndef TEXT_EDITOR_PROJECT_CUT_H
+#define TEXT_EDITOR_PROJECT_CUT_H
+
+#include "document/document.h"
+#include "document/glyphs/glyph.h"
+#include "executor/command.h"
+#include "utils/point.h"
+
+class Cut : public Command {
+public:
+    explicit Cut(std::shared_ptr<IDocument> doc, const Point& from, const Point& to);
+
+    Cut(Cut&&) = default;
+    Cut& operator=(Cut&&) = default;
+    Cut(const Cut&) = delete;
+    Cut& operator=(const Cut&) = delete;
+
+    void Execute() override;
+    JournalRecord GetRecord() const override;
+
+    ~Cut() override;
+
+private:
+    std::shared_ptr<IDocument> doc;
+    Point from;
+    Point to;
+};
+
+
+#endif //TEXT_EDITOR_PROJECT_CUT_H
@@ -1,6 +1,9 @@
 #ifndef TEXTEDITOR_INCLUDEEXECUTOR_COMMAND_INSERTCHARACTER_H_
 #define TEXTEDITOR_INCLUDEEXECUTOR_COMMAND_INSERTCHARACTER_H_
 
+#include <cstddef>
+#include <string>
+
 #include "document/document.h"
 #include "document/glyphs/glyph.h"
 #include "executor/command.h"
@@ -15,6 +18,9 @@ class InsertCharacter : public ReversibleCommand {
     InsertCharacter& operator=(const InsertCharacter&) = delete;
 
     void Execute() override;
+    JournalRecord GetRecord() const override;
+    std::size_t GetSize() const override;
+    bool Merge(const Command& next) override;
     void Unexecute() override;
 
     ~InsertCharacter() override;
@@ -22,6 +28,12 @@ class InsertCharacter : public ReversibleCommand {
    private:
     std::shared_ptr<IDocument> doc;
     char character;
+    // characters typed right after this one and merged into the command
+    std::string appended;
+    // cursor offset before the command has been executed, redo executes it
+    // at the same offset
+    std::size_t offset = 0;
+    bool isExecuted = false;
 };
 
 #endif  // TEXTEDITOR_INCLUDEEXECUTOR_COMMAND_INSERTCHARACTER_H_
\ No newline at end of file
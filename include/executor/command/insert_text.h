@@ -0,0 +1,38 @@
+#ifndef TEXTEDITOR_INCLUDEEXECUTOR_COMMAND_INSERTTEXT_H_
+#define TEXTEDITOR_INCLUDEEXECUTOR_COMMAND_INSERTTEXT_H_
+
+#include <cstddef>
+#include <string>
+
+#include "document/document.h"
+#include "executor/command.h"
+
+/*
+ * Inserts a string at the cursor at once, e.g. pasted or imported text.
+ */
+class InsertText : public ReversibleCommand {
+   public:
+    explicit InsertText(std::shared_ptr<IDocument> doc, std::string text);
+
+    InsertText(InsertText&&) = default;
+    InsertText& operator=(InsertText&&) = default;
+    InsertText(const InsertText&) = delete;
+    InsertText& operator=(const InsertText&) = delete;
+
+    void Execute() override;
+    JournalRecord GetRecord() const override;
+    std::size_t GetSize() const override;
+    void Unexecute() override;
+
+    ~InsertText() override;
+
+   private:
+    std::shared_ptr<IDocument> doc;
+    std::string text;
+    // cursor offset before the command has been executed, redo executes it
+    // at the same offset
+    std::size_t offset = 0;
+    bool isExecuted = false;
+};
+
+#endif  // TEXTEDITOR_INCLUDEEXECUTOR_COMMAND_INSERTTEXT_H_
@@ -1,6 +1,7 @@
 #ifndef TEXT_EDITOR_PROJECT_MOVE_CURSOR_RIGHT_H
 #define TEXT_EDITOR_PROJECT_MOVE_CURSOR_RIGHT_H
 
+#include <cstddef>
 #include <memory>
 
 #include "document/document.h"
@@ -16,11 +17,14 @@ public:
     MoveCursorRight& operator=(const MoveCursorRight&) = delete;
 
     void Execute() override;
+    JournalRecord GetRecord() const override;
 
     ~MoveCursorRight() override;
 
 private:
     std::shared_ptr<IDocument> doc;
+    // cursor offset before the command has been executed
+    std::size_t offset = 0;
 };
 
 #endif //TEXT_EDITOR_PROJECT_MOVE_CURSOR_RIGHT_H
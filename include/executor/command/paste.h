@@ -16,6 +16,8 @@ public:
     Paste& operator=(const Paste&) = delete;
 
     void Execute() override;
+    JournalRecord GetRecord() const override;
+    std::size_t GetSize() const override;
     void Unexecute() override;
 
     ~Paste() override;
@@ -1,6 +1,9 @@
 #ifndef TEXTEDITOR_INCLUDEEXECUTOR_COMMAND_REMOVECHARACTER_H_
 #define TEXTEDITOR_INCLUDEEXECUTOR_COMMAND_REMOVECHARACTER_H_
 
+#include <cstddef>
+#include <string>
+
 #include "document/document.h"
 #include "document/glyphs/glyph.h"
 #include "executor/command.h"
@@ -15,6 +18,9 @@ class RemoveCharacter : public ReversibleCommand {
     RemoveCharacter& operator=(const RemoveCharacter&) = delete;
 
     void Execute() override;
+    JournalRecord GetRecord() const override;
+    std::size_t GetSize() const override;
+    bool Merge(const Command& next) override;
     void Unexecute() override;
 
     ~RemoveCharacter() override;
@@ -22,6 +28,13 @@ class RemoveCharacter : public ReversibleCommand {
    private:
     std::shared_ptr<IDocument> doc;
     char character;
+    // characters removed right after this one and merged into the command,
+    // in the order they have been removed
+    std::string appended;
+    // cursor offset before the command has been executed, redo executes it
+    // at the same offset
+    std::size_t offset = 0;
+    bool isExecuted = false;
 };
 
 #endif  // TEXTEDITOR_INCLUDEEXECUTOR_COMMAND_REMOVECHARACTER_H_
\ No newline at end of file
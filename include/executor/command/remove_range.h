@@ -0,0 +1,38 @@
+#ifndef TEXTEDITOR_INCLUDEEXECUTOR_COMMAND_REMOVERANGE_H_
+#define TEXTEDITOR_INCLUDEEXECUTOR_COMMAND_REMOVERANGE_H_
+
+#include <cstddef>
+#include <string>
+
+#include "document/document.h"
+#include "executor/command.h"
+
+/*
+ * Removes characters between two offsets of the text at once.
+ * The cursor is left where they were, so undo inserts them back there.
+ */
+class RemoveRange : public ReversibleCommand {
+   public:
+    explicit RemoveRange(std::shared_ptr<IDocument> doc, std::size_t begin,
+                         std::size_t end);
+
+    RemoveRange(RemoveRange&&) = default;
+    RemoveRange& operator=(RemoveRange&&) = default;
+    RemoveRange(const RemoveRange&) = delete;
+    RemoveRange& operator=(const RemoveRange&) = delete;
+
+    void Execute() override;
+    JournalRecord GetRecord() const override;
+    std::size_t GetSize() const override;
+    void Unexecute() override;
+
+    ~RemoveRange() override;
+
+   private:
+    std::shared_ptr<IDocument> doc;
+    std::size_t begin;
+    std::size_t end;
+    std::string removed;
+};
+
+#endif  // TEXTEDITOR_INCLUDEEXECUTOR_COMMAND_REMOVERANGE_H_
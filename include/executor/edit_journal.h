@@ -0,0 +1,153 @@
+#ifndef TEXTEDITOR_INCLUDEEXECUTOR_EDITJOURNAL_H_
+#define TEXTEDITOR_INCLUDEEXECUTOR_EDITJOURNAL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "document/autosave.h"
+#include "document/document.h"
+#include "executor/journal_record.h"
+
+/*
+ * Append-only journal of the commands executed on a document since its last
+ * full save. Each record takes a few bytes and is flushed at once, so saving
+ * an edit costs O(edit) and a crash loses only the unflushed tail.
+ *
+ * A checkpoint saves the whole document in DocumentFormat and starts a new
+ * journal. The editing thread only takes a snapshot of the document, the
+ * autosave worker writes it and then replaces both files, the new journal
+ * getting the records appended meanwhile. The journal begins with the hash of
+ * the save it applies to, so a journal left from a previous checkpoint is
+ * never replayed onto a newer save. Then goes the clipboard of the document,
+ * as copied glyphs can be pasted after the checkpoint.
+ *
+ * Layout, all numbers are little-endian:
+ *  - header: magic "LXEJ", uint16 version, uint16 reserved, uint64 hash of
+ *    the save;
+ *  - clipboard: uint32 count followed by int8 symbol, int32 width and int32
+ *    height of every character;
+ *  - records: uint8 type, then uint64 offset of the cursor for INSERT_CHAR,
+ *    REMOVE_CHAR, INSERT_TEXT, MOVE_CURSOR_LEFT and MOVE_CURSOR_RIGHT,
+ *    followed by int8 symbol for INSERT_CHAR, int32 x and y of both points
+ *    for COPY and CUT and of one point for PASTE, uint32 length and the
+ *    characters for INSERT_TEXT, uint64 begin and end offsets for
+ *    REMOVE_RANGE.
+ */
+class EditJournal {
+   public:
+    // version 2 adds INSERT_TEXT and REMOVE_RANGE records, version 3 the
+    // offsets of the cursor; journals of other versions are ignored
+    static constexpr uint16_t kVersion = 3;
+
+    /**
+     * @brief           Opens the journal of the document. Starts with a
+     * checkpoint, so the journal applies to the current state of the
+     * document.
+     * @param path      Path to the journal file.
+     * @param savePath  Path to the file with the full save.
+     * @param document  The document, it must be the one commands are
+     * executed on.
+     * @param checkpointInterval    Number of records after which a
+     * checkpoint is due.
+     */
+    EditJournal(std::string path, std::string savePath,
+                std::shared_ptr<const Document> document,
+                size_t checkpointInterval = 1000);
+
+    /**
+     * @brief           Completes the checkpoint in progress.
+     */
+    ~EditJournal();
+
+    EditJournal(const EditJournal&) = delete;
+    EditJournal& operator=(const EditJournal&) = delete;
+
+    /**
+     * @brief           Appends the record to the journal and flushes it. While
+     * a checkpoint is in progress the record is also kept for its journal.
+     * @return          Whether the record has been written or kept.
+     */
+    bool Append(const JournalRecord& record);
+
+    /**
+     * @brief           Takes a snapshot of the document and schedules saving
+     * it with a new journal on the worker thread. A checkpoint in progress is
+     * replaced.
+     * @param isJournalComplete     Whether the journal describes all changes
+     * of the document. Then records are appended to it till the save is
+     * written, so a crash meanwhile loses nothing. Otherwise a crash before
+     * the save is written recovers the document as it was before the changes
+     * the journal lacks.
+     */
+    void Checkpoint(bool isJournalComplete = false);
+
+    /**
+     * @brief           Waits till the checkpoint in progress replaces the
+     * files.
+     */
+    void Flush();
+
+    /**
+     * @brief           Checks whether the journal has got checkpointInterval
+     * records since the last checkpoint, or records are kept nowhere since
+     * a checkpoint has failed.
+     */
+    bool IsCheckpointDue() const;
+
+    /**
+     * @brief           Returns number of records since the last checkpoint.
+     */
+    size_t GetRecordsCount() const;
+
+    /**
+     * @brief           Reads the last full save and replays the journal onto
+     * it. Commands are replayed by an executor, so undo and redo have the
+     * same effect they had.
+     * @param path      Path to the journal file.
+     * @param savePath  Path to the file with the full save.
+     * @param historyLength     Length of the history of the executor the
+     * journal has been written by.
+     * @return          The document or nullptr if there is no save. The
+     * journal is ignored if it doesn't belong to the save, and replay stops
+     * at the first incomplete record.
+     */
+    static std::shared_ptr<Document> Recover(const std::string& path,
+                                             const std::string& savePath,
+                                             size_t historyLength);
+
+   private:
+    // records and clipboard of a checkpoint whose save is being written
+    struct PendingCheckpoint {
+        uint64_t number;
+        std::string clipboard;
+        std::string records;
+    };
+
+    std::string path;
+    std::string savePath;
+    std::shared_ptr<const Document> document;
+    size_t checkpointInterval;
+    size_t recordsCount = 0;
+    // guards the journal file and the pending checkpoint, the worker
+    // replaces them
+    mutable std::mutex mutex;
+    std::ofstream file;
+    // whether replaying the file onto the save gives the document
+    bool isFileComplete = false;
+    std::unique_ptr<PendingCheckpoint> pending;
+    // declared last, so the worker completes the pending checkpoint while
+    // the rest is alive
+    Autosave saver;
+
+    /**
+     * @brief           Replaces the save and the journal when the snapshot of
+     * the pending checkpoint is written. Called on the worker thread.
+     */
+    void CompleteCheckpoint(uint64_t number, bool isWritten);
+};
+
+#endif  // TEXTEDITOR_INCLUDEEXECUTOR_EDITJOURNAL_H_
@@ -6,6 +6,8 @@
 #include <vector>
 
 #include "command.h"
+#include "command/composite_command.h"
+#include "edit_journal.h"
 #include "utils/circular_buffer.hpp"
 
 /*
@@ -15,20 +17,64 @@
  */
 class Executor {
    public:
-    explicit Executor(const std::size_t command_queue_length);
+    // memory the history of commands takes by default
+    static constexpr std::size_t kDefaultMemoryBudget = 1 << 20;
+
+    /*
+     * The history keeps at most command_queue_length commands, and the
+     * oldest ones are dropped while the done commands take more than
+     * memory_budget bytes. Consecutive commands are merged when they can be,
+     * e.g. typed characters of a word.
+     */
+    explicit Executor(const std::size_t command_queue_length,
+                      const std::size_t memory_budget = kDefaultMemoryBudget);
 
     void Do(std::shared_ptr<Command>&&);
     void Undo();
     void Redo();
 
+    /*
+     * Starts a transaction: commands done till Commit are executed in a
+     * batch of the document, so it is composed once, and they are undone
+     * as one step. Transactions cannot be nested, and Undo and Redo are not
+     * allowed in them.
+     */
+    void BeginTransaction(std::shared_ptr<IDocument> doc);
+    void Commit();
+
+    /*
+     * Records executed, undone and redone commands in the journal.
+     * Undo or redo of a command that is not in the journal since its last
+     * checkpoint cannot be replayed, so it makes a checkpoint.
+     */
+    void SetJournal(std::shared_ptr<EditJournal> journal);
+
    private:
     CircularBuffer<Command> command_history;
+    std::size_t history_length;
+    std::size_t memory_budget;
+    // memory taken by the done commands in the history
+    std::size_t history_size = 0;
+    std::shared_ptr<EditJournal> journal;
+    // commands in the history and undone ones that have been recorded since
+    // the last checkpoint
+    std::size_t journaled_count = 0;
+    std::size_t journaled_undone_count = 0;
+    // commands done since BeginTransaction
+    std::shared_ptr<CompositeCommand> transaction;
+    std::shared_ptr<IDocument> transaction_doc;
     /*
      * this flag is set true after Do and set false after Undo
      * because after Do "future" - commands that have been unexecuted(), are not
      * valid
      */
-    bool future_impossible;
+    bool future_impossible = true;
+
+    // adds the executed command to the history or merges it into the last one
+    void Push(std::shared_ptr<Command>&& command);
+    void Journal(const JournalRecord& record);
+    void DropOldest();
+    void Checkpoint(bool isJournalComplete = false);
 };
 
 #endif  // TEXTEDITOR_INCLUDEEXECUTOR_EXECUTOR_H_
\ No newline at end of file
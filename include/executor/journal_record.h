@@ -0,0 +1,50 @@
+#ifndef TEXTEDITOR_INCLUDEEXECUTOR_JOURNALRECORD_H_
+#define TEXTEDITOR_INCLUDEEXECUTOR_JOURNALRECORD_H_
+
+#include <cstdint>
+#include <string>
+
+#include "utils/point.h"
+
+/*
+ * Description of an executed command that is enough to execute it again
+ * on the same document.
+ */
+struct JournalRecord {
+    enum Type : uint8_t {
+        // command that doesn't change the document, it is kept only to
+        // replay the history of commands
+        NONE,
+        INSERT_CHAR,
+        REMOVE_CHAR,
+        MOVE_CURSOR_LEFT,
+        MOVE_CURSOR_RIGHT,
+        COPY,
+        CUT,
+        PASTE,
+        UNDO,
+        REDO,
+        BEGIN_TRANSACTION,
+        COMMIT,
+        INSERT_TEXT,
+        REMOVE_RANGE,
+    };
+
+    Type type = NONE;
+    // offset of the cursor the command has been executed at, as the cursor
+    // can be moved without commands: INSERT_CHAR, REMOVE_CHAR, INSERT_TEXT,
+    // MOVE_CURSOR_LEFT and MOVE_CURSOR_RIGHT
+    uint64_t offset = 0;
+    // INSERT_CHAR
+    char symbol = 0;
+    // COPY and CUT use both points, PASTE uses the start
+    Point start;
+    Point end;
+    // INSERT_TEXT
+    std::string text;
+    // REMOVE_RANGE
+    uint64_t rangeBegin = 0;
+    uint64_t rangeEnd = 0;
+};
+
+#endif  // TEXTEDITOR_INCLUDEEXECUTOR_JOURNALRECORD_H_
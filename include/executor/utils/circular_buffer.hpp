@@ -1,5 +1,7 @@
 #include <iostream>
+#include <memory>
 #include <ostream>
+#include <utility>
 #include <vector>
 
 /*
@@ -11,8 +13,8 @@ class CircularBuffer {
     explicit CircularBuffer(size_t capacity)
         : buffer(std::vector<std::shared_ptr<T>>(capacity)),
           max_capacity(capacity),
-          capacity(capacity),
-          next_index(capacity) {}
+          next_index(capacity),
+          capacity(capacity) {}
 
     bool empty() { return capacity == 0; }
 
@@ -38,6 +40,31 @@ class CircularBuffer {
         return v;
     }
 
+    // Returns the last pushed element without removing it
+    std::shared_ptr<T> top() {
+        if (capacity == 0)
+            return nullptr;
+
+        return buffer[(next_index.get_value() + max_capacity - 1) %
+                      max_capacity];
+    }
+
+    // Removes the oldest element, the one push overwrites when the buffer is
+    // full
+    std::shared_ptr<T> pop_front() {
+        if (capacity == 0)
+            return nullptr;
+
+        std::size_t index =
+            (next_index.get_value() + max_capacity - capacity.get_value()) %
+            max_capacity;
+        auto v = std::move(buffer[index]);
+        --capacity;
+        return v;
+    }
+
+    std::size_t size() { return capacity.get_value(); }
+
    private:
     class CircularValue {
        public:
@@ -65,7 +92,7 @@ class CircularBuffer {
             return v;
         }
 
-        bool operator==(const int o) { return val == o; }
+        bool operator==(std::size_t o) { return val == o; }
 
         std::size_t get_value() { return val; }
 
@@ -100,7 +127,7 @@ class CircularBuffer {
             return v;
         }
 
-        bool operator==(const int o) { return val == o; }
+        bool operator==(std::size_t o) { return val == o; }
 
         std::size_t get_value() { return val; }
 
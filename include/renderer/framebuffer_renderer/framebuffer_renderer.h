@@ -0,0 +1,74 @@
+#ifndef TEXT_EDITOR_FRAMEBUFFER_RENDERER_H_
+#define TEXT_EDITOR_FRAMEBUFFER_RENDERER_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "renderer/renderer.h"
+#include "utils/point.h"
+
+/**
+ * Renderer drawing into memory. Every page is a grid of cells, one per
+ * coordinate unit, filled with symbols of the characters covering them.
+ */
+class FramebufferRenderer : public Renderer {
+   public:
+    static constexpr char kBackground = ' ';
+
+    void Clear() override;
+    void DrawPage(int width, int height) override;
+    void BeginUpdate(size_t pagesCount) override;
+    void SelectPage(size_t index, int width, int height) override;
+    void ClearRegion(int x, int y, int width, int height) override;
+    void DrawChar(char symbol, int x, int y, int width, int height) override;
+    void DrawCursor(int x, int y, int height) override;
+    void Present() override;
+
+    /**
+     * @brief           Returns the cell of the last presented frame.
+     * @param page      Index of the page.
+     * @param x         Horizontal coordinate.
+     * @param y         Vertical coordinate.
+     * @return          Symbol drawn in the cell.
+     */
+    char GetCell(size_t page, int x, int y) const;
+
+    size_t GetPagesCount() const;
+
+    /**
+     * @brief           Returns page index and position of the cursor in the
+     * last presented frame.
+     */
+    size_t GetCursorPage() const;
+    Point GetCursorPosition() const;
+
+    size_t GetFramesCount() const;
+
+   private:
+    struct Page {
+        int width;
+        int height;
+        std::vector<char> cells;
+    };
+
+    struct Frame {
+        std::vector<Page> pages;
+        size_t cursorPage = 0;
+        Point cursorPosition;
+    };
+
+    // frame being drawn and the last presented one
+    Frame back;
+    Frame front;
+    // page of the back frame being drawn
+    size_t currentPage = 0;
+    size_t framesCount = 0;
+
+    /**
+     * @brief           Fills the area of the current page clipped by its
+     * borders.
+     */
+    void Fill(char symbol, int x, int y, int width, int height);
+};
+
+#endif  // TEXT_EDITOR_FRAMEBUFFER_RENDERER_H_
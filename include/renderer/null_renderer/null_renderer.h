@@ -0,0 +1,21 @@
+#ifndef TEXT_EDITOR_NULL_RENDERER_H_
+#define TEXT_EDITOR_NULL_RENDERER_H_
+
+#include "renderer/renderer.h"
+
+/**
+ * Renderer drawing nothing, used when the document is not shown.
+ */
+class NullRenderer : public Renderer {
+   public:
+    void Clear() override {}
+    void DrawPage(int, int) override {}
+    void BeginUpdate(size_t) override {}
+    void SelectPage(size_t, int, int) override {}
+    void ClearRegion(int, int, int, int) override {}
+    void DrawChar(char, int, int, int, int) override {}
+    void DrawCursor(int, int, int) override {}
+    void Present() override {}
+};
+
+#endif  // TEXT_EDITOR_NULL_RENDERER_H_
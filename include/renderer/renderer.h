@@ -0,0 +1,82 @@
+#ifndef TEXT_EDITOR_RENDERER_H_
+#define TEXT_EDITOR_RENDERER_H_
+
+#include <cstddef>
+
+/**
+ * Output device the document is drawn on. A frame starts with Clear(), then
+ * pages are drawn one after another, each followed by its characters and
+ * cursor, and ends with Present(). Coordinates are relative to the page.
+ *
+ * The presented frame can also be updated in place: BeginUpdate() keeps it,
+ * SelectPage() chooses the page that is drawn next, ClearRegion() erases an
+ * area of it before characters are drawn there again, and Present() shows
+ * the result.
+ */
+class Renderer {
+   public:
+    virtual ~Renderer() = default;
+
+    /**
+     * @brief           Starts a new frame, dropping everything drawn before.
+     */
+    virtual void Clear() = 0;
+
+    /**
+     * @brief           Starts drawing of the next page.
+     * @param width     Page width.
+     * @param height    Page height.
+     */
+    virtual void DrawPage(int width, int height) = 0;
+
+    /**
+     * @brief           Starts updating the last presented frame.
+     * @param pagesCount    Number of pages in the document, pages after them
+     * are dropped.
+     */
+    virtual void BeginUpdate(size_t pagesCount) = 0;
+
+    /**
+     * @brief           Continues drawing on the page of the updated frame.
+     * The page is added if the frame has no such page yet.
+     * @param index     Index of the page.
+     * @param width     Page width.
+     * @param height    Page height.
+     */
+    virtual void SelectPage(size_t index, int width, int height) = 0;
+
+    /**
+     * @brief           Erases the area of the current page.
+     * @param x         Horizontal coordinate.
+     * @param y         Vertical coordinate.
+     * @param width     Area width.
+     * @param height    Area height.
+     */
+    virtual void ClearRegion(int x, int y, int width, int height) = 0;
+
+    /**
+     * @brief           Draws a character on the current page.
+     * @param symbol    Symbol.
+     * @param x         Horizontal coordinate.
+     * @param y         Vertical coordinate.
+     * @param width     Character width.
+     * @param height    Character height.
+     */
+    virtual void DrawChar(char symbol, int x, int y, int width,
+                          int height) = 0;
+
+    /**
+     * @brief           Draws the cursor on the current page.
+     * @param x         Horizontal coordinate.
+     * @param y         Vertical coordinate.
+     * @param height    Cursor height.
+     */
+    virtual void DrawCursor(int x, int y, int height) = 0;
+
+    /**
+     * @brief           Finishes the frame and shows it.
+     */
+    virtual void Present() = 0;
+};
+
+#endif  // TEXT_EDITOR_RENDERER_H_
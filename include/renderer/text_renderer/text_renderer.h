@@ -0,0 +1,37 @@
+#ifndef TEXT_EDITOR_TEXT_RENDERER_H_
+#define TEXT_EDITOR_TEXT_RENDERER_H_
+
+#include <ostream>
+#include <string>
+
+#include "renderer/renderer.h"
+
+/**
+ * Renderer describing the frame as text. The frame is collected in memory
+ * and written to the stream at once when it is presented.
+ */
+class TextRenderer : public Renderer {
+   public:
+    /**
+     * @brief           Creates a renderer writing to the stream.
+     * @param os        Output stream, must outlive the renderer.
+     */
+    explicit TextRenderer(std::ostream& os);
+
+    void Clear() override;
+    void DrawPage(int width, int height) override;
+    void BeginUpdate(size_t pagesCount) override;
+    void SelectPage(size_t index, int width, int height) override;
+    void ClearRegion(int x, int y, int width, int height) override;
+    void DrawChar(char symbol, int x, int y, int width, int height) override;
+    void DrawCursor(int x, int y, int height) override;
+    void Present() override;
+
+   private:
+    std::ostream& os;
+    std::string frame;
+
+    void AppendNumber(int number);
+};
+
+#endif  // TEXT_EDITOR_TEXT_RENDERER_H_
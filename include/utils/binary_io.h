@@ -0,0 +1,81 @@
+#ifndef TEXT_EDITOR_BINARY_IO_H_
+#define TEXT_EDITOR_BINARY_IO_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// numbers are stored in little-endian order
+
+/**
+ * Collects fixed-size numbers and byte ranges in a buffer, so the stream is
+ * written by few large writes.
+ */
+class BinaryWriter {
+   public:
+    template <class T>
+    void Write(T value) {
+        auto bits = static_cast<uint64_t>(value);
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            buffer.push_back(static_cast<char>((bits >> (8 * i)) & 0xff));
+        }
+    }
+
+    void WriteBytes(const char* bytes, size_t length) {
+        buffer.append(bytes, length);
+    }
+
+    bool Flush(std::ostream& os) {
+        os.write(buffer.data(), buffer.size());
+        buffer.clear();
+        return bool(os);
+    }
+
+   private:
+    std::string buffer;
+};
+
+/**
+ * Reads fixed-size numbers and byte ranges from memory.
+ */
+class BinaryReader {
+   public:
+    BinaryReader(const char* data, size_t size) : data(data), size(size) {}
+
+    template <class T>
+    bool Read(T& value) {
+        const char* bytes = Skip(sizeof(T));
+        if (bytes == nullptr) {
+            return false;
+        }
+        uint64_t bits = 0;
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            bits |= static_cast<uint64_t>(static_cast<unsigned char>(bytes[i]))
+                    << (8 * i);
+        }
+        value = static_cast<T>(bits);
+        return true;
+    }
+
+    /**
+     * @brief           Skips bytes.
+     * @return          Pointer to the skipped bytes or nullptr if there are
+     * not enough of them.
+     */
+    const char* Skip(uint64_t length) {
+        if (length > size - position) {
+            return nullptr;
+        }
+        const char* bytes = data + position;
+        position += length;
+        return bytes;
+    }
+
+   private:
+    const char* data;
+    size_t size;
+    size_t position = 0;
+};
+
+#endif  // TEXT_EDITOR_BINARY_IO_H_
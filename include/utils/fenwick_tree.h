@@ -0,0 +1,80 @@
+#ifndef TEXT_EDITOR_FENWICK_TREE_H_
+#define TEXT_EDITOR_FENWICK_TREE_H_
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Counts of a sequence of items that allows to change a count, to sum the
+ * counts of a prefix and to find the item by the sum of the counts before it
+ * in O(log n).
+ */
+class FenwickTree {
+   public:
+    /**
+     * @brief           Replaces the counts of all items in O(n).
+     */
+    void Assign(const std::vector<size_t>& counts) {
+        tree = counts;
+        for (size_t i = 1; i <= tree.size(); ++i) {
+            size_t parent = i + (i & (~i + 1));
+            if (parent <= tree.size()) {
+                tree[parent - 1] += tree[i - 1];
+            }
+        }
+    }
+
+    size_t GetSize() const { return tree.size(); }
+
+    /**
+     * @brief           Adds delta to the count of the item.
+     */
+    void Add(size_t index, ptrdiff_t delta) {
+        // negative deltas wrap around, the sums stay correct
+        for (size_t i = index + 1; i <= tree.size(); i += i & (~i + 1)) {
+            tree[i - 1] += static_cast<size_t>(delta);
+        }
+    }
+
+    /**
+     * @brief           Returns sum of the counts of the first items.
+     * @param count     Number of items.
+     */
+    size_t GetPrefixSum(size_t count) const {
+        size_t sum = 0;
+        for (size_t i = count; i > 0; i -= i & (~i + 1)) {
+            sum += tree[i - 1];
+        }
+        return sum;
+    }
+
+    /**
+     * @brief           Finds the item the unit with the index belongs to, i.e.
+     * the first item for which the counts up to it inclusive exceed the
+     * index.
+     * @param index     Index of the unit, it is replaced by its index among
+     * the units of the found item.
+     * @return          Index of the item or the number of items if the index
+     * exceeds the sum of all counts.
+     */
+    size_t Find(size_t& index) const {
+        size_t position = 0;
+        size_t step = 1;
+        while (step * 2 <= tree.size()) {
+            step *= 2;
+        }
+        for (; step > 0; step /= 2) {
+            size_t next = position + step;
+            if (next <= tree.size() && tree[next - 1] <= index) {
+                index -= tree[next - 1];
+                position = next;
+            }
+        }
+        return position;
+    }
+
+   private:
+    std::vector<size_t> tree;
+};
+
+#endif  // TEXT_EDITOR_FENWICK_TREE_H_
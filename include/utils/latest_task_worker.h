@@ -0,0 +1,158 @@
+#ifndef TEXT_EDITOR_LATEST_TASK_WORKER_H_
+#define TEXT_EDITOR_LATEST_TASK_WORKER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+inline std::chrono::microseconds ToMicroseconds(
+    std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration);
+}
+
+/**
+ * Worker thread running only the latest of the scheduled tasks. Tasks are not
+ * queued: a task scheduled while the previous one has not been taken by the
+ * worker yet replaces it, so the worker never falls behind the thread
+ * scheduling them.
+ */
+template <class Task>
+class LatestTaskWorker {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief           Runs the task on the worker thread, Flush waits for
+     * it to return.
+     * @param task      The task.
+     * @param number    Number of the task returned by Schedule.
+     * @param scheduled Time the task has been scheduled at.
+     */
+    using Handler = std::function<void(Task& task, uint64_t number,
+                                       Clock::time_point scheduled)>;
+
+    /**
+     * @brief           Starts the worker.
+     * @param handler   Function running the tasks.
+     * @param isRunOnStop   Whether the pending task is run before the worker
+     * stops or dropped.
+     */
+    LatestTaskWorker(Handler handler, bool isRunOnStop)
+        : handler(std::move(handler)),
+          isRunOnStop(isRunOnStop),
+          worker(&LatestTaskWorker::Run, this) {}
+
+    /**
+     * @brief           Stops the worker after the task it is running.
+     */
+    ~LatestTaskWorker() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            isStopped = true;
+        }
+        condition.notify_all();
+        worker.join();
+    }
+
+    LatestTaskWorker(const LatestTaskWorker&) = delete;
+    LatestTaskWorker& operator=(const LatestTaskWorker&) = delete;
+
+    /**
+     * @brief           Schedules the task. If the previous task has not been
+     * taken by the worker yet, it is replaced.
+     * @param task      The task.
+     * @param scheduled Time the task is scheduled at, passed to the handler.
+     * @param merge     Function called as merge(replaced, task) before the
+     * replaced task is dropped, so the task can take over its work.
+     * @return          Number of the task, it grows with every call.
+     */
+    template <class Merge>
+    uint64_t Schedule(Task task, Clock::time_point scheduled, Merge merge) {
+        std::unique_ptr<Task> scheduledTask(new Task(std::move(task)));
+        std::unique_ptr<Task> replaced;
+        uint64_t number;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            number = ++tasksNumber;
+            if (pending != nullptr) {
+                merge(*pending, *scheduledTask);
+                ++skippedCount;
+            }
+            // the replaced task is destroyed after the lock is released
+            replaced = std::move(pending);
+            pending = std::move(scheduledTask);
+            pendingNumber = number;
+            pendingTime = scheduled;
+        }
+        condition.notify_all();
+        return number;
+    }
+
+    uint64_t Schedule(Task task, Clock::time_point scheduled) {
+        return Schedule(std::move(task), scheduled, [](Task&, Task&) {});
+    }
+
+    /**
+     * @brief           Waits till all scheduled tasks have run.
+     */
+    void Flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock,
+                       [this] { return pending == nullptr && !isRunning; });
+    }
+
+    /**
+     * @brief           Returns number of tasks replaced by newer ones before
+     * they were run.
+     */
+    size_t GetSkippedCount() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return skippedCount;
+    }
+
+   private:
+    Handler handler;
+    bool isRunOnStop;
+    mutable std::mutex mutex;
+    // notified when a task is scheduled or has run
+    std::condition_variable condition;
+    std::unique_ptr<Task> pending;
+    uint64_t pendingNumber = 0;
+    Clock::time_point pendingTime;
+    uint64_t tasksNumber = 0;
+    size_t skippedCount = 0;
+    bool isRunning = false;
+    bool isStopped = false;
+    std::thread worker;
+
+    void Run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            condition.wait(lock,
+                           [this] { return pending != nullptr || isStopped; });
+            if (isStopped && (pending == nullptr || !isRunOnStop)) {
+                return;
+            }
+            std::unique_ptr<Task> task = std::move(pending);
+            uint64_t number = pendingNumber;
+            Clock::time_point scheduled = pendingTime;
+            isRunning = true;
+
+            lock.unlock();
+            handler(*task, number, scheduled);
+            task.reset();
+            lock.lock();
+
+            isRunning = false;
+            condition.notify_all();
+        }
+    }
+};
+
+#endif  // TEXT_EDITOR_LATEST_TASK_WORKER_H_
@@ -0,0 +1,36 @@
+#ifndef TEXT_EDITOR_MAPPED_FILE_H_
+#define TEXT_EDITOR_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+/**
+ * Read-only file mapped into memory. Parts of the file are read by the system
+ * only when they are touched, so opening doesn't depend on the file size.
+ */
+class MappedFile {
+   public:
+    /**
+     * @brief           Maps the file into memory.
+     * @param path      Path to the file.
+     * @return          Pointer to the mapped file or nullptr if the file
+     * cannot be opened.
+     */
+    static std::shared_ptr<MappedFile> Open(const std::string& path);
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+
+    const char* GetData() const;
+    size_t GetSize() const;
+
+   private:
+    const char* data = nullptr;
+    size_t size = 0;
+
+    MappedFile(const char* data, size_t size);
+};
+
+#endif  // TEXT_EDITOR_MAPPED_FILE_H_
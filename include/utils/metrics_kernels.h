@@ -0,0 +1,55 @@
+#ifndef TEXT_EDITOR_METRICS_KERNELS_H_
+#define TEXT_EDITOR_METRICS_KERNELS_H_
+
+#include <cstddef>
+
+/**
+ * Passes over arrays of glyph metrics used to compose rows. Every kernel has
+ * a scalar, an SSE2 and an AVX2 version, the best one supported by the
+ * processor is chosen at run time.
+ */
+class MetricsKernels {
+   public:
+    enum InstructionSet { SCALAR, SSE2, AVX2 };
+
+    /**
+     * @brief           Returns the best instruction set supported by the
+     * processor.
+     */
+    static InstructionSet GetSupportedInstructionSet();
+    static InstructionSet GetInstructionSet();
+
+    /**
+     * @brief           Chooses the versions of the kernels, e.g. to compare
+     * them.
+     * @param set       Instruction set, a set not supported by the processor
+     * is replaced by the best supported one.
+     */
+    static void SetInstructionSet(InstructionSet set);
+
+    /**
+     * @brief           Sums the values.
+     */
+    static int Sum(const int* values, size_t count);
+
+    /**
+     * @brief           Finds the maximum of the values.
+     * @return          The maximum or 0 if there are no values.
+     */
+    static int Max(const int* values, size_t count);
+
+    /**
+     * @brief           Calculates inclusive prefix sums: sums[i] is the sum
+     * of the values up to the i-th one. The arrays may be the same.
+     */
+    static void PrefixSum(const int* values, size_t count, int* sums);
+
+    /**
+     * @brief           Finds the first value greater than the limit, e.g.
+     * the character whose running width exceeds the row width.
+     * @return          Index of the value or count if there is none.
+     */
+    static size_t FindGreater(const int* values, size_t count, int limit);
+};
+
+#endif  // TEXT_EDITOR_METRICS_KERNELS_H_
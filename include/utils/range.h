@@ -0,0 +1,22 @@
+#ifndef TEXT_EDITOR_RANGE_H_
+#define TEXT_EDITOR_RANGE_H_
+
+/**
+ * Pair of iterators usable in range-based for loops.
+ */
+template <class Iterator>
+class Range {
+   public:
+    Range() = default;
+    Range(Iterator begin, Iterator end) : first(begin), last(end) {}
+
+    Iterator begin() const { return first; }
+    Iterator end() const { return last; }
+    bool empty() const { return first == last; }
+
+   private:
+    Iterator first{};
+    Iterator last{};
+};
+
+#endif  // TEXT_EDITOR_RANGE_H_
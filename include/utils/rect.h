@@ -0,0 +1,45 @@
+#ifndef TEXT_EDITOR_RECT_H_
+#define TEXT_EDITOR_RECT_H_
+
+/**
+ * Rectangle given by the upper-left corner and size. Unlike glyphs it
+ * covers cells [x, x + width) and [y, y + height), so an empty rectangle
+ * covers nothing.
+ */
+struct Rect {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+
+    Rect() = default;
+    Rect(int x, int y, int width, int height);
+
+    int GetRightBorder() const noexcept;
+    int GetBottomBorder() const noexcept;
+    bool IsEmpty() const noexcept;
+
+    bool Intersects(const Rect& rect) const noexcept;
+    bool Contains(const Rect& rect) const noexcept;
+
+    /**
+     * @brief           Checks whether the rectangles intersect or have a
+     * common border.
+     */
+    bool Touches(const Rect& rect) const noexcept;
+
+    /**
+     * @brief           Returns the common part of rectangles, it is empty if
+     * they don't intersect.
+     */
+    Rect Intersection(const Rect& rect) const noexcept;
+
+    /**
+     * @brief           Returns the smallest rectangle containing both.
+     */
+    Rect Union(const Rect& rect) const noexcept;
+
+    bool operator==(const Rect& rect) const noexcept;
+};
+
+#endif  // TEXT_EDITOR_RECT_H_
@@ -0,0 +1,68 @@
+#ifndef TEXT_EDITOR_THREAD_POOL_H_
+#define TEXT_EDITOR_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of worker threads running loops over independent items. The
+ * thread starting a loop takes part in it as well, so a pool without workers
+ * runs loops sequentially.
+ */
+class ThreadPool {
+   public:
+    /**
+     * @param threadsCount  Number of worker threads.
+     */
+    explicit ThreadPool(size_t threadsCount);
+
+    /**
+     * @brief           Stops the workers. Must not be called during a loop.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief           Calls the function for every index from 0 to count - 1
+     * on the workers and the calling thread, and returns when all calls are
+     * done. Loops started from several threads run one after another.
+     * @param count     Number of items.
+     * @param function  Function processing the item by its index.
+     */
+    void ParallelFor(size_t count, const std::function<void(size_t)>& function);
+
+    size_t GetThreadsCount() const;
+
+   private:
+    std::vector<std::thread> workers;
+    // only one loop runs at a time
+    std::mutex loopMutex;
+    std::mutex mutex;
+    // notified when a loop starts or the pool stops
+    std::condition_variable started;
+    // notified when a worker finishes its part of the loop
+    std::condition_variable finished;
+    const std::function<void(size_t)>* loop = nullptr;
+    size_t loopCount = 0;
+    // incremented for every loop, so workers don't run a loop twice
+    size_t loopNumber = 0;
+    size_t busyWorkersCount = 0;
+    bool isStopped = false;
+    std::atomic<size_t> nextIndex{0};
+
+    void Run();
+
+    /**
+     * @brief           Takes items of the loop till none is left.
+     */
+    void RunLoop(const std::function<void(size_t)>& function, size_t count);
+};
+
+#endif  // TEXT_EDITOR_THREAD_POOL_H_
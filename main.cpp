@@ -2,7 +2,6 @@
 #include <memory>
 #include <string>
 #include <fstream>
-#include <boost/archive/text_iarchive.hpp>
 
 #include "document/document.h"
 
@@ -23,12 +22,14 @@
 #include "executor/command/move_cursor_right.h"
 
 #include "compositor/simple_compositor/simple_compositor.h"
+#include "renderer/text_renderer/text_renderer.h"
 
 int main() {
     auto d = std::make_shared<Document>(std::make_shared<SimpleCompositor>());
+    d->SetRenderer(std::make_shared<TextRenderer>(std::cout));
 
     auto document = std::dynamic_pointer_cast<IDocument>(d);
-    auto controller = std::make_unique<Executor>(2);
+    auto controller = std::make_unique<Executor>(1024);
 
     controller->Do(std::make_shared<InsertCharacter>(document, 'H'));
     controller->Do(std::make_shared<InsertCharacter>(document, 'E'));
@@ -8,16 +8,46 @@ BOOST_CLASS_EXPORT_IMPLEMENT(Compositor)
 void Compositor::SetDocument(Document* document) {
     // std::cout << "Compositor::SetDocument()" << std::endl;
     this->document = document;
+    this->isLayoutValid = false;
 }
 
-void Compositor::SetTopIndent(int value) { this->topIndent = value; }
+void Compositor::Compose(const Page::PagePtr&, const Glyph::GlyphPtr&) {
+    document->InvalidateAll();
+    Compose();
+}
+
+void Compositor::SetTopIndent(int value) {
+    this->topIndent = value;
+    this->isLayoutValid = false;
+}
 
-void Compositor::SetBottomIndent(int value) { this->bottomIndent = value; }
+void Compositor::SetBottomIndent(int value) {
+    this->bottomIndent = value;
+    this->isLayoutValid = false;
+}
 
-void Compositor::SetLeftIndent(int value) { this->leftIndent = value; }
+void Compositor::SetLeftIndent(int value) {
+    this->leftIndent = value;
+    this->isLayoutValid = false;
+}
 
-void Compositor::SetRightIndent(int value) { this->rightIndent = value; }
+void Compositor::SetRightIndent(int value) {
+    this->rightIndent = value;
+    this->isLayoutValid = false;
+}
 
-void Compositor::SetAlignment(Alignment value) { this->alignment = value; }
+void Compositor::SetAlignment(Alignment value) {
+    this->alignment = value;
+    this->isLayoutValid = false;
+}
 
-void Compositor::SetLineSpacing(int value) { this->lineSpacing = value; }
\ No newline at end of file
+void Compositor::SetLineSpacing(int value) {
+    this->lineSpacing = value;
+    this->isLayoutValid = false;
+}
+int Compositor::GetTopIndent() const { return topIndent; }
+int Compositor::GetBottomIndent() const { return bottomIndent; }
+int Compositor::GetLeftIndent() const { return leftIndent; }
+int Compositor::GetRightIndent() const { return rightIndent; }
+Compositor::Alignment Compositor::GetAlignment() const { return alignment; }
+int Compositor::GetLineSpacing() const { return lineSpacing; }
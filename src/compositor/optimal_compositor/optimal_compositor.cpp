@@ -0,0 +1,302 @@
+#include "compositor/optimal_compositor/optimal_compositor.h"
+
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+BOOST_CLASS_EXPORT_IMPLEMENT(OptimalCompositor)
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+#include "document/glyphs/character.h"
+#include "document/glyphs/row.h"
+
+// rows of all cached paragraphs, the least recently used paragraphs are
+// dropped above it
+const size_t kMaxCachedRows = 1 << 20;
+
+void OptimalCompositor::Compose() {
+    pendingBreaks.clear();
+    SimpleCompositor::Compose();
+}
+
+std::shared_ptr<Compositor> OptimalCompositor::Clone() const {
+    auto compositor = std::make_shared<OptimalCompositor>(
+        topIndent, bottomIndent, leftIndent, rightIndent, alignment,
+        lineSpacing);
+    compositor->SetThreadPool(GetThreadPool());
+    return compositor;
+}
+
+void OptimalCompositor::Compose(const Page::PagePtr& page,
+                                const Glyph::GlyphPtr& glyph) {
+    RowPosition position;
+    // changed settings or structural edits need the whole document
+    if (!isLayoutValid || glyph->IsContainer() ||
+        !FindRow(page, glyph, position)) {
+        Compose();
+        return;
+    }
+
+    // rows of the paragraph with the edited row, an inserted or removed
+    // newline makes them hold two paragraphs or a joined one
+    std::deque<RowPosition> rows = {position};
+    RowPosition previous = position;
+    while (GetPreviousRow(previous) &&
+           !IsLineBreak(previous.row->GetLastGlyph())) {
+        rows.push_front(previous);
+    }
+    RowPosition next = position;
+    while (!IsLineBreak(rows.back().row->GetLastGlyph()) && GetNextRow(next)) {
+        rows.push_back(next);
+    }
+    RowPosition after = rows.back();
+    bool hasNextRow = GetNextRow(after);
+
+    int width = position.column->GetWidth();
+    std::vector<const Glyph*> characters;
+    std::vector<size_t> oldLengths;
+    size_t editedIndex = 0;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        size_t count = 0;
+        for (const auto& character : rows[i].row->GetChildren()) {
+            characters.push_back(character.get());
+            ++count;
+        }
+        oldLengths.push_back(count);
+        if (rows[i].row == position.row) {
+            editedIndex = i;
+        }
+    }
+    std::vector<size_t> rowLengths =
+        BreakParagraphs(characters.begin(), characters.end(), width);
+
+    GlyphContainer::GlyphList list;
+    if (rowLengths.size() != rows.size()) {
+        if (hasNextRow) {
+            // the rows below have to be moved, the breaks of their
+            // paragraphs are taken from the cache
+            Compose();
+            return;
+        }
+        // the paragraph is the last one, so it is composed till the end
+        for (auto& row : rows) {
+            CutCharacters(row.row, list);
+        }
+        pendingBreaks.assign(rowLengths.begin(), rowLengths.end());
+        RowPosition first = rows.front();
+        ComposeTail(first, first.row->GetPosition().y, list);
+        return;
+    }
+
+    // only rows whose characters change are filled again, and the edited
+    // row is placed again in any case
+    size_t first = editedIndex;
+    size_t last = editedIndex;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if (rowLengths[i] != oldLengths[i]) {
+            first = std::min(first, i);
+            last = std::max(last, i);
+        }
+    }
+    for (size_t i = first; i <= last; ++i) {
+        CutCharacters(rows[i].row, list);
+    }
+    pendingBreaks.assign(rowLengths.begin() + first,
+                         rowLengths.begin() + last + 1);
+    for (size_t i = first; i <= last; ++i) {
+        ComposeRow(rows[i].row, rows[i].column->GetPosition().x,
+                   rows[i].row->GetPosition().y, width, list);
+    }
+
+    // if the height of some row has changed all rows below it have to be
+    // moved
+    if (last + 1 == rows.size() && hasNextRow) {
+        rows.push_back(after);
+    }
+    for (size_t i = first + 1; i < rows.size() && i <= last + 1; ++i) {
+        const RowPosition& above = rows[i - 1];
+        if (rows[i].column == above.column &&
+            rows[i].row->GetPosition().y != above.row->GetPosition().y +
+                                                above.row->GetHeight() +
+                                                lineSpacing) {
+            Compose();
+            return;
+        }
+    }
+}
+
+size_t OptimalCompositor::GetSolvedParagraphsCount() const {
+    return solvedCount;
+}
+
+size_t OptimalCompositor::GetCachedParagraphsCount() const {
+    return cache.size();
+}
+
+size_t OptimalCompositor::BreakRow(const GlyphContainer::GlyphList& list,
+                                   int width) {
+    if (pendingBreaks.empty() && !list.empty()) {
+        // the list starts with the next paragraph
+        auto last = std::find_if(list.begin(), list.end(), IsLineBreak);
+        if (last != list.end()) {
+            ++last;
+        }
+        std::vector<size_t> rowLengths;
+        BreakParagraph(list.begin(), last, width, rowLengths);
+        pendingBreaks.assign(rowLengths.begin(), rowLengths.end());
+    }
+    if (pendingBreaks.empty()) {
+        return 0;
+    }
+    size_t count = pendingBreaks.front();
+    pendingBreaks.pop_front();
+    return count;
+}
+
+bool OptimalCompositor::ParagraphKey::operator==(
+    const ParagraphKey& key) const {
+    return hash == key.hash && length == key.length && width == key.width;
+}
+
+size_t OptimalCompositor::ParagraphKeyHash::operator()(
+    const ParagraphKey& key) const {
+    return size_t(key.hash ^ (uint64_t(key.width) << 32) ^ key.length);
+}
+
+template <class Iterator>
+void OptimalCompositor::BreakParagraph(Iterator first, Iterator last,
+                                       int width,
+                                       std::vector<size_t>& rowLengths) {
+    std::vector<int> widths;
+    std::vector<bool> isSpace;
+    // FNV-1a of the symbols and the widths
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+    for (auto it = first; it != last; ++it) {
+        const Glyph& glyph = **it;
+        const Character* character = glyph.As<Character>();
+        char symbol = character != nullptr ? character->GetChar() : '\0';
+        // characters wider than row are lessened in ComposeRow
+        int characterWidth = std::min(glyph.GetWidth(), width);
+        widths.push_back(characterWidth);
+        isSpace.push_back(symbol == ' ');
+        mix(static_cast<unsigned char>(symbol));
+        mix(uint32_t(characterWidth));
+    }
+
+    ParagraphKey key = {hash, widths.size(), width};
+    auto found = cache.find(key);
+    if (found != cache.end()) {
+        uses.splice(uses.begin(), uses, found->second.use);
+        rowLengths.insert(rowLengths.end(),
+                          found->second.rowLengths.begin(),
+                          found->second.rowLengths.end());
+        return;
+    }
+
+    std::vector<size_t> solved = Solve(widths, isSpace, width);
+    ++solvedCount;
+    rowLengths.insert(rowLengths.end(), solved.begin(), solved.end());
+    uses.push_front(key);
+    cachedRowsCount += solved.size();
+    cache.emplace(key, CachedBreaks{std::move(solved), uses.begin()});
+    TrimCache();
+}
+
+template <class Iterator>
+std::vector<size_t> OptimalCompositor::BreakParagraphs(Iterator first,
+                                                       Iterator last,
+                                                       int width) {
+    std::vector<size_t> rowLengths;
+    Iterator paragraph = first;
+    for (auto it = first; it != last; ++it) {
+        const Glyph& glyph = **it;
+        const Character* character = glyph.As<Character>();
+        if (character != nullptr && character->GetChar() == '\n') {
+            BreakParagraph(paragraph, std::next(it), width, rowLengths);
+            paragraph = std::next(it);
+        }
+    }
+    if (paragraph != last) {
+        BreakParagraph(paragraph, last, width, rowLengths);
+    }
+    return rowLengths;
+}
+
+std::vector<size_t> OptimalCompositor::Solve(const std::vector<int>& widths,
+                                             const std::vector<bool>& isSpace,
+                                             int width) {
+    size_t length = widths.size();
+    // offsets[i] is the width of the first i characters
+    std::vector<int64_t> offsets(length + 1, 0);
+    for (size_t i = 0; i < length; ++i) {
+        offsets[i + 1] = offsets[i] + widths[i];
+    }
+
+    // numbers of characters a row can end after: spaces and the end of the
+    // paragraph, or any character of a word wider than the row
+    std::vector<size_t> breaks = {0};
+    std::vector<bool> isForced = {false};
+    for (size_t i = 1; i <= length; ++i) {
+        if (i != length && !isSpace[i - 1]) {
+            continue;
+        }
+        size_t start = breaks.back();
+        if (offsets[i] - offsets[start] > width) {
+            for (size_t j = start + 1; j < i; ++j) {
+                breaks.push_back(j);
+                isForced.push_back(true);
+            }
+        }
+        breaks.push_back(i);
+        isForced.push_back(false);
+    }
+
+    // costs[k] is the least sum of squared free space of the rows before
+    // breaks[k], forced breaks cost as much as the emptiest row
+    const int64_t kInfinity = std::numeric_limits<int64_t>::max();
+    const int64_t kForcedPenalty = int64_t(width) * width;
+    std::vector<int64_t> costs(breaks.size(), kInfinity);
+    std::vector<size_t> previous(breaks.size(), 0);
+    costs[0] = 0;
+    size_t first = 0;
+    for (size_t k = 1; k < breaks.size(); ++k) {
+        int64_t end = offsets[breaks[k]];
+        // rows starting before the first break are wider than the row
+        while (end - offsets[breaks[first]] > width) {
+            ++first;
+        }
+        int64_t penalty = isForced[k] ? kForcedPenalty : 0;
+        for (size_t j = first; j < k; ++j) {
+            int64_t space = width - (end - offsets[breaks[j]]);
+            // the last row of the paragraph may be free
+            int64_t cost = costs[j] + penalty +
+                           (breaks[k] == length ? 0 : space * space);
+            if (cost < costs[k]) {
+                costs[k] = cost;
+                previous[k] = j;
+            }
+        }
+    }
+
+    std::vector<size_t> rowLengths;
+    for (size_t k = breaks.size() - 1; k != 0; k = previous[k]) {
+        rowLengths.push_back(breaks[k] - breaks[previous[k]]);
+    }
+    std::reverse(rowLengths.begin(), rowLengths.end());
+    return rowLengths;
+}
+
+void OptimalCompositor::TrimCache() {
+    // the paragraph just solved is always kept
+    while (cachedRowsCount > kMaxCachedRows && uses.size() > 1) {
+        auto found = cache.find(uses.back());
+        cachedRowsCount -= found->second.rowLengths.size();
+        cache.erase(found);
+        uses.pop_back();
+    }
+}
@@ -4,17 +4,302 @@
 #include <boost/archive/text_oarchive.hpp>
 BOOST_CLASS_EXPORT_IMPLEMENT(SimpleCompositor)
 
+#include <algorithm>
 #include <cmath>
+#include <deque>
+#include <iterator>
+#include <utility>
 
+#include "document/glyphs/character.h"
 #include "document/glyphs/row.h"
+#include "utils/metrics_kernels.h"
 
 int charHeight = 1;
+// rows placed by a thread at once
+const size_t kRowsChunkSize = 64;
+// characters whose widths are read at once to break a row
+const size_t kMetricsChunkSize = 64;
+
+// rows are always glyph containers
+static const GlyphMetrics& GetRowMetrics(const Glyph::GlyphPtr& row) {
+    return static_cast<const GlyphContainer&>(*row).GetMetrics();
+}
+
+void SimpleCompositor::SetThreadPool(std::shared_ptr<ThreadPool> threadPool) {
+    this->threadPool = std::move(threadPool);
+}
+
+std::shared_ptr<ThreadPool> SimpleCompositor::GetThreadPool() const {
+    return threadPool;
+}
+
+std::shared_ptr<Compositor> SimpleCompositor::Clone() const {
+    auto compositor = std::make_shared<SimpleCompositor>(
+        topIndent, bottomIndent, leftIndent, rightIndent, alignment,
+        lineSpacing);
+    compositor->SetThreadPool(threadPool);
+    return compositor;
+}
 
 void SimpleCompositor::Compose() {
     // std::cout << "SimpleCompositor::Compose()" << std::endl;
+    document->InvalidateAll();
     GlyphContainer::GlyphList list = CutAllCharacters();
 
-    Page::PagePtr page = document->GetFirstPage();
+    isPlacingDeferred = threadPool != nullptr;
+    ComposePages(document->GetFirstPage(), list);
+    isPlacingDeferred = false;
+    PlaceDeferredRows();
+    isLayoutValid = true;
+}
+
+void SimpleCompositor::Compose(const Page::PagePtr& page,
+                               const Glyph::GlyphPtr& glyph) {
+    RowPosition position;
+    // changed settings or structural edits need the whole document
+    if (!isLayoutValid || glyph->IsContainer() ||
+        !FindRow(page, glyph, position)) {
+        Compose();
+        return;
+    }
+    Glyph::GlyphPtr editedRow = position.row;
+
+    // if the edited row became shorter its first characters can move up to
+    // the previous row
+    RowPosition previous = position;
+    if (GetPreviousRow(previous)) {
+        position = previous;
+    }
+
+    GlyphContainer::GlyphList list;
+    // rows ahead of the current one whose characters are already in the list
+    std::deque<RowPosition> pulledRows;
+    bool isEditedRowComposed = false;
+    int currentY = position.row->GetPosition().y;
+    while (true) {
+        int width = position.column->GetWidth();
+        CutCharacters(position.row, list);
+
+        // take characters from the next rows while the first of them still
+        // fits into the current one
+        RowPosition ahead = pulledRows.empty() ? position : pulledRows.back();
+        while (GetNextRow(ahead)) {
+            Glyph::GlyphPtr first = ahead.row->GetFirstGlyph();
+            if (first != nullptr &&
+                (EndsParagraph(list) ||
+                 GetListWidth(list, width) +
+                         std::min(first->GetWidth(), width) >
+                     width)) {
+                break;
+            }
+            CutCharacters(ahead.row, list);
+            pulledRows.push_back(ahead);
+        }
+
+        if (list.empty()) {
+            // there are no characters left till the end of the document
+            ComposeTail(position, currentY, list);
+            return;
+        }
+
+        ComposeRow(position.row, position.column->GetPosition().x, currentY,
+                   width, list);
+        if (position.row == editedRow) {
+            isEditedRowComposed = true;
+        }
+
+        RowPosition next = position;
+        if (!GetNextRow(next)) {
+            // the rest of characters goes to new rows and pages
+            next.row = nullptr;
+            ComposeTail(next,
+                        currentY + position.row->GetHeight() + lineSpacing,
+                        list);
+            return;
+        }
+
+        int nextY = (next.column == position.column)
+                        ? currentY + position.row->GetHeight() + lineSpacing
+                        : topIndent;
+        bool isPulled = !pulledRows.empty();
+        if (isPulled) {
+            pulledRows.pop_front();
+        }
+
+        if (isEditedRowComposed && list.empty() && !isPulled) {
+            // line breaks match the previous layout, but if the height of
+            // some row has changed all rows below it have to be moved
+            if (next.row->GetPosition().y != nextY) {
+                Compose();
+            }
+            return;
+        }
+
+        position = next;
+        currentY = nextY;
+    }
+}
+
+void SimpleCompositor::PlaceDeferredRows() {
+    if (deferredRows.empty()) {
+        return;
+    }
+    // rows are handed out in chunks, so threads don't fight for every row
+    size_t chunksCount =
+        (deferredRows.size() + kRowsChunkSize - 1) / kRowsChunkSize;
+    threadPool->ParallelFor(chunksCount, [this](size_t chunk) {
+        size_t end =
+            std::min(deferredRows.size(), (chunk + 1) * kRowsChunkSize);
+        for (size_t i = chunk * kRowsChunkSize; i < end; ++i) {
+            PlaceCharacters(deferredRows[i]);
+        }
+    });
+    for (auto& row : deferredRows) {
+        document->Invalidate(row);
+    }
+    deferredRows.clear();
+}
+
+void SimpleCompositor::ComposeTail(RowPosition& position, int y,
+                                   GlyphContainer::GlyphList& list) {
+    if (position.row != nullptr &&
+        position.row == position.column->GetFirstGlyph()) {
+        if (position.column == position.page->GetFirstGlyph()) {
+            ComposePages(position.page, list);
+            return;
+        }
+        ComposeColumns(position.page, position.column,
+                       position.column->GetPosition().x, list);
+    } else {
+        ComposeRows(position.column, position.row, y, list);
+        ComposeColumns(position.page,
+                       position.page->GetNextGlyph(position.column),
+                       position.column->GetRightBorder(), list);
+    }
+    ComposePages(document->GetNextPage(position.page), list);
+}
+
+void SimpleCompositor::CutCharacters(Glyph::GlyphPtr& row,
+                                     GlyphContainer::GlyphList& list) {
+    Glyph::GlyphPtr first = row->GetFirstGlyph();
+    if (first == nullptr) {
+        return;
+    }
+    // all characters are removed at once, so the row is not shifted on every
+    // removal
+    Glyph::ChildrenRange characters = row->GetChildren();
+    list.insert(list.end(), characters.begin(), characters.end());
+    std::static_pointer_cast<Row>(row)->Remove(first, row->GetLastGlyph());
+}
+
+GlyphContainer::GlyphList SimpleCompositor::CutAllCharacters() {
+    Glyph::GlyphList charactersList;
+
+    // only characters are removed, so the walk over rows stays valid
+    for (Glyph::GlyphPtr row : document->GetRows()) {
+        CutCharacters(row, charactersList);
+    }
+
+    return charactersList;
+}
+
+bool SimpleCompositor::FindRow(const Page::PagePtr& page,
+                               const Glyph::GlyphPtr& glyph,
+                               RowPosition& position) {
+    // the same search as in Page::Insert and Column::Insert
+    for (const auto& column : page->GetChildren()) {
+        if (!column->Intersects(glyph)) {
+            continue;
+        }
+        for (const auto& row : column->GetChildren()) {
+            if (row->Intersects(glyph)) {
+                position = {page, column, row};
+                return true;
+            }
+        }
+        return false;
+    }
+    return false;
+}
+
+bool SimpleCompositor::GetNextRow(RowPosition& position) {
+    Glyph::GlyphPtr row = position.column->GetNextGlyph(position.row);
+    if (row != nullptr) {
+        position.row = row;
+        return true;
+    }
+
+    Page::PagePtr page = position.page;
+    Glyph::GlyphPtr column = page->GetNextGlyph(position.column);
+    while (page != nullptr) {
+        for (; column != nullptr; column = page->GetNextGlyph(column)) {
+            row = column->GetFirstGlyph();
+            if (row != nullptr) {
+                position = {page, column, row};
+                return true;
+            }
+        }
+        page = document->GetNextPage(page);
+        if (page != nullptr) {
+            column = page->GetFirstGlyph();
+        }
+    }
+    return false;
+}
+
+bool SimpleCompositor::GetPreviousRow(RowPosition& position) {
+    Glyph::GlyphPtr row = position.column->GetPreviousGlyph(position.row);
+    if (row != nullptr) {
+        position.row = row;
+        return true;
+    }
+
+    Page::PagePtr page = position.page;
+    Glyph::GlyphPtr column = page->GetPreviousGlyph(position.column);
+    while (page != nullptr) {
+        for (; column != nullptr; column = page->GetPreviousGlyph(column)) {
+            row = column->GetLastGlyph();
+            if (row != nullptr) {
+                position = {page, column, row};
+                return true;
+            }
+        }
+        page = document->GetPreviousPage(page);
+        if (page != nullptr) {
+            column = page->GetLastGlyph();
+        }
+    }
+    return false;
+}
+
+int SimpleCompositor::GetColumnWidth(const Page::PagePtr& page) const {
+    size_t columnsCount = page->GetColumnsCount();
+
+    // columns on page have the same width
+    return floor((page->GetWidth() - leftIndent - rightIndent) / columnsCount);
+}
+
+bool SimpleCompositor::IsLineBreak(const Glyph::GlyphPtr& glyph) {
+    const Character* character = glyph->As<Character>();
+    return character != nullptr && character->GetChar() == '\n';
+}
+
+bool SimpleCompositor::EndsParagraph(const GlyphContainer::GlyphList& list) {
+    return !list.empty() && IsLineBreak(list.back());
+}
+
+int SimpleCompositor::GetListWidth(const GlyphContainer::GlyphList& list,
+                                   int rowWidth) const {
+    // characters wider than row are lessened in ComposeRow
+    int width = 0;
+    for (const auto& glyph : list) {
+        width += std::min(glyph->GetWidth(), rowWidth);
+    }
+    return width;
+}
+
+void SimpleCompositor::ComposePages(Page::PagePtr page,
+                                    GlyphContainer::GlyphList& list) {
     while (page != nullptr) {
         if (list.empty() && page != document->GetFirstPage()) {
             Glyph::GlyphPtr pagePtr = std::static_pointer_cast<Glyph>(page);
@@ -28,51 +313,28 @@ void SimpleCompositor::Compose() {
     }
 
     while (!list.empty()) {
-        Page::PagePtr newPage =
-            std::make_shared<Page>(0, 0, pageWidth, pageHeight);
+        Page::PagePtr newPage = AllocateShared<Page>(
+            document->GetGlyphPool(), 0, 0, pageWidth, pageHeight);
         document->AddPage(newPage);
         ComposePage(newPage, list);
     }
 }
 
-GlyphContainer::GlyphList SimpleCompositor::CutAllCharacters() {
-    Glyph::GlyphList charactersList;
-
-    for (Page::PagePtr page = document->GetFirstPage(); page != nullptr;
-         page = document->GetNextPage(page)) {
-        for (Glyph::GlyphPtr column = page->GetFirstGlyph(); column != nullptr;
-             column = page->GetNextGlyph(column)) {
-            for (Glyph::GlyphPtr row = column->GetFirstGlyph(); row != nullptr;
-                 row = column->GetNextGlyph(row)) {
-                for (Glyph::GlyphPtr character = row->GetFirstGlyph();
-                     character != nullptr;) {
-                    charactersList.push_back(character);
-                    Glyph::GlyphPtr nextCharacter =
-                        row->GetNextGlyph(character);
-                    row->Remove(character);
-                    character = nextCharacter;
-                }
-            }
-        }
-    }
-
-    return charactersList;
-}
-
 void SimpleCompositor::ComposePage(Page::PagePtr& page,
                                    GlyphContainer::GlyphList& list) {
     // std::cout << "Composing page: " << page << " " << *page << std::endl;
+    ComposeColumns(page, page->GetFirstGlyph(), leftIndent, list);
+}
 
-    size_t columnsCount = page->GetColumnsCount();
-
-    // columns on page have the same width
-    int columnWidth =
-        floor((page->GetWidth() - leftIndent - rightIndent) / columnsCount);
-    Glyph::GlyphPtr column = page->GetFirstGlyph();
-    int currentX = leftIndent;
+void SimpleCompositor::ComposeColumns(Page::PagePtr& page,
+                                      Glyph::GlyphPtr column, int x,
+                                      GlyphContainer::GlyphList& list) {
+    int columnWidth = GetColumnWidth(page);
+    int currentX = x;
     while (column != nullptr) {
         if (list.empty() && column != page->GetFirstGlyph()) {
             Glyph::GlyphPtr nextColumn = page->GetNextGlyph(column);
+            document->Invalidate(column);
             page->Remove(column);
             column = nextColumn;
         } else {
@@ -93,11 +355,19 @@ void SimpleCompositor::ComposeColumn(Glyph::GlyphPtr& column, int x, int y,
     column->SetWidth(width);
     column->SetHeight(height);
 
-    Glyph::GlyphPtr row = column->GetFirstGlyph();
-    int currentY = topIndent;
+    ComposeRows(column, column->GetFirstGlyph(), topIndent, list);
+}
+
+void SimpleCompositor::ComposeRows(Glyph::GlyphPtr& column,
+                                   Glyph::GlyphPtr row, int y,
+                                   GlyphContainer::GlyphList& list) {
+    int x = column->GetPosition().x;
+    int width = column->GetWidth();
+    int currentY = y;
     while (row != nullptr) {
         if (list.empty() && row != column->GetFirstGlyph()) {
             Glyph::GlyphPtr nextRow = column->GetNextGlyph(row);
+            document->Invalidate(row);
             column->Remove(row);
             row = nextRow;
         } else {
@@ -109,10 +379,11 @@ void SimpleCompositor::ComposeColumn(Glyph::GlyphPtr& column, int x, int y,
 
     while (!list.empty()) {
         if (currentY + charHeight <= column->GetBottomBorder() - bottomIndent) {
-            Glyph::GlyphPtr newRow =
-                std::make_shared<Row>(0, 0, width, charHeight);
+            Glyph::GlyphPtr newRow = AllocateShared<Row>(
+                document->GetGlyphPool(), 0, 0, width, charHeight);
             column->Add(newRow);
             ComposeRow(newRow, x, currentY, width, list);
+            currentY += newRow->GetHeight() + lineSpacing;
         } else {
             break;  // cannot add one more row
         }
@@ -122,124 +393,116 @@ void SimpleCompositor::ComposeColumn(Glyph::GlyphPtr& column, int x, int y,
 void SimpleCompositor::ComposeRow(Glyph::GlyphPtr& row, int x, int y, int width,
                                   GlyphContainer::GlyphList& list) {
     // std::cout << "Composing row: " << row << " " << *row << std::endl;
+    // both the old and the new place of the row have to be drawn again
+    document->Invalidate(row);
     row->SetPosition(Point(x, y));
     row->SetWidth(width);
-
-    int currentX = 0;
-    while (!list.empty()) {
-        Glyph::GlyphPtr currentChar = list.front();
+    rowCharacters.clear();
+    for (size_t count = BreakRow(list, width); count > 0; --count) {
+        Glyph::GlyphPtr& currentChar = list.front();
         // if character is bigger than row, we cannot insert it in any row in
         // document, so lessen character
-        if (currentChar->GetWidth() > row->GetWidth()) {
-            currentChar->SetWidth(row->GetWidth());
-        }
-        // while there is enough space in row add characters
-        if (currentX + currentChar->GetWidth() <= row->GetWidth()) {
-            ComposeCharacter(currentChar, currentX,
-                             y);  // firstly set new position of char
-            row->Insert(currentChar);
-            currentX += currentChar->GetWidth();
-            list.pop_front();
-        } else {
-            break;  // move to the next row
+        if (currentChar->GetWidth() > width) {
+            currentChar->SetWidth(width);
         }
+        rowCharacters.push_back(std::move(currentChar));
+        list.pop_front();
+    }
+    // characters come in order, so all of them go to the end of the row at
+    // once
+    std::static_pointer_cast<Row>(row)->Add(rowCharacters);
+    // the row is as high as its highest character, so it becomes lower when
+    // such a character leaves it
+    const std::vector<int>& heights = GetRowMetrics(row).height;
+    row->SetHeight(std::max(
+        charHeight, MetricsKernels::Max(heights.data(), heights.size())));
+    if (isPlacingDeferred) {
+        deferredRows.push_back(row);
+        return;
     }
+    PlaceCharacters(row);
+    document->Invalidate(row);
+}
 
-    // now compose all characters that was added to row due to format params
-    switch (alignment) {
-        case LEFT: {
-            currentX = leftIndent;
-            break;
-        }
-        case CENTER: {
-            currentX =
-                leftIndent + floor((pageWidth - leftIndent - rightIndent -
-                                    GetNestedGlyphsWidth(row)) /
-                                   2);
-            break;
-        }
-        case RIGHT: {
-            currentX = (pageWidth - rightIndent - GetNestedGlyphsWidth(row));
-            break;
+size_t SimpleCompositor::BreakRow(const GlyphContainer::GlyphList& list,
+                                  int width) {
+    size_t count = 0;
+    int currentX = 0;
+    // widths are read in chunks, so a short row doesn't read the whole list
+    int offsets[kMetricsChunkSize];
+    auto it = list.begin();
+    while (it != list.end()) {
+        size_t chunkSize = 0;
+        bool isParagraphEnd = false;
+        for (; it != list.end() && chunkSize < kMetricsChunkSize; ++it) {
+            offsets[chunkSize++] = std::min((*it)->GetWidth(), width);
+            if (IsLineBreak(*it)) {
+                isParagraphEnd = true;  // the paragraph ends with the row
+                break;
+            }
         }
-        case JUSTIFIED: {
-            currentX = leftIndent;
+        // while there is enough space in row add characters
+        MetricsKernels::PrefixSum(offsets, chunkSize, offsets);
+        size_t fitting =
+            MetricsKernels::FindGreater(offsets, chunkSize, width - currentX);
+        count += fitting;
+        if (fitting < chunkSize || isParagraphEnd) {
             break;
         }
+        currentX += offsets[chunkSize - 1];
     }
-    // std::cout << "currentX " << currentX << " " << GetNestedGlyphsWidth(row)
-    //           << std::endl;
+    return count;
+}
+
+void SimpleCompositor::PlaceCharacters(Glyph::GlyphPtr& row) {
+    int y = row->GetPosition().y;
+    // widths are copied from the metrics of the row, the rest is done by
+    // passes over them; rows are placed concurrently, so the copy is not
+    // shared
+    std::vector<int> offsets = GetRowMetrics(row).width;
+    int freeSpace = pageWidth - leftIndent - rightIndent -
+                    MetricsKernels::Sum(offsets.data(), offsets.size());
 
-    int characterSpacing;
+    // now compose all characters that was added to row due to format params
+    int currentX = leftIndent;
+    int characterSpacing = 0;
     switch (alignment) {
         case LEFT: {
-            characterSpacing = 0;
             break;
         }
         case CENTER: {
-            characterSpacing = 0;
+            currentX = leftIndent + freeSpace / 2;
             break;
         }
         case RIGHT: {
-            characterSpacing = 0;
+            currentX = leftIndent + freeSpace;
             break;
         }
         case JUSTIFIED: {
-            int glyphsCount = GetNestedGlyphsCount(row);
-            if (glyphsCount == 0) {
-                characterSpacing = 0;
-            } else {
-                characterSpacing = floor((pageWidth - leftIndent - rightIndent -
-                                          GetNestedGlyphsWidth(row)) /
-                                         glyphsCount);
+            if (!offsets.empty()) {
+                characterSpacing = freeSpace / int(offsets.size());
+                for (auto& offset : offsets) {
+                    offset += characterSpacing;
+                }
             }
             break;
         }
     }
 
-    // std::cout << "characterSpacing " << characterSpacing << std::endl;
-
-    Glyph::GlyphPtr character = row->GetFirstGlyph();
-    while (character != nullptr) {
-        ComposeCharacter(character, currentX, y);
-        currentX += character->GetWidth() + characterSpacing;
-        character = row->GetNextGlyph(character);
+    // offsets[i] becomes the distance from the row start to the end of the
+    // i-th character
+    MetricsKernels::PrefixSum(offsets.data(), offsets.size(), offsets.data());
+    size_t i = 0;
+    for (const auto& character : row->GetChildren()) {
+        int x = (i == 0) ? currentX : currentX + offsets[i - 1];
+        ComposeCharacter(character, x, y);
+        ++i;
     }
 }
 
-void SimpleCompositor::ComposeCharacter(Glyph::GlyphPtr& character, int x,
-                                        int y) {
+void SimpleCompositor::ComposeCharacter(const Glyph::GlyphPtr& character,
+                                        int x, int y) {
     // std::cout << "Composing character: " << character << " " << *character
     //           << std::endl;
     character->SetPosition(Point(x, y));
 }
-
-size_t SimpleCompositor::GetNestedGlyphsCount(Glyph::GlyphPtr& glyph) {
-    size_t count = 0;
-    Glyph::GlyphPtr current = glyph->GetFirstGlyph();
-    while (current != nullptr) {
-        ++count;
-        current = glyph->GetNextGlyph(current);
-    }
-    return count;
-}
-
-int SimpleCompositor::GetNestedGlyphsWidth(Glyph::GlyphPtr& glyph) {
-    int width = 0;
-    Glyph::GlyphPtr current = glyph->GetFirstGlyph();
-    while (current != nullptr) {
-        width += current->GetWidth();
-        current = glyph->GetNextGlyph(current);
-    }
-    return width;
-}
-
-int SimpleCompositor::GetNestedGlyphsHeight(Glyph::GlyphPtr& glyph) {
-    int height = 0;
-    Glyph::GlyphPtr current = glyph->GetFirstGlyph();
-    while (current != nullptr) {
-        height += current->GetHeight();
-        current = glyph->GetNextGlyph(current);
-    }
-    return height;
-}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "document/autosave.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "document/document_format.h"
+
+Autosave::Autosave(std::string path, Callback saved)
+    : path(std::move(path)),
+      saved(std::move(saved)),
+      worker(
+          [this](DocumentSnapshot& snapshot, uint64_t number,
+                 Worker::Clock::time_point taken) {
+              Write(snapshot, number, taken);
+          },
+          true) {}
+
+uint64_t Autosave::Save(const Document& document) {
+    Worker::Clock::time_point start = Worker::Clock::now();
+    DocumentSnapshot snapshot = document.GetSnapshot();
+    std::chrono::microseconds snapshotTime =
+        ToMicroseconds(Worker::Clock::now() - start);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        metrics.lastSnapshotTime = snapshotTime;
+        metrics.maxSnapshotTime =
+            std::max(metrics.maxSnapshotTime, snapshotTime);
+    }
+    return worker.Schedule(std::move(snapshot), start);
+}
+
+void Autosave::Flush() { worker.Flush(); }
+
+Autosave::Metrics Autosave::GetMetrics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Metrics current = metrics;
+    current.skippedCount = worker.GetSkippedCount();
+    return current;
+}
+
+const std::string& Autosave::GetPath() const { return path; }
+
+void Autosave::Write(DocumentSnapshot& snapshot, uint64_t number,
+                     Worker::Clock::time_point taken) {
+    bool isWritten = DocumentFormat::Save(path, snapshot);
+    std::chrono::microseconds latency =
+        ToMicroseconds(Worker::Clock::now() - taken);
+    // Flush waits for the callback as well
+    if (saved) {
+        saved(number, isWritten);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (isWritten) {
+        ++metrics.savesCount;
+        metrics.lastSaveLatency = latency;
+        metrics.maxSaveLatency = std::max(metrics.maxSaveLatency, latency);
+    } else {
+        ++metrics.failuresCount;
+    }
+}
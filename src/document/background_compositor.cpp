@@ -0,0 +1,107 @@
+#include "document/background_compositor.h"
+
+#include <algorithm>
+#include <typeinfo>
+#include <utility>
+
+#include "compositor/compositor.h"
+#include "document/document.h"
+
+namespace {
+
+// compositors of different classes or settings place the same text
+// differently
+bool IsSameLayout(const Compositor& compositor, const Compositor& other) {
+    return typeid(compositor) == typeid(other) &&
+           compositor.GetAlignment() == other.GetAlignment() &&
+           compositor.GetTopIndent() == other.GetTopIndent() &&
+           compositor.GetBottomIndent() == other.GetBottomIndent() &&
+           compositor.GetLeftIndent() == other.GetLeftIndent() &&
+           compositor.GetRightIndent() == other.GetRightIndent() &&
+           compositor.GetLineSpacing() == other.GetLineSpacing();
+}
+
+}  // namespace
+
+BackgroundCompositor::BackgroundCompositor()
+    : worker(
+          [this](Task& task, uint64_t, Worker::Clock::time_point taken) {
+              Publish(task, taken);
+          },
+          false) {}
+
+// the composed document is destroyed here, where its class is complete
+BackgroundCompositor::~BackgroundCompositor() = default;
+
+void BackgroundCompositor::Submit(const Document& document,
+                                  const TextChange& change) {
+    Worker::Clock::time_point start = Worker::Clock::now();
+    Task task = {document.GetSnapshot(), change};
+    std::chrono::microseconds snapshotTime =
+        ToMicroseconds(Worker::Clock::now() - start);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        metrics.lastSnapshotTime = snapshotTime;
+        metrics.maxSnapshotTime =
+            std::max(metrics.maxSnapshotTime, snapshotTime);
+    }
+    // the change of a replaced snapshot hasn't been composed yet
+    worker.Schedule(std::move(task), start, [](Task& replaced, Task& next) {
+        replaced.change.Merge(next.change);
+        next.change = replaced.change;
+    });
+}
+
+void BackgroundCompositor::Flush() { worker.Flush(); }
+
+std::shared_ptr<const LayoutSnapshot> BackgroundCompositor::GetLayout() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return layout;
+}
+
+BackgroundCompositor::Metrics BackgroundCompositor::GetMetrics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Metrics current = metrics;
+    current.skippedCount = worker.GetSkippedCount();
+    return current;
+}
+
+std::shared_ptr<const LayoutSnapshot> BackgroundCompositor::Compose(
+    DocumentSnapshot snapshot, const TextChange& change) {
+    // the settings may be changed on the compositor of the document without
+    // changing the text
+    if (document == nullptr || change.isFull ||
+        !IsSameLayout(*snapshot.compositor, *document->GetCompositor())) {
+        // the composed document gets a compositor of its own, the one of the
+        // snapshot is shared with other snapshots
+        document.reset(new Document(snapshot.compositor->Clone()));
+        document->SetCharacters(std::move(snapshot.text),
+                                snapshot.cursorOffset);
+        document->LoadAll();
+    } else if (!change.IsEmpty()) {
+        document->ReplaceRange(
+            change.offset, change.offset + change.removedLength,
+            snapshot.text.GetText(change.offset, change.insertedLength),
+            snapshot.text.GetRuns(change.offset, change.insertedLength));
+    }
+
+    auto layout = std::make_shared<LayoutSnapshot>(document->UpdateLayout());
+    layout->version = snapshot.version;
+    return layout;
+}
+
+void BackgroundCompositor::Publish(Task& task,
+                                   Worker::Clock::time_point taken) {
+    std::shared_ptr<const LayoutSnapshot> composed =
+        Compose(std::move(task.snapshot), task.change);
+    std::chrono::microseconds latency =
+        ToMicroseconds(Worker::Clock::now() - taken);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    // the previous layout may still be drawn, so it is replaced rather than
+    // changed
+    layout = std::move(composed);
+    ++metrics.composedCount;
+    metrics.lastComposeLatency = latency;
+    metrics.maxComposeLatency = std::max(metrics.maxComposeLatency, latency);
+}
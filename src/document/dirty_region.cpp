@@ -0,0 +1,65 @@
+#include "document/dirty_region.h"
+
+#include <algorithm>
+
+void DirtyRegion::Add(const Glyph* page, const Rect& rect) {
+    if (isAllDirty || rect.IsEmpty()) {
+        return;
+    }
+
+    std::vector<Rect>& rects = pages[page];
+    Rect area = rect;
+    // the joined area may touch areas that didn't touch the added one
+    bool isJoined = true;
+    while (isJoined) {
+        isJoined = false;
+        for (size_t i = 0; i < rects.size(); ++i) {
+            if (rects[i].Touches(area)) {
+                area = area.Union(rects[i]);
+                rects[i] = rects.back();
+                rects.pop_back();
+                isJoined = true;
+                break;
+            }
+        }
+    }
+    rects.push_back(area);
+}
+
+void DirtyRegion::AddAll() {
+    pages.clear();
+    isAllDirty = true;
+}
+
+void DirtyRegion::Remove(const Glyph* page, const Rect& drawn) {
+    auto it = pages.find(page);
+    if (it == pages.end()) {
+        return;
+    }
+    std::vector<Rect>& rects = it->second;
+    rects.erase(std::remove_if(rects.begin(), rects.end(),
+                               [&](const Rect& rect) {
+                                   return drawn.Contains(rect);
+                               }),
+                rects.end());
+    if (rects.empty()) {
+        pages.erase(it);
+    }
+}
+
+void DirtyRegion::RemovePage(const Glyph* page) { pages.erase(page); }
+
+const std::vector<Rect>& DirtyRegion::GetRects(const Glyph* page) const {
+    static const std::vector<Rect> kNoRects;
+    auto it = pages.find(page);
+    return it == pages.end() ? kNoRects : it->second;
+}
+
+bool DirtyRegion::IsAllDirty() const { return isAllDirty; }
+
+bool DirtyRegion::IsEmpty() const { return !isAllDirty && pages.empty(); }
+
+void DirtyRegion::Clear() {
+    pages.clear();
+    isAllDirty = false;
+}
@@ -4,144 +4,651 @@
 #include <boost/archive/text_oarchive.hpp>
 BOOST_CLASS_EXPORT_IMPLEMENT(Document)
 
+#include <algorithm>
 #include <cassert>
+#include <utility>
 
 #include "compositor/compositor.h"
+#include "document/background_compositor.h"
 #include "document/glyphs/character.h"
 #include "document/glyphs/column.h"
 #include "document/glyphs/glyph.h"
 #include "document/glyphs/page.h"
 #include "document/glyphs/row.h"
 
+// characters loaded at once when the document is loaded lazily
+const size_t kLoadChunkSize = 16 * 1024;
+// bytes read at once when plain text is imported
+const size_t kImportChunkSize = 64 * 1024;
+// edits of the text made to the glyphs at once when they are not requested
+const size_t kMaxTextEdits = 1024;
+
+// rows of the document are always glyph containers
+static const GlyphMetrics& GetRowMetrics(const Glyph::GlyphPtr& row) {
+    return static_cast<const GlyphContainer&>(*row).GetMetrics();
+}
+
+static LayoutSnapshot::PageLayoutPtr MakePageLayout(const Page& page) {
+    auto pageLayout = std::make_shared<LayoutSnapshot::PageLayout>();
+    pageLayout->width = page.GetWidth();
+    pageLayout->height = page.GetHeight();
+    for (const auto& column : page.GetChildren()) {
+        for (const auto& row : column->GetChildren()) {
+            const GlyphMetrics& metrics = GetRowMetrics(row);
+            for (size_t i = 0; i < metrics.GetSize(); ++i) {
+                pageLayout->characters.push_back(
+                    {metrics.symbols[i], metrics.GetRect(i)});
+            }
+        }
+    }
+    return pageLayout;
+}
+
+// inserts the symbols into the text with the sizes of the runs
+static void InsertRuns(TextBuffer& text, size_t offset,
+                       const std::string& symbols,
+                       const std::vector<CharacterRun>& runs) {
+    size_t inserted = 0;
+    for (const CharacterRun& run : runs) {
+        text.Insert(offset + inserted, symbols.data() + inserted, run.count,
+                    run.width, run.height);
+        inserted += run.count;
+    }
+    assert(inserted == symbols.size() && "Runs don't match the symbols");
+}
+
 Document::Document(std::shared_ptr<Compositor> compositor) {
-    currentPage = std::make_shared<Page>(0, 0, pageWidth, pageHeight);
+    currentPage = AllocateShared<Page>(glyphPool, 0, 0, pageWidth, pageHeight);
     AddPage(currentPage);
-    // set cursor on the first row on page
-    selectedGlyph = this->GetFirstPage()->GetFirstGlyph()->GetFirstGlyph();
 
     this->compositor = compositor;
     compositor->SetDocument(this);
     compositor->Compose();
-    this->DrawDocument();
+    InvalidateAll();
+}
+
+Document::~Document() {
+    // pages may outlive the document
+    for (const auto& page : pages) {
+        page->SetCharactersCountListener(nullptr);
+    }
 }
 
 void Document::SetCompositor(std::shared_ptr<Compositor> compositor) {
+    SyncGlyphs();
     this->compositor = compositor;
     compositor->SetDocument(this);
     compositor->Compose();
-    this->DrawDocument();
+    isComposePending = false;
+    ++version;
+    InvalidateAll();
+    // the settings of the layout have changed
+    ChangeText({0, 0, 0, true});
+    if (backgroundCompositor != nullptr) {
+        SubmitLayout();
+    }
 }
 
-std::shared_ptr<Compositor> Document::GetCompositor() {
+std::shared_ptr<Compositor> Document::GetCompositor() const {
     return this->compositor;
 }
 
+void Document::SetRenderer(std::shared_ptr<Renderer> renderer) {
+    assert(renderer != nullptr && "Cannot draw document by nullptr");
+    this->renderer = renderer;
+    InvalidateAll();
+}
+
+std::shared_ptr<Renderer> Document::GetRenderer() const { return renderer; }
+
+void Document::SetBackgroundCompositor(
+    std::shared_ptr<BackgroundCompositor> backgroundCompositor) {
+    ComposePending();
+    this->backgroundCompositor = backgroundCompositor;
+    drawnLayout = nullptr;
+    InvalidateAll();
+    if (backgroundCompositor != nullptr) {
+        // the compositor has not seen the text yet
+        ChangeText({0, 0, 0, true});
+        SubmitLayout();
+    }
+}
+
+std::shared_ptr<BackgroundCompositor> Document::GetBackgroundCompositor()
+    const {
+    return backgroundCompositor;
+}
+
+uint64_t Document::GetVersion() const { return version; }
+
+LayoutSnapshot Document::GetLayout() const {
+    LayoutSnapshot layout;
+    layout.version = version;
+    layout.firstRow =
+        pages.front()->GetFirstGlyph()->GetFirstGlyph()->GetRect();
+    for (const auto& page : pages) {
+        layout.pages.push_back(MakePageLayout(*page));
+    }
+    return layout;
+}
+
+LayoutSnapshot Document::UpdateLayout() {
+    ComposePending();
+    LayoutSnapshot layout;
+    layout.version = version;
+    layout.firstRow =
+        pages.front()->GetFirstGlyph()->GetFirstGlyph()->GetRect();
+    // the compositor marks the rows it places, so pages having no marked
+    // areas are placed as they were
+    std::unordered_map<const Glyph*, LayoutSnapshot::PageLayoutPtr> layouts;
+    for (const auto& page : pages) {
+        auto cached = pageLayouts.find(page.get());
+        LayoutSnapshot::PageLayoutPtr pageLayout;
+        if (cached != pageLayouts.end() && !dirtyRegion.IsAllDirty() &&
+            dirtyRegion.GetRects(page.get()).empty()) {
+            pageLayout = cached->second;
+        } else {
+            pageLayout = MakePageLayout(*page);
+        }
+        layouts.emplace(page.get(), pageLayout);
+        layout.pages.push_back(std::move(pageLayout));
+    }
+    pageLayouts = std::move(layouts);
+    dirtyRegion.Clear();
+    return layout;
+}
+
+bool Document::IsRedrawNeeded() const {
+    return !dirtyRegion.IsEmpty() ||
+           (backgroundCompositor != nullptr &&
+            backgroundCompositor->GetLayout() != drawnLayout);
+}
+
 void Document::MoveCursorLeft() {
-    Glyph::GlyphPtr leftGlyph = GetPreviousCharInDocument(selectedGlyph);
-    // if cursor is in the beginning then don't move cursor
-    if (leftGlyph == nullptr) {
-        // set cursor in the first row of document
-        selectedGlyph = this->GetFirstPage()->GetFirstGlyph()->GetFirstGlyph();
-    } else {
-        selectedGlyph = leftGlyph;
+    InvalidateCursor();
+    if (cursor.offset > 0) {
+        --cursor.offset;
     }
+    cursor.affinity = Cursor::UPSTREAM;
+    InvalidateCursor();
 }
 
 void Document::MoveCursorRight() {
-    // if row is selected then set cursor after first char in it
-    Row::RowPtr selectedRow = std::dynamic_pointer_cast<Row>(selectedGlyph);
-    if (selectedRow != nullptr) {
-        if (selectedRow->GetFirstGlyph() != nullptr) {
-            selectedGlyph = selectedRow->GetFirstGlyph();
-        }
-    } else {
-        Glyph::GlyphPtr rightGlyph = GetNextCharInDocument(selectedGlyph);
-        // if cursor is in the end then don't move cursor
-        if (rightGlyph != nullptr) {
-            selectedGlyph = rightGlyph;
-        }
+    InvalidateCursor();
+    // characters after the loaded ones get glyphs when the cursor is found
+    if (cursor.offset < text.GetLength()) {
+        ++cursor.offset;
     }
+    cursor.affinity = Cursor::UPSTREAM;
+    InvalidateCursor();
 }
 
-Glyph::GlyphPtr Document::GetSelectedGlyph() { return selectedGlyph; }
+Glyph::GlyphPtr Document::GetSelectedGlyph() {
+    SyncGlyphs();
+    if (cursor.offset == 0) {
+        return GetFirstPage()->GetFirstGlyph()->GetFirstGlyph();
+    }
+    return GetCharacterAt(cursor.offset - 1);
+}
 
-Point Document::GetCursorPosition() {
-    // check if selectedGlyph is a row or a character
-
-    Row::RowPtr selectedRow = std::dynamic_pointer_cast<Row>(selectedGlyph);
-    Point cursorPoint;
-    if (selectedRow != nullptr) {
-        // set cursor in the beginning of this row
-        cursorPoint =
-            Point(selectedRow->GetPosition().x, selectedRow->GetPosition().y);
+Document::CursorGlyph Document::FindCursorGlyph() {
+    CursorGlyph cursorGlyph;
+    if (cursor.affinity == Cursor::DOWNSTREAM &&
+        cursor.offset < text.GetLength()) {
+        cursorGlyph.glyph = GetCharacterAt(cursor.offset);
+        cursorGlyph.isBefore = true;
     } else {
-        Character::CharPtr selectedChar =
-            std::dynamic_pointer_cast<Character>(selectedGlyph);
-        assert(selectedChar != nullptr && "Selected glyph has invalid type");
-        cursorPoint =
-            Point(selectedChar->GetPosition().x + selectedChar->GetWidth(),
-                  selectedChar->GetPosition().y);
+        // the cursor is in the beginning of the first row if there are no
+        // characters before it
+        cursorGlyph.glyph = GetSelectedGlyph();
+        cursorGlyph.isBefore = cursor.offset == 0;
+    }
+    return cursorGlyph;
+}
+
+Point Document::GetCursorPosition() {
+    CursorGlyph cursorGlyph = FindCursorGlyph();
+    Point cursorPoint = cursorGlyph.glyph->GetPosition();
+    if (!cursorGlyph.isBefore) {
+        cursorPoint.x += cursorGlyph.glyph->GetWidth();
     }
     return cursorPoint;
 }
 
 void Document::InsertChar(char symbol) {
+    if (backgroundCompositor != nullptr) {
+        ReplaceRange(cursor.offset, cursor.offset, std::string(1, symbol),
+                     {{1, currentCharSize, currentCharSize}});
+        return;
+    }
     Point cursorPoint = GetCursorPosition();
-    Character newChar = Character(cursorPoint.x, cursorPoint.y + 1,
-                                  currentCharSize, currentCharSize, symbol);
-    Glyph::GlyphPtr ptr = std::make_shared<Character>(newChar);
+    Glyph::GlyphPtr ptr = characterFactory.CreateCharacter(
+        cursorPoint.x, cursorPoint.y + 1, symbol, currentCharSize);
 
-    this->Insert(ptr);
+    // the character is put after the one before the cursor rather than found
+    // by position, so it gets the offset of the cursor whatever row the
+    // cursor keeps to
+    InsertAfter(ptr, GetSelectedGlyph());
 }
 
 void Document::Insert(Glyph::GlyphPtr& glyph) {
+    ComposePending();
+    // the cursor leaves its place
+    InvalidateCursor();
     currentPage->Insert(glyph);
+    CompleteInsert(glyph);
+}
 
-    selectedGlyph = glyph;
-    compositor->Compose();
-    this->DrawDocument();
+void Document::InsertAfter(Glyph::GlyphPtr& glyph,
+                           const Glyph::GlyphPtr& previous) {
+    InvalidateCursor();
+    Row* row = previous->As<Row>();
+    if (row != nullptr) {
+        row->InsertAfter(glyph, nullptr);
+    } else {
+        row = previous->GetParent()->As<Row>();
+        row->InsertAfter(glyph, previous);
+    }
+    CompleteInsert(glyph);
 }
 
-char Document::RemoveChar() {
-    char removed_char;
-    if(auto c = std::dynamic_pointer_cast<Character>(selectedGlyph))
-        removed_char = c->GetChar();
+void Document::CompleteInsert(const Glyph::GlyphPtr& glyph) {
+    size_t offset;
+    if (AddToText(glyph, offset)) {
+        cursor.offset = offset + 1;
+        cursor.affinity = Cursor::UPSTREAM;
+    }
 
-    this->Remove(selectedGlyph);
+    ComposeEdit(glyph, glyph->GetParent());
+    InvalidateCursor();
+}
 
-    return removed_char;
+void Document::InsertText(const std::string& symbols) {
+    if (symbols.empty()) {
+        return;
+    }
+    ReplaceRange(cursor.offset, cursor.offset, symbols,
+                 {{symbols.size(), currentCharSize, currentCharSize}});
 }
 
-void Document::Remove(Glyph::GlyphPtr& glyph) {
-    assert(glyph != nullptr && "Cannot remove glyph by nullptr");
+std::string Document::RemoveRange(size_t begin, size_t end) {
+    assert(begin <= end && end <= text.GetLength() && "Invalid range in text");
+    std::string removed = text.GetText(begin, end - begin);
+    if (removed.empty()) {
+        return removed;
+    }
+    ReplaceRange(begin, end, std::string(), {});
+    return removed;
+}
 
-    Glyph::GlyphPtr newSelectedGlyph;
-    if (glyph == selectedGlyph) {
-        newSelectedGlyph = GetPreviousCharInDocument(selectedGlyph);
-        if (newSelectedGlyph == nullptr) {
-            // if there is no character in document, set cursor into the first
-            // row
-            newSelectedGlyph =
-                this->GetFirstPage()->GetFirstGlyph()->GetFirstGlyph();
+void Document::ReplaceRange(size_t begin, size_t end,
+                            const std::string& symbols,
+                            const std::vector<CharacterRun>& runs) {
+    assert(begin <= end && end <= text.GetLength() && "Invalid range in text");
+    // the cursor leaves its place
+    InvalidateCursor();
+    bool isTextEdit = backgroundCompositor != nullptr && !isReplayingEdits;
+    if (isTextEdit) {
+        EditText(begin, end, symbols, runs);
+    } else {
+        RemoveCharacters(begin, end);
+        InsertCharacters(begin, symbols, runs);
+    }
+    cursor.offset = begin + symbols.size();
+    cursor.affinity = Cursor::UPSTREAM;
+    InvalidateCursor();
+    // the text is submitted with the cursor after the edit
+    if (isTextEdit && batchDepth == 0) {
+        SubmitLayout();
+    }
+}
+
+void Document::RemoveCharacters(size_t begin, size_t end) {
+    if (begin == end) {
+        return;
+    }
+    // characters after the loaded ones are removed only from the text
+    size_t loadedEnd = std::min(end, loadedLength);
+    Glyph::GlyphPtr first;
+    const Glyph* firstRow = nullptr;
+    if (begin < loadedEnd) {
+        first = GetCharacterAt(begin);
+        firstRow = first->GetParent();
+    }
+    size_t count = begin < loadedEnd ? loadedEnd - begin : 0;
+    size_t removedGlyphs = count;
+    while (count > 0) {
+        // characters following each other in a row are removed together, the
+        // next ones take their offset
+        Glyph::GlyphPtr firstInRow = GetCharacterAt(begin);
+        Glyph* parent = firstInRow->GetParent();
+        Row* row = parent->As<Row>();
+        assert(row != nullptr && "Character is not placed in a row");
+        Glyph::GlyphPtr lastInRow;
+        size_t index = row->GetGlyphIndex(firstInRow);
+        for (Glyph::GlyphPtr glyph = firstInRow;
+             count > 0 && glyph != nullptr &&
+             glyph->GetKind() == Glyph::CHARACTER;
+             glyph = row->GetGlyphByIndex(++index)) {
+            lastInRow = glyph;
+            --count;
         }
+        Invalidate(parent);
+        row->Remove(firstInRow, lastInRow);
     }
+    text.Remove(begin, end - begin);
+    loadedLength -= removedGlyphs;
+    ChangeText({begin, end - begin, 0});
+
+    if (first != nullptr) {
+        ComposeEdit(first, firstRow);
+    } else if (!isReplayingEdits) {
+        ++version;
+    }
+}
+
+void Document::InsertCharacters(size_t offset, const std::string& symbols,
+                                const std::vector<CharacterRun>& runs) {
+    if (symbols.empty()) {
+        return;
+    }
+    // characters after the loaded ones get glyphs when they are loaded
+    if (offset >= loadedLength && loadedLength < text.GetLength()) {
+        InsertRuns(text, offset, symbols, runs);
+        ChangeText({offset, 0, symbols.size()});
+        if (!isReplayingEdits) {
+            ++version;
+        }
+        return;
+    }
+
+    Glyph::GlyphPtr previous =
+        offset == 0 ? GetFirstPage()->GetFirstGlyph()->GetFirstGlyph()
+                    : GetCharacterAt(offset - 1);
+    Row* row = previous->As<Row>();
+    if (row != nullptr) {
+        previous = nullptr;
+    } else {
+        row = previous->GetParent()->As<Row>();
+    }
+    Glyph::GlyphVector characters =
+        CreateCharacters(symbols, runs, row->GetPosition());
+    row->InsertAfter(characters, previous);
+    InsertRuns(text, offset, symbols, runs);
+    loadedLength += symbols.size();
+    ChangeText({offset, 0, symbols.size()});
+    ComposeEdit(characters.front(), row);
+}
+
+Glyph::GlyphVector Document::CreateCharacters(const std::string& symbols,
+                                              std::vector<CharacterRun> runs,
+                                              const Point& position) {
+    Glyph::GlyphVector characters;
+    characters.reserve(symbols.size());
+    auto run = runs.begin();
+    for (char symbol : symbols) {
+        while (run->count == 0) {
+            ++run;
+        }
+        --run->count;
+
+        characters.push_back(characterFactory.CreateCharacter(
+            position.x, position.y, run->width, run->height, symbol));
+    }
+    return characters;
+}
+
+void Document::EditText(size_t begin, size_t end, const std::string& symbols,
+                        const std::vector<CharacterRun>& runs) {
+    if (textEdits.empty()) {
+        // the glyphs stay made for the text before the first edit
+        glyphsText = text;
+    }
+    textEdits.push_back({begin, end - begin, symbols, runs});
+    text.Remove(begin, end - begin);
+    InsertRuns(text, begin, symbols, runs);
+    ChangeText({begin, end - begin, symbols.size()});
+    ++version;
+    // the edits are made to the glyphs from time to time, so requesting them
+    // never takes long
+    if (textEdits.size() >= kMaxTextEdits) {
+        SyncGlyphs();
+    }
+}
+
+void Document::SyncGlyphs() {
+    if (textEdits.empty()) {
+        return;
+    }
+    std::vector<TextEdit> edits = std::move(textEdits);
+    textEdits.clear();
+    // the edits are made again to the text the glyphs are made for, so the
+    // text comes out the same
+    TextBuffer edited = std::move(text);
+    text = std::move(glyphsText);
+    glyphsText.Clear();
+    Cursor editedCursor = cursor;
+    isReplayingEdits = true;
+    for (const TextEdit& edit : edits) {
+        ReplaceRange(edit.offset, edit.offset + edit.removedLength,
+                     edit.symbols, edit.runs);
+    }
+    isReplayingEdits = false;
+    assert(text.GetLength() == edited.GetLength() &&
+           "Glyphs don't match the text");
+    text = std::move(edited);
+    cursor = editedCursor;
+}
+
+void Document::ChangeText(const TextChange& change) {
+    // the edits made to the glyphs later have been submitted already
+    if (backgroundCompositor != nullptr && !isReplayingEdits) {
+        submittedChange.Merge(change);
+    }
+}
+
+void Document::SubmitLayout() {
+    backgroundCompositor->Submit(*this, submittedChange);
+    submittedChange = TextChange();
+}
+
+Page::PagePtr Document::GetPage(const Glyph* glyph) const {
+    while (glyph != nullptr && glyph->GetParent() != nullptr) {
+        glyph = glyph->GetParent();
+    }
+    for (const auto& page : pages) {
+        if (page.get() == glyph) {
+            return page;
+        }
+    }
+    return currentPage;
+}
+
+Glyph::GlyphPtr Document::GetCharacterAt(size_t offset) {
+    SyncGlyphs();
+    assert(offset < text.GetLength() && "Invalid offset in text");
+    while (loadedLength <= offset) {
+        LoadCharacters(kLoadChunkSize);
+    }
+    size_t index = offset;
+    size_t page = GetPagesIndex().Find(index);
+    assert(page < indexedPages.size() && "Character is not placed on pages");
+    return indexedPages[page]->GetCharacter(index);
+}
+
+bool Document::FindCharacterOffset(const Glyph& glyph, size_t& offset) {
+    if (glyph.GetKind() != Glyph::CHARACTER) {
+        return false;
+    }
+    const GlyphContainer* page;
+    size_t before = GlyphContainer::CountCharactersBefore(glyph, page);
+    const FenwickTree& index = GetPagesIndex();
+    auto pageIndex = pageIndices.find(page);
+    if (pageIndex == pageIndices.end()) {
+        return false;
+    }
+    offset = index.GetPrefixSum(pageIndex->second) + before;
+    return true;
+}
+
+const FenwickTree& Document::GetPagesIndex() {
+    if (!isPagesIndexValid) {
+        indexedPages.clear();
+        pageIndices.clear();
+        std::vector<size_t> counts;
+        counts.reserve(pages.size());
+        for (const auto& page : pages) {
+            page->SetCharactersCountListener(this);
+            pageIndices[page.get()] = indexedPages.size();
+            indexedPages.push_back(page.get());
+            counts.push_back(page->GetCharactersCount());
+        }
+        pagesIndex.Assign(counts);
+        isPagesIndexValid = true;
+    }
+    return pagesIndex;
+}
+
+void Document::OnCharactersCountChanged(const GlyphContainer& container,
+                                        ptrdiff_t delta) {
+    if (!isPagesIndexValid) {
+        return;
+    }
+    auto pageIndex = pageIndices.find(&container);
+    if (pageIndex != pageIndices.end()) {
+        pagesIndex.Add(pageIndex->second, delta);
+    }
+}
+
+void Document::ComposeEdit(const Glyph::GlyphPtr& glyph, const Glyph* row) {
+    // the replayed edits have been counted when they were made to the text
+    if (!isReplayingEdits) {
+        ++version;
+    }
+    if (batchDepth == 0) {
+        if (backgroundCompositor != nullptr) {
+            isComposePending = true;
+            if (!isReplayingEdits) {
+                SubmitLayout();
+            }
+        } else {
+            compositor->Compose(GetPage(row), glyph);
+        }
+        return;
+    }
+    if (batchGlyph == nullptr) {
+        batchGlyph = glyph;
+        batchRow = row;
+        batchPage = GetPage(row);
+    } else if (row != batchRow) {
+        isBatchInRow = false;
+    }
+}
+
+void Document::BeginBatch() { ++batchDepth; }
+
+void Document::EndBatch() {
+    assert(batchDepth > 0 && "No batch to end");
+    if (--batchDepth > 0) {
+        return;
+    }
+    if (batchGlyph == nullptr) {
+        // edits of the text alone are submitted when the batch ends
+        if (backgroundCompositor != nullptr && !submittedChange.IsEmpty()) {
+            SubmitLayout();
+        }
+        return;
+    }
+    Glyph::GlyphPtr glyph = std::move(batchGlyph);
+    Page::PagePtr page = std::move(batchPage);
+    batchGlyph = nullptr;
+    batchPage = nullptr;
+    batchRow = nullptr;
+    if (backgroundCompositor != nullptr) {
+        isComposePending = true;
+        SubmitLayout();
+    } else if (isBatchInRow) {
+        compositor->Compose(page, glyph);
+    } else {
+        compositor->Compose();
+    }
+    isBatchInRow = true;
+}
+
+void Document::ComposePending() {
+    SyncGlyphs();
+    if (isComposePending) {
+        isComposePending = false;
+        compositor->Compose();
+    }
+}
+
+char Document::RemoveChar() {
+    // nothing is before the cursor in the beginning of the document
+    if (cursor.offset == 0) {
+        return '\0';
+    }
+    if (backgroundCompositor != nullptr) {
+        // the character is found in the text rather than among the glyphs
+        char symbol = text.GetChar(cursor.offset - 1);
+        Cursor::Affinity affinity = cursor.affinity;
+        ReplaceRange(cursor.offset - 1, cursor.offset, std::string(), {});
+        cursor.affinity = affinity;
+        return symbol;
+    }
+    Glyph::GlyphPtr glyph = GetCharacterAt(cursor.offset - 1);
+    char symbol = glyph->As<Character>()->GetChar();
+    this->Remove(glyph);
+    return symbol;
+}
+
+void Document::Remove(Glyph::GlyphPtr& glyph) {
+    assert(glyph != nullptr && "Cannot remove glyph by nullptr");
+    SyncGlyphs();
 
     auto it = std::find(pages.begin(), pages.end(), glyph);
     if (it != pages.end()) {
-        if (it != pages.begin()) pages.erase(it);
+        if (it != pages.begin()) {
+            dirtyRegion.RemovePage(glyph.get());
+            (*it)->SetCharactersCountListener(nullptr);
+            pages.erase(it);
+            isPagesIndexValid = false;
+        }
         return;
     }
 
     // what if this glyph is not from current page ???? glyph won't be found and
     // assertion will failed
     assert(glyph != nullptr && "Cannot remove glyph by nullptr");
-    currentPage->Remove(glyph);
-
-    if (glyph == selectedGlyph) {
-        selectedGlyph = newSelectedGlyph;
+    InvalidateCursor();
+    Invalidate(glyph);
+    // the offset is counted while the character is still placed
+    size_t offset;
+    bool isText = FindCharacterOffset(*glyph, offset);
+    // rows are not composed in a batch and may be wider than the page, so
+    // the glyph is removed from its parent rather than found by position
+    const Glyph* row = glyph->GetParent();
+    Glyph* parent = glyph->GetParent();
+    if (parent != nullptr && parent->IsContainer()) {
+        parent->Remove(glyph);
+    } else {
+        currentPage->Remove(glyph);
     }
-    compositor->Compose();
-    this->DrawDocument();
+    // the cursor is moved by the offset of the removed character
+    if (isText) {
+        RemoveFromText(offset);
+    }
+
+    ComposeEdit(glyph, row);
+    InvalidateCursor();
+}
+
+const GlyphContainer::GlyphList& Document::GetSelectedGlyphs() const {
+    return selectedGlyphs;
+}
+
+void Document::SetSelectedGlyphs(GlyphContainer::GlyphList glyphs) {
+    selectedGlyphs = std::move(glyphs);
 }
 
 void Document::SetCurrentPage(Page::PagePtr page) { currentPage = page; }
@@ -156,6 +663,7 @@ size_t Document::GetPageHeight() const { return pageHeight; }
 
 void Document::AddPage(const Page::PagePtr& page) {
     pages.push_back(page);
+    isPagesIndexValid = false;
     // if (compositor) {
     // compositor->Compose();  // page can be non-formated
     // }
@@ -177,7 +685,21 @@ Page::PagePtr Document::GetNextPage(const Page::PagePtr& pagePtr) {
     return std::static_pointer_cast<Page>(*nextPage);
 }
 
+Page::PagePtr Document::GetPreviousPage(const Page::PagePtr& pagePtr) {
+    auto currentPage =
+        std::find_if(pages.begin(), pages.end(),
+                     [&](const auto& elem) { return elem == pagePtr; });
+
+    assert(currentPage != pages.end());
+
+    if (currentPage == pages.begin()) {
+        return nullptr;
+    }
+    return std::static_pointer_cast<Page>(*std::prev(currentPage));
+}
+
 void Document::SelectGlyphs(const Point& start, const Point& end) {
+    ComposePending();
     Glyph::GlyphPtr area = std::make_shared<Column>(
         Column(start.x, start.y,
                (end.x > start.x ? end.x - start.x - 1 : end.x - start.x),
@@ -200,16 +722,24 @@ Glyph::GlyphList Document::PasteGlyphs(const Point& to_point) {
     int currentY = to_point.y;
     Glyph::GlyphPtr glyph;
     Glyph::GlyphList copiesList;
+    // the pasted glyphs are composed at once
+    BeginBatch();
     for (auto& glyph : selectedGlyphs) {
         Glyph::GlyphPtr copy = glyph->Clone();
         copy->SetPosition(Point(currentX, currentY));  // set new position
-        this->Insert(copy);
+        if (!copiesList.empty()) {
+            // positions are not composed in a batch
+            InsertAfter(copy, copiesList.back());
+        } else {
+            this->Insert(copy);
+        }
         copiesList.push_back(copy);
         currentX = copy->GetPosition().x +
                    copy->GetWidth();  // insert next glyph after this
         currentY =
             copy->GetPosition().y + 1;  // insert next glyph to the same row
     }
+    EndBatch();
     // selected glyphs is not removed from selectedGlyphs, they can be pasted or
     // cut one more time
     return copiesList;
@@ -217,99 +747,375 @@ Glyph::GlyphList Document::PasteGlyphs(const Point& to_point) {
 
 void Document::CutGlyphs(const Point& start, const Point& end) {
     SelectGlyphs(start, end);
+    BeginBatch();
     for (auto& glyph : selectedGlyphs) {
         this->Remove(glyph);
     }
+    EndBatch();
+}
+
+bool Document::AddToText(const Glyph::GlyphPtr& glyph, size_t& offset) {
+    // the offset is counted by the characters placed before it
+    if (!FindCharacterOffset(*glyph, offset)) {
+        return false;
+    }
+    Character* character = glyph->As<Character>();
+    char symbol = character->GetChar();
+    text.Insert(offset, &symbol, 1, character->GetWidth(),
+                character->GetHeight());
+    ++loadedLength;
+    ChangeText({offset, 0, 1});
+    return true;
 }
 
-GlyphContainer::GlyphList Document::GetCharactersList() {
-    Glyph::GlyphList charactersList;
+void Document::RemoveFromText(size_t offset) {
+    text.Remove(offset, 1);
+    --loadedLength;
+    ChangeText({offset, 1, 0});
+    if (offset < cursor.offset) {
+        --cursor.offset;
+    }
+}
 
-    for (Page::PagePtr page = this->GetFirstPage(); page != nullptr;
-         page = this->GetNextPage(page)) {
-        for (Glyph::GlyphPtr column = page->GetFirstGlyph(); column != nullptr;
-             column = page->GetNextGlyph(column)) {
-            for (Glyph::GlyphPtr row = column->GetFirstGlyph(); row != nullptr;
-                 row = column->GetNextGlyph(row)) {
-                for (Glyph::GlyphPtr character = row->GetFirstGlyph();
-                     character != nullptr;
-                     character = row->GetNextGlyph(character)) {
-                    charactersList.push_back(character);
-                }
-            }
+void Document::IndexCharacters() {
+    isPagesIndexValid = false;
+    textEdits.clear();
+    glyphsText.Clear();
+    std::string symbols;
+    std::vector<CharacterRun> runs;
+    for (const auto& glyph : GetCharacters()) {
+        Character* character = glyph->As<Character>();
+        if (character == nullptr) {
+            continue;
         }
+        symbols.push_back(character->GetChar());
+        if (runs.empty() || runs.back().width != character->GetWidth() ||
+            runs.back().height != character->GetHeight()) {
+            runs.push_back(
+                {0, character->GetWidth(), character->GetHeight()});
+        }
+        ++runs.back().count;
     }
+    text = TextBuffer(std::move(symbols));
+    text.SetSizes(runs);
+    cursor.offset = std::min(cursor.offset, text.GetLength());
+    loadedLength = text.GetLength();
+    ChangeText({0, 0, 0, true});
+}
 
-    return charactersList;
+const Document::PageList& Document::GetPages() const { return pages; }
+
+DocumentRange Document::GetRows() const {
+    return DocumentRange(
+        DocumentWalker(pages.begin(), pages.end(), DocumentWalker::ROWS),
+        DocumentWalker(pages.end(), pages.end(), DocumentWalker::ROWS));
 }
 
-Glyph::GlyphPtr Document::GetNextCharInDocument(Glyph::GlyphPtr& glyph) {
-    Glyph::GlyphList charactersList = GetCharactersList();
-    auto it = std::find(charactersList.begin(), charactersList.end(), glyph);
+DocumentRange Document::GetCharacters() const {
+    return DocumentRange(
+        DocumentWalker(pages.begin(), pages.end(), DocumentWalker::CHARACTERS),
+        DocumentWalker(pages.end(), pages.end(), DocumentWalker::CHARACTERS));
+}
 
-    it++;
-    if (it == charactersList.end()) {
-        return nullptr;
-    } else {
-        return *it;
+const TextBuffer& Document::GetText() const { return text; }
+
+size_t Document::GetCursorOffset() const { return cursor.offset; }
+
+void Document::SetCursorOffset(size_t offset) {
+    Cursor cursor;
+    cursor.offset = offset;
+    SetCursor(cursor);
+}
+
+Cursor Document::GetCursor() const { return cursor; }
+
+void Document::SetCursor(const Cursor& cursor) {
+    assert(cursor.offset <= text.GetLength() && "Invalid cursor offset");
+    InvalidateCursor();
+    this->cursor = cursor;
+    InvalidateCursor();
+}
+
+std::vector<CharacterRun> Document::GetCharacterRuns() const {
+    // the sizes are kept with the pieces of the text, so the glyphs are not
+    // walked
+    return text.GetRuns();
+}
+
+DocumentSnapshot Document::GetSnapshot() const {
+    DocumentSnapshot snapshot;
+    snapshot.text = text;
+    snapshot.cursorOffset = cursor.offset;
+    snapshot.version = version;
+    snapshot.compositor = compositor->Clone();
+    return snapshot;
+}
+
+void Document::SetCharacters(TextBuffer text,
+                             const std::vector<CharacterRun>& runs,
+                             size_t cursorOffset, size_t pagesCount) {
+    text.SetSizes(runs);
+    SetCharacters(std::move(text), cursorOffset, pagesCount);
+}
+
+void Document::SetCharacters(TextBuffer text, size_t cursorOffset,
+                             size_t pagesCount) {
+    assert(cursorOffset <= text.GetLength() && "Invalid cursor offset");
+    for (const auto& page : pages) {
+        page->SetCharactersCountListener(nullptr);
+    }
+    pages.clear();
+    currentPage = AllocateShared<Page>(glyphPool, 0, 0, pageWidth, pageHeight);
+    AddPage(currentPage);
+    // edits of the previous text are not made to the new glyphs
+    textEdits.clear();
+    glyphsText.Clear();
+    this->text = std::move(text);
+    cursor = Cursor();
+    loadedLength = 0;
+    compositor->Compose();
+    isComposePending = false;
+    ++version;
+
+    LoadPages(pagesCount);
+    // the characters around the cursor are loaded at once
+    while (loadedLength < cursorOffset) {
+        LoadCharacters(kLoadChunkSize);
+    }
+    cursor.offset = cursorOffset;
+    InvalidateAll();
+    ChangeText({0, 0, 0, true});
+    if (backgroundCompositor != nullptr) {
+        SubmitLayout();
     }
 }
 
-Glyph::GlyphPtr Document::GetPreviousCharInDocument(Glyph::GlyphPtr& glyph) {
-    Glyph::GlyphList charactersList = GetCharactersList();
-    auto it = std::find(charactersList.begin(), charactersList.end(), glyph);
+bool Document::ImportText(std::istream& is, size_t pagesCount) {
+    std::string imported;
+    std::vector<char> chunk(kImportChunkSize);
+    while (is.read(chunk.data(), chunk.size()) || is.gcount() > 0) {
+        imported.append(chunk.data(), is.gcount());
+    }
+    if (is.bad()) {
+        return false;
+    }
 
-    if (it == charactersList.begin()) {
-        return nullptr;
-    } else {
-        it--;
-        return *it;
+    // the whole text becomes the original piece of the buffer
+    std::vector<CharacterRun> runs;
+    if (!imported.empty()) {
+        runs.push_back({imported.size(), currentCharSize, currentCharSize});
+    }
+    SetCharacters(TextBuffer(std::move(imported)), runs, 0, pagesCount);
+    return true;
+}
+
+bool Document::ExportText(std::ostream& os) const { return text.Write(os); }
+
+bool Document::IsLoaded() const {
+    return textEdits.empty() && loadedLength == text.GetLength();
+}
+
+void Document::LoadPages(size_t count) {
+    // the last page is complete only when the next one is started
+    while (pages.size() <= count && LoadCharacters(kLoadChunkSize)) {
     }
 }
 
+void Document::LoadAll() {
+    while (LoadCharacters(kLoadChunkSize)) {
+    }
+}
+
+bool Document::LoadCharacters(size_t count) {
+    // the loaded characters are composed after the last row
+    ComposePending();
+    size_t length = std::min(count, text.GetLength() - loadedLength);
+    if (length == 0) {
+        return false;
+    }
+
+    Page::PagePtr page = pages.back();
+    Glyph::GlyphPtr row = page->GetLastGlyph()->GetLastGlyph();
+    // characters are put at the beginning of the last row, so the compositor
+    // finds the row and places them after the characters it has
+    Glyph::GlyphVector characters =
+        CreateCharacters(text.GetText(loadedLength, length),
+                         text.GetRuns(loadedLength, length),
+                         row->GetPosition());
+    for (const auto& character : characters) {
+        row->Add(character);
+    }
+    loadedLength += length;
+
+    compositor->Compose(page, characters.front());
+    return true;
+}
+
+const std::shared_ptr<MemoryPool>& Document::GetGlyphPool() const {
+    return glyphPool;
+}
+
 void Document::DrawDocument() {
-    std::cout << "-----DrawDocument()" << std::endl;
-    // window->Clear();
-    for (Page::PagePtr page = this->GetFirstPage(); page != nullptr;
-         page = this->GetNextPage(page)) {
-        std::cout << "DrawPage(): " << pageWidth << " " << pageHeight
-                  << std::endl;
-        // window->DrawPage(pageWidth, pageHeight);
-        for (Glyph::GlyphPtr column = page->GetFirstGlyph(); column != nullptr;
-             column = page->GetNextGlyph(column)) {
-            for (Glyph::GlyphPtr row = column->GetFirstGlyph(); row != nullptr;
-                 row = column->GetNextGlyph(row)) {
-                // draw cursor in the brginning of selected row
-                if (row == selectedGlyph) {
-                    std::cout << "DrawCursor(): " << row->GetPosition().x << " "
-                              << row->GetPosition().y << " " << row->GetHeight()
-                              << std::endl;
-                    // window->DrawCursor(row->GetPosition().x,
-                    // row->GetPosition().y, row->GetHeight());
-                }
-                for (Glyph::GlyphPtr character = row->GetFirstGlyph();
-                     character != nullptr;
-                     character = row->GetNextGlyph(character)) {
-                    Character::CharPtr charPtr =
-                        std::dynamic_pointer_cast<Character>(character);
-                    std::cout << "DrawChar(): " << *charPtr;
-                    // window->DrawChar(charPtr->GetChar(),
-                    // charPtr->GetPosition().x, charPtr->GetPosition().y,
-                    // charPtr->GetHeight())
-
-                    // draw cursor after selected character
-                    if (character == selectedGlyph) {
-                        std::cout << "DrawCursor(): "
-                                  << character->GetPosition().x +
-                                         character->GetWidth()
-                                  << " " << character->GetPosition().y << " "
-                                  << character->GetHeight() << std::endl;
-                        // window->DrawCursor(character->GetPosition().x +
-                        // character->GetWidth(), row->GetPosition().y,
-                        // row->GetHeight());
-                    }
-                }
+    if (backgroundCompositor != nullptr) {
+        // the document is drawn only when its first layout is composed
+        drawnLayout = backgroundCompositor->GetLayout();
+        if (drawnLayout != nullptr) {
+            drawnLayout->Draw(*renderer, cursor);
+            dirtyRegion.Clear();
+        }
+        return;
+    }
+    // pages that are not loaded yet are drawn by Redraw when they are shown
+    CursorGlyph cursorGlyph = FindCursorGlyph();
+    renderer->Clear();
+    for (const auto& page : pages) {
+        renderer->DrawPage(pageWidth, pageHeight);
+        for (const auto& column : page->GetChildren()) {
+            for (const auto& row : column->GetChildren()) {
+                DrawRow(row, cursorGlyph);
+            }
+        }
+    }
+    renderer->Present();
+    dirtyRegion.Clear();
+}
+
+void Document::Redraw(const Rect& viewport) {
+    if (backgroundCompositor != nullptr) {
+        if (IsRedrawNeeded()) {
+            DrawDocument();
+        }
+        return;
+    }
+    if (viewport.GetBottomBorder() > 0) {
+        LoadPages((viewport.GetBottomBorder() - 1) / pageHeight + 1);
+    }
+    if (dirtyRegion.IsEmpty()) {
+        return;
+    }
+    CursorGlyph cursorGlyph = FindCursorGlyph();
+    if (dirtyRegion.IsAllDirty()) {
+        // pages out of the viewport have to be drawn when they are shown
+        dirtyRegion.Clear();
+        for (const auto& page : pages) {
+            dirtyRegion.Add(page.get(), page->GetRect());
+        }
+    }
+
+    renderer->BeginUpdate(pages.size());
+    size_t index = 0;
+    for (const auto& page : pages) {
+        int top = int(index) * pageHeight;
+        if (top >= viewport.GetBottomBorder()) {
+            break;
+        }
+        Rect visible =
+            viewport.Intersection(Rect(0, top, pageWidth, pageHeight));
+        if (!visible.IsEmpty()) {
+            visible.y -= top;
+            RedrawPage(page, index, visible, cursorGlyph);
+        }
+        ++index;
+    }
+    renderer->Present();
+}
+
+void Document::Invalidate(const Glyph::GlyphPtr& glyph) {
+    Invalidate(glyph.get());
+}
+
+void Document::Invalidate(const Glyph* glyph) {
+    if (glyph == nullptr || dirtyRegion.IsAllDirty()) {
+        return;
+    }
+    // coordinates of glyphs are relative to the page they are placed on
+    const Glyph* page = glyph;
+    while (page->GetParent() != nullptr) {
+        page = page->GetParent();
+    }
+    // glyphs removed from the document are not drawn
+    if (page->As<Page>() != nullptr) {
+        dirtyRegion.Add(page, glyph->GetRect());
+    }
+}
+
+void Document::InvalidateCursor() {
+    // the layout composed in the background is drawn whole, so the glyphs
+    // are not needed
+    if (backgroundCompositor != nullptr) {
+        InvalidateAll();
+        return;
+    }
+    // the cursor is not looked for if everything is drawn anyway
+    if (!dirtyRegion.IsAllDirty()) {
+        Invalidate(FindCursorGlyph().glyph);
+    }
+}
+
+void Document::InvalidateAll() { dirtyRegion.AddAll(); }
+
+void Document::DrawRow(const Glyph::GlyphPtr& row,
+                       const CursorGlyph& cursorGlyph) {
+    // draw cursor in the beginning of selected row
+    if (row == cursorGlyph.glyph) {
+        renderer->DrawCursor(row->GetPosition().x, row->GetPosition().y,
+                             row->GetHeight());
+    }
+    // characters are drawn from the metrics of the row, so the glyphs
+    // themselves are not visited
+    const GlyphMetrics& metrics = GetRowMetrics(row);
+    size_t cursorIndex = metrics.GetSize();
+    if (cursorGlyph.glyph->GetParent() == row.get()) {
+        auto container = static_cast<GlyphContainer*>(row.get());
+        cursorIndex = container->GetGlyphIndex(cursorGlyph.glyph);
+    }
+    for (size_t i = 0; i < metrics.GetSize(); ++i) {
+        renderer->DrawChar(metrics.symbols[i], metrics.x[i], metrics.y[i],
+                           metrics.width[i], metrics.height[i]);
+
+        // draw cursor before or after the character it keeps to
+        if (i == cursorIndex) {
+            int x = cursorGlyph.isBefore ? metrics.x[i]
+                                         : metrics.x[i] + metrics.width[i];
+            renderer->DrawCursor(x, metrics.y[i], metrics.height[i]);
+        }
+    }
+}
+
+void Document::RedrawPage(const Page::PagePtr& page, size_t index,
+                          const Rect& visible,
+                          const CursorGlyph& cursorGlyph) {
+    std::vector<Rect> areas;
+    for (const Rect& rect : dirtyRegion.GetRects(page.get())) {
+        Rect area = rect.Intersection(visible);
+        if (!area.IsEmpty()) {
+            areas.push_back(area);
+        }
+    }
+    if (areas.empty()) {
+        return;
+    }
+
+    auto isDirty = [&](const Glyph::GlyphPtr& glyph) {
+        Rect rect = glyph->GetRect();
+        return std::any_of(areas.begin(), areas.end(), [&](const Rect& area) {
+            return area.Intersects(rect);
+        });
+    };
+
+    renderer->SelectPage(index, pageWidth, pageHeight);
+    for (const Rect& area : areas) {
+        renderer->ClearRegion(area.x, area.y, area.width, area.height);
+    }
+    for (const auto& column : page->GetChildren()) {
+        if (!isDirty(column)) {
+            continue;
+        }
+        for (const auto& row : column->GetChildren()) {
+            if (isDirty(row)) {
+                DrawRow(row, cursorGlyph);
             }
         }
     }
-}
\ No newline at end of file
+    dirtyRegion.Remove(page.get(), visible);
+}
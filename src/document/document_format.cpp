@@ -0,0 +1,178 @@
+#include "document/document_format.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "compositor/simple_compositor/simple_compositor.h"
+#include "utils/binary_io.h"
+#include "utils/mapped_file.h"
+
+constexpr uint16_t DocumentFormat::kVersion;
+
+namespace {
+
+const char kMagic[4] = {'L', 'X', 'D', 'F'};
+
+// streams are read in parts of this size
+const size_t kChunkSize = 1 << 20;
+
+/**
+ * @brief           Creates the document from its file contents.
+ * @param owner     Pointer owning the data, the text of the document refers
+ * to it.
+ * @param pagesCount    Number of pages composed at once.
+ */
+std::shared_ptr<Document> Parse(const char* data, size_t size,
+                                const std::shared_ptr<const void>& owner,
+                                size_t pagesCount) {
+    BinaryReader reader(data, size);
+    const char* magic = reader.Skip(sizeof(kMagic));
+    uint16_t version;
+    uint16_t reserved;
+    if (magic == nullptr ||
+        !std::equal(magic, magic + sizeof(kMagic), kMagic) ||
+        !reader.Read(version) || version != DocumentFormat::kVersion ||
+        !reader.Read(reserved)) {
+        return nullptr;
+    }
+
+    uint8_t alignment;
+    int32_t topIndent, bottomIndent, leftIndent, rightIndent, lineSpacing;
+    uint64_t cursorOffset, length;
+    if (!reader.Read(alignment) || alignment > Compositor::JUSTIFIED ||
+        !reader.Read(topIndent) || !reader.Read(bottomIndent) ||
+        !reader.Read(leftIndent) || !reader.Read(rightIndent) ||
+        !reader.Read(lineSpacing) || !reader.Read(cursorOffset) ||
+        !reader.Read(length) || cursorOffset > length) {
+        return nullptr;
+    }
+    const char* text = reader.Skip(length);
+
+    uint64_t runsCount;
+    if (text == nullptr || !reader.Read(runsCount) || runsCount > length) {
+        return nullptr;
+    }
+    std::vector<CharacterRun> runs;
+    runs.reserve(runsCount);
+    uint64_t total = 0;
+    for (uint64_t i = 0; i < runsCount; ++i) {
+        uint64_t count;
+        int32_t width, height;
+        if (!reader.Read(count) || !reader.Read(width) ||
+            !reader.Read(height) || count > length - total || width <= 0 ||
+            height <= 0) {
+            return nullptr;
+        }
+        total += count;
+        runs.push_back({size_t(count), width, height});
+    }
+    if (total != length) {
+        return nullptr;
+    }
+
+    auto document =
+        std::make_shared<Document>(std::make_shared<SimpleCompositor>(
+            topIndent, bottomIndent, leftIndent, rightIndent,
+            Compositor::Alignment(alignment), lineSpacing));
+    // the text is not copied, it refers to the data
+    document->SetCharacters(
+        TextBuffer(std::shared_ptr<const char>(owner, text), size_t(length)),
+        runs, size_t(cursorOffset), pagesCount);
+    return document;
+}
+
+}  // namespace
+
+bool DocumentFormat::Write(std::ostream& os, const Document& document) {
+    return Write(os, document.GetSnapshot());
+}
+
+bool DocumentFormat::Write(std::ostream& os,
+                           const DocumentSnapshot& snapshot) {
+    const TextBuffer& text = snapshot.text;
+
+    BinaryWriter writer;
+    for (char symbol : kMagic) {
+        writer.Write(symbol);
+    }
+    writer.Write(kVersion);
+    writer.Write(uint16_t(0));
+
+    const Compositor& compositor = *snapshot.compositor;
+    writer.Write(uint8_t(compositor.GetAlignment()));
+    writer.Write(int32_t(compositor.GetTopIndent()));
+    writer.Write(int32_t(compositor.GetBottomIndent()));
+    writer.Write(int32_t(compositor.GetLeftIndent()));
+    writer.Write(int32_t(compositor.GetRightIndent()));
+    writer.Write(int32_t(compositor.GetLineSpacing()));
+
+    writer.Write(uint64_t(snapshot.cursorOffset));
+    writer.Write(uint64_t(text.GetLength()));
+    if (!writer.Flush(os)) {
+        return false;
+    }
+
+    // the pieces of the text are written to the stream as they are, without
+    // being copied into a string
+    if (!text.Write(os)) {
+        return false;
+    }
+
+    // the runs are collected from the pieces of the text, not from the glyphs
+    std::vector<CharacterRun> runs = text.GetRuns();
+    writer.Write(uint64_t(runs.size()));
+    for (const CharacterRun& run : runs) {
+        writer.Write(uint64_t(run.count));
+        writer.Write(int32_t(run.width));
+        writer.Write(int32_t(run.height));
+    }
+    return writer.Flush(os) && bool(os.flush());
+}
+
+bool DocumentFormat::Save(const std::string& path,
+                          const DocumentSnapshot& snapshot) {
+    std::string temporaryPath = path + ".tmp";
+    bool isWritten;
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        isWritten = file && Write(file, snapshot);
+    }
+    // renaming replaces the file at once, so it is never left half-written
+    if (!isWritten || std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::shared_ptr<Document> DocumentFormat::Read(std::istream& is) {
+    auto data = std::make_shared<std::string>();
+    while (is) {
+        size_t size = data->size();
+        data->resize(size + kChunkSize);
+        is.read(&(*data)[size], kChunkSize);
+        data->resize(size + is.gcount());
+    }
+    if (!is.eof()) {
+        return nullptr;
+    }
+
+    std::shared_ptr<Document> document =
+        Parse(data->data(), data->size(), data, 0);
+    if (document != nullptr) {
+        document->LoadAll();
+    }
+    return document;
+}
+
+std::shared_ptr<Document> DocumentFormat::Map(const std::string& path,
+                                              size_t pagesCount) {
+    std::shared_ptr<MappedFile> file = MappedFile::Open(path);
+    if (file == nullptr) {
+        return nullptr;
+    }
+    return Parse(file->GetData(), file->GetSize(), file, pagesCount);
+}
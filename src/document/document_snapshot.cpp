@@ -0,0 +1,25 @@
+#include "document/document_snapshot.h"
+
+#include <algorithm>
+
+bool TextChange::IsEmpty() const {
+    return !isFull && removedLength == 0 && insertedLength == 0;
+}
+
+void TextChange::Merge(const TextChange& next) {
+    if (isFull || next.IsEmpty()) {
+        return;
+    }
+    if (next.isFull || IsEmpty()) {
+        *this = next;
+        return;
+    }
+    // the range of the text between the changes covers the characters
+    // inserted by this one and removed by the next one
+    size_t begin = std::min(offset, next.offset);
+    size_t end = std::max(offset + insertedLength,
+                          next.offset + next.removedLength);
+    removedLength = end - begin - insertedLength + removedLength;
+    insertedLength = end - begin - next.removedLength + next.insertedLength;
+    offset = begin;
+}
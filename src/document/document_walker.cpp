@@ -0,0 +1,74 @@
+#include "document/document_walker.h"
+
+#include <cassert>
+
+DocumentWalker::DocumentWalker(PageList::const_iterator page,
+                               PageList::const_iterator pagesEnd, Level level)
+    : page(page), pagesEnd(pagesEnd), level(level) {
+    if (page != pagesEnd) {
+        Glyph::ChildrenRange columns = (*page)->GetChildren();
+        positions[COLUMNS] = columns.begin();
+        ends[COLUMNS] = columns.end();
+        Settle(COLUMNS);
+    }
+}
+
+DocumentWalker::reference DocumentWalker::operator*() const {
+    assert(page != pagesEnd && "Cannot dereference end of document");
+    return *positions[level];
+}
+
+DocumentWalker::pointer DocumentWalker::operator->() const {
+    return &**this;
+}
+
+DocumentWalker& DocumentWalker::operator++() {
+    assert(page != pagesEnd && "Cannot move past end of document");
+    ++positions[level];
+    Settle(level);
+    return *this;
+}
+
+DocumentWalker DocumentWalker::operator++(int) {
+    DocumentWalker previous = *this;
+    ++*this;
+    return previous;
+}
+
+bool DocumentWalker::operator==(const DocumentWalker& other) const {
+    if (page != other.page) {
+        return false;
+    }
+    return page == pagesEnd || positions[level] == other.positions[level];
+}
+
+bool DocumentWalker::operator!=(const DocumentWalker& other) const {
+    return !(*this == other);
+}
+
+void DocumentWalker::Settle(int current) {
+    while (true) {
+        if (positions[current] != ends[current]) {
+            if (current == level) {
+                return;
+            }
+            // go down to the children of the current glyph
+            Glyph::ChildrenRange children = (*positions[current])->GetChildren();
+            ++current;
+            positions[current] = children.begin();
+            ends[current] = children.end();
+        } else if (current > COLUMNS) {
+            // children are over, go to the next glyph of the parent
+            --current;
+            ++positions[current];
+        } else {
+            ++page;
+            if (page == pagesEnd) {
+                return;
+            }
+            Glyph::ChildrenRange columns = (*page)->GetChildren();
+            positions[COLUMNS] = columns.begin();
+            ends[COLUMNS] = columns.end();
+        }
+    }
+}
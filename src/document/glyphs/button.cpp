@@ -2,7 +2,7 @@
 
 Button::Button(const int x, const int y, const int width, const int height,
                const std::string& name)
-    : Glyph(x, y, width, height) {
+    : Glyph(x, y, width, height, kKind) {
     this->name = name;
 }
 
@@ -14,8 +14,8 @@ Glyph::GlyphPtr Button::GetLastGlyph() { return nullptr; }
 Glyph::GlyphPtr Button::GetNextGlyph(GlyphPtr& glyph) { return nullptr; }
 Glyph::GlyphPtr Button::GetPreviousGlyph(GlyphPtr& glyph) { return nullptr; }
 
+void Button::Accept(GlyphVisitor& visitor) { visitor.VisitButton(*this); }
+
 std::shared_ptr<Glyph> Button::Clone() const {
-    Button* copy =
-        new Button(this->x, this->y, this->width, this->height, this->name);
-    return std::make_shared<Button>(*copy);
+    return std::make_shared<Button>(*this);
 }
\ No newline at end of file
@@ -4,12 +4,26 @@
 #include <boost/archive/text_oarchive.hpp>
 BOOST_CLASS_EXPORT_IMPLEMENT(Character)
 
+#include "document/glyphs/glyph_metrics.h"
+
 Character::Character(const int x, const int y, const int width,
                      const int height, char c)
-    : Glyph(x, y, width, height), symbol(c) {}
+    : Glyph(x, y, width, height, kKind), symbol(c) {}
 
-void Character::SetChar(char c) { symbol = c; }
-char Character::GetChar() const { return symbol; }
+void Character::SetChar(char c) {
+    size_t index;
+    GlyphMetrics* metrics = GetContainerMetrics(index);
+    if (metrics != nullptr) {
+        metrics->symbols[index] = c;
+    } else {
+        symbol = c;
+    }
+}
+char Character::GetChar() const {
+    size_t index;
+    const GlyphMetrics* metrics = GetContainerMetrics(index);
+    return metrics != nullptr ? metrics->symbols[index] : symbol;
+}
 
 Glyph::GlyphPtr Character::GetFirstGlyph() { return nullptr; }
 Glyph::GlyphPtr Character::GetLastGlyph() { return nullptr; }
@@ -17,15 +31,16 @@ Glyph::GlyphPtr Character::GetLastGlyph() { return nullptr; }
 Glyph::GlyphPtr Character::GetNextGlyph(GlyphPtr& glyph) { return nullptr; }
 Glyph::GlyphPtr Character::GetPreviousGlyph(GlyphPtr& glyph) { return nullptr; }
 
+void Character::Accept(GlyphVisitor& visitor) { visitor.VisitCharacter(*this); }
+
 std::shared_ptr<Glyph> Character::Clone() const {
-    Character* copy = new Character(this->x, this->y, this->width, this->height,
-                                    this->symbol);
-    return std::make_shared<Character>(*copy);
+    return std::make_shared<Character>(*this);
 }
 
 std::ostream& operator<<(std::ostream& os, const Character& character) {
-    os << "x: " << character.x << " y: " << character.y
-       << " width: " << character.width << " height: " << character.height
-       << " symbol: " << character.symbol << std::endl;
+    Rect rect = character.GetRect();
+    os << "x: " << rect.x << " y: " << rect.y << " width: " << rect.width
+       << " height: " << rect.height << " symbol: " << character.GetChar()
+       << std::endl;
     return os;
 }
\ No newline at end of file
@@ -0,0 +1,17 @@
+#include "document/glyphs/character_factory.h"
+
+#include <utility>
+
+CharacterFactory::CharacterFactory(std::shared_ptr<MemoryPool> memoryPool)
+    : memoryPool(std::move(memoryPool)) {}
+
+Character::CharPtr CharacterFactory::CreateCharacter(int x, int y, int width,
+                                                     int height, char symbol) {
+    return AllocateShared<Character>(memoryPool, x, y, width, height, symbol);
+}
+
+Character::CharPtr CharacterFactory::CreateCharacter(int x, int y, char symbol,
+                                                     int size) {
+    // all symbols of a font size are square for now
+    return CreateCharacter(x, y, size, size, symbol);
+}
@@ -12,15 +12,17 @@ BOOST_CLASS_EXPORT_IMPLEMENT(Column)
 int charHeight = 1;  // temporary!!!
 
 Column::Column(const int x, const int y, const int width, const int height)
-    : GlyphContainer(x, y, width, height) {
+    : GlyphContainer(x, y, width, height, kKind) {
     Glyph::GlyphPtr firstRowPtr =
         std::make_shared<Row>(Row(x, y, width, charHeight));
     this->Add(firstRowPtr);
 }
 
 Glyph::GlyphList Column::Select(const Glyph::GlyphPtr& area) {
+    Range<GlyphVector::iterator> candidates =
+        GetComponentsOnAxis(area, VERTICAL);
     auto intersectedRows = find_all_if(
-        components.begin(), components.end(),
+        candidates.begin(), candidates.end(),
         [&](const auto& component) { return component->Intersects(area); });
 
     Glyph::GlyphList list;
@@ -40,9 +42,7 @@ Glyph::GlyphList Column::Select(const Glyph::GlyphPtr& area) {
 }
 
 void Column::Insert(GlyphPtr& glyph) {
-    auto intersectedGlyphIt = std::find_if(
-        components.begin(), components.end(),
-        [&](const auto& component) { return component->Intersects(glyph); });
+    auto intersectedGlyphIt = FindIntersectingComponent(glyph, VERTICAL);
     assert(intersectedGlyphIt != components.end() &&
            "No suitable row for inserting");
 
@@ -51,15 +51,13 @@ void Column::Insert(GlyphPtr& glyph) {
 
 void Column::Remove(const GlyphPtr& glyph) {
     assert(glyph != nullptr && "Cannot remove glyph by nullptr");
-    auto it = std::find(components.begin(), components.end(), glyph);
+    auto it = FindComponent(glyph);
     if (it != components.end()) {
-        if (it != components.begin()) components.erase(it);
+        if (it != components.begin()) EraseComponent(it);
         return;
     }
 
-    auto intersectedGlyphIt = std::find_if(
-        components.begin(), components.end(),
-        [&](const auto& component) { return component->Intersects(glyph); });
+    auto intersectedGlyphIt = FindIntersectingComponent(glyph, VERTICAL);
     assert(intersectedGlyphIt != components.end() &&
            "No suitable row for removing");
 
@@ -67,11 +65,12 @@ void Column::Remove(const GlyphPtr& glyph) {
 }
 
 bool Column::IsEmpty() const { return components.empty(); }
-bool Column::IsFull() const { return usedHeight >= height; }
-int Column::GetFreeSpace() const { return height - usedHeight; }
+bool Column::IsFull() const { return usedHeight >= GetHeight(); }
+int Column::GetFreeSpace() const { return GetHeight() - usedHeight; }
 int Column::GetUsedSpace() const { return usedHeight; }
 
+void Column::Accept(GlyphVisitor& visitor) { visitor.VisitColumn(*this); }
+
 std::shared_ptr<Glyph> Column::Clone() const {
-    Column* copy = new Column(this->x, this->y, this->width, this->height);
-    return std::make_shared<Column>(*copy);
+    return std::make_shared<Column>(*this);
 }
\ No newline at end of file
@@ -2,14 +2,29 @@
 
 #include <cassert>
 
+#include "document/glyphs/glyph_container.h"
 #include "utils/point.h"
 
-Glyph::Glyph(const int x, const int y, const int width, const int height)
-    : x(x), y(y), width(width), height(height) {}
+Glyph::Glyph(const int x, const int y, const int width, const int height,
+             GlyphKind kind)
+    : bounds{x, y, width, height}, kind(kind) {}
+
+Glyph::Glyph(const Glyph& other)
+    : kind(other.kind) {
+    Rect rect = other.GetRect();
+    bounds = {rect.x, rect.y, rect.width, rect.height};
+}
+
+Glyph& Glyph::operator=(const Glyph& other) {
+    Rect rect = other.GetRect();
+    SetBounds(rect.x, rect.y, rect.width, rect.height);
+    return *this;
+}
 
 bool Glyph::Intersects(const Point& p) const noexcept {
-    if (p.x >= this->x && p.x <= this->x + this->width) {
-        if (p.y >= this->y && p.y <= this->y + this->height) {
+    Rect rect = GetRect();
+    if (p.x >= rect.x && p.x <= rect.x + rect.width) {
+        if (p.y >= rect.y && p.y <= rect.y + rect.height) {
             return true;
         }
     }
@@ -17,70 +32,121 @@ bool Glyph::Intersects(const Point& p) const noexcept {
 }
 
 bool Glyph::Intersects(const GlyphPtr& glyph) const {
-    bool res =
-        Intersects({glyph->GetPosition().x, glyph->GetPosition().y}) ||
-        Intersects({glyph->GetPosition().x + glyph->GetWidth(),
-                    glyph->GetPosition().y}) ||
-        Intersects({glyph->GetPosition().x,
-                    glyph->GetPosition().y + glyph->GetHeight()}) ||
-        Intersects({glyph->GetPosition().x + glyph->GetWidth(),
-                    glyph->GetPosition().y + glyph->GetHeight()})
-
-        || glyph->Intersects({this->x, this->y}) ||
-        glyph->Intersects({this->x + this->width, this->y}) ||
-        glyph->Intersects({this->x, this->y + this->height}) ||
-        glyph->Intersects({this->x + this->width, this->y + this->height});
-    return res;
+    // the same as checking whether any corner of one glyph falls into the
+    // other one: a corner falls into a rectangle if one of the borders of
+    // each axis does
+    auto contains = [](int begin, int end, int value) {
+        return value >= begin && value <= end;
+    };
+    auto hasCornerIn = [&](int x, int y, int width, int height, int otherX,
+                           int otherY, int otherWidth, int otherHeight) {
+        return (contains(x, x + width, otherX) ||
+                contains(x, x + width, otherX + otherWidth)) &&
+               (contains(y, y + height, otherY) ||
+                contains(y, y + height, otherY + otherHeight));
+    };
+    Rect rect = GetRect();
+    Rect other = glyph->GetRect();
+    return hasCornerIn(rect.x, rect.y, rect.width, rect.height, other.x,
+                       other.y, other.width, other.height) ||
+           hasCornerIn(other.x, other.y, other.width, other.height, rect.x,
+                       rect.y, rect.width, rect.height);
 }
 
 void Glyph::MoveGlyph(int x, int y) {
-    assert((x >= -this->x && y >= -this->y) &&
+    Point position = GetPosition();
+    assert((x >= -position.x && y >= -position.y) &&
            "Cannot move glyph due to these coordinates");
-    SetPosition(this->x + x, this->y + y);
+    SetPosition(position.x + x, position.y + y);
 }
 
+Glyph::ChildrenRange Glyph::GetChildren() const { return ChildrenRange(); }
+
 void Glyph::SetPosition(const Point& p) {
     assert((p.x >= 0 && p.y >= 0) && "Invalid position of glyph");
-    this->x = p.x;
-    this->y = p.y;
+    SetBounds(p.x, p.y, GetWidth(), GetHeight());
 }
 
 void Glyph::SetPosition(int x, int y) {
     assert((x >= 0 && y >= 0) && "Invalid position of glyph");
-    this->x = x;
-    this->y = y;
+    SetBounds(x, y, GetWidth(), GetHeight());
 }
 
 void Glyph::SetWidth(int width) {
     assert(width >= 0 && "Invalid width of glyph");
-    this->width = width;
+    Point position = GetPosition();
+    SetBounds(position.x, position.y, width, GetHeight());
 }
 
 void Glyph::SetHeight(int height) {
     assert(height >= 0 && "Invalid height of glyph");
-    this->height = height;
+    Point position = GetPosition();
+    SetBounds(position.x, position.y, GetWidth(), height);
 }
 
 void Glyph::SetGlyphParams(const int x, const int y, const int width,
                            const int height) {
     assert((x >= 0 && y >= 0 && width >= 0 && height >= 0) &&
            "Invalid params of glyph");
-    this->x = x;
-    this->y = y;
-    this->width = width;
-    this->height = height;
+    SetBounds(x, y, width, height);
+}
+
+void Glyph::SetBounds(int x, int y, int width, int height) {
+    if (isPlaced) {
+        GlyphMetrics& metrics = place.parent->metrics;
+        metrics.x[place.index] = x;
+        metrics.y[place.index] = y;
+        metrics.width[place.index] = width;
+        metrics.height[place.index] = height;
+    } else {
+        bounds = {x, y, width, height};
+    }
+}
+
+int Glyph::GetWidth() const {
+    return isPlaced ? place.parent->metrics.width[place.index] : bounds.width;
+}
+
+int Glyph::GetHeight() const {
+    return isPlaced ? place.parent->metrics.height[place.index]
+                    : bounds.height;
+}
+
+Point Glyph::GetPosition() const {
+    if (isPlaced) {
+        const GlyphMetrics& metrics = place.parent->metrics;
+        return {metrics.x[place.index], metrics.y[place.index]};
+    }
+    return {bounds.x, bounds.y};
 }
 
-int Glyph::GetWidth() const { return this->width; }
-int Glyph::GetHeight() const { return this->height; }
+Rect Glyph::GetRect() const {
+    if (isPlaced) {
+        return place.parent->metrics.GetRect(place.index);
+    }
+    return Rect(bounds.x, bounds.y, bounds.width, bounds.height);
+}
 
-Point Glyph::GetPosition() const { return {this->x, this->y}; }
+Glyph* Glyph::GetParent() const { return GetContainer(); }
 
-int Glyph::GetBottomBorder() const noexcept { return this->y + height; }
-int Glyph::GetRightBorder() const noexcept { return this->x + width; }
+GlyphMetrics* Glyph::GetContainerMetrics(size_t& index) const {
+    if (!isPlaced) {
+        return nullptr;
+    }
+    index = place.index;
+    return &place.parent->metrics;
+}
+
+int Glyph::GetBottomBorder() const noexcept {
+    return GetPosition().y + GetHeight();
+}
+int Glyph::GetRightBorder() const noexcept {
+    return GetPosition().x + GetWidth();
+}
 
 std::ostream& operator<<(std::ostream& os, const Glyph& glyph) {
-    os << "x: " << glyph.x << " y: " << glyph.y << " width: " << glyph.width
-       << " height: " << glyph.height;
+    Rect rect = glyph.GetRect();
+    os << "x: " << rect.x << " y: " << rect.y << " width: " << rect.width
+       << " height: " << rect.height;
     return os;
 }
\ No newline at end of file
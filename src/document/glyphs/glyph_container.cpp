@@ -4,59 +4,131 @@
 #include <cassert>
 #include <iterator>
 
+#include "document/glyphs/character.h"
 #include "utils/point.h"
 
 GlyphContainer::GlyphContainer(const int x, const int y, const int width,
-                               const int height)
-    : Glyph(x, y, width, height) {}
+                               const int height, GlyphKind kind)
+    : Glyph(x, y, width, height, kind) {}
+
+GlyphContainer::GlyphContainer(const GlyphContainer& other)
+    : Glyph(other), metrics(other.metrics) {
+    CloneComponents(other);
+}
+
+GlyphContainer& GlyphContainer::operator=(const GlyphContainer& other) {
+    if (this == &other) {
+        return *this;
+    }
+    Glyph::operator=(other);
+    for (size_t i = 0; i < components.size(); ++i) {
+        DetachComponent(i);
+    }
+    metrics = other.metrics;
+    CloneComponents(other);
+    return *this;
+}
+
+GlyphContainer::~GlyphContainer() {
+    // components may outlive the container if they are shared
+    for (size_t i = 0; i < components.size(); ++i) {
+        DetachComponent(i);
+    }
+}
 
 size_t GlyphContainer::GetGlyphIndex(const GlyphPtr& glyph) {
-    auto res = std::find_if(components.cbegin(), components.cend(),
-                            [&](const auto& it) { return it == glyph; });
-    assert((res != components.cend()) &&
+    auto res = FindComponent(glyph);
+    assert((res != components.end()) &&
            "GlyphContainer doesn't contain this glyph");
-    return std::distance(components.cbegin(), res);
+    return std::distance(components.begin(), res);
 }
 
 Glyph::GlyphPtr GlyphContainer::GetGlyphByIndex(int index) {
     assert(index >= 0 && "Invalid index of glyph");
-    size_t count = 0;
-    for (const auto& ptr : components) {
-        if (count == index) {
-            return ptr;
-        }
-        count++;
+    if (static_cast<size_t>(index) >= components.size()) {
+        return nullptr;
     }
-    return nullptr;
+    return components[index];
 }
 
-void GlyphContainer::Add(GlyphPtr glyph) { components.push_back(glyph); }
+void GlyphContainer::Add(GlyphPtr glyph) {
+    InsertComponent(components.end(), glyph);
+}
 
 void GlyphContainer::MoveGlyph(int x, int y) {
     Glyph::MoveGlyph(x, y);
-    for (auto component : components) {
+    for (auto& component : components) {
         component->MoveGlyph(x, y);
     }
 }
 
+Glyph::ChildrenRange GlyphContainer::GetChildren() const {
+    return ChildrenRange(components.cbegin(), components.cend());
+}
+
+const GlyphMetrics& GlyphContainer::GetMetrics() const { return metrics; }
+
+size_t GlyphContainer::GetCharactersCount() const { return charactersCount; }
+
+Glyph::GlyphPtr GlyphContainer::GetCharacter(size_t index) const {
+    const GlyphContainer* container = this;
+    while (index < container->charactersCount) {
+        size_t componentIndex = container->GetCharactersIndex().Find(index);
+        const GlyphPtr& component = container->components[componentIndex];
+        if (!component->IsContainer()) {
+            return component;
+        }
+        container = static_cast<const GlyphContainer*>(component.get());
+    }
+    return nullptr;
+}
+
+size_t GlyphContainer::CountCharactersBefore(const Glyph& glyph,
+                                             const GlyphContainer*& root) {
+    size_t count = 0;
+    const Glyph* current = &glyph;
+    root = nullptr;
+    while (current->GetContainer() != nullptr) {
+        const GlyphContainer* parent = current->GetContainer();
+        size_t index = current->place.index;
+        if (index >= parent->components.size() ||
+            parent->components[index].get() != current) {
+            // the glyph is shared with another container
+            auto it = std::find_if(
+                parent->components.begin(), parent->components.end(),
+                [&](const GlyphPtr& component) {
+                    return component.get() == current;
+                });
+            index = std::distance(parent->components.begin(), it);
+        }
+        count += parent->GetCharactersIndex().GetPrefixSum(index);
+        root = parent;
+        current = parent;
+    }
+    return count;
+}
+
+void GlyphContainer::SetCharactersCountListener(
+    CharactersCountListener* listener) {
+    charactersCountListener = listener;
+}
+
 Glyph::GlyphPtr GlyphContainer::GetFirstGlyph() {
-    if (components.begin() == components.end()) {
+    if (components.empty()) {
         return nullptr;
     }
-    return *(components.begin());
+    return components.front();
 }
 
 Glyph::GlyphPtr GlyphContainer::GetLastGlyph() {
-    if (components.begin() == components.end()) {
+    if (components.empty()) {
         return nullptr;
     }
-    return *(components.end()--);
+    return components.back();
 }
 
 Glyph::GlyphPtr GlyphContainer::GetNextGlyph(GlyphPtr& glyph) {
-    auto currentGlyph =
-        std::find_if(components.begin(), components.end(),
-                     [&](const auto& elem) { return elem == glyph; });
+    auto currentGlyph = FindComponent(glyph);
 
     assert(currentGlyph != components.end());
 
@@ -68,15 +140,225 @@ Glyph::GlyphPtr GlyphContainer::GetNextGlyph(GlyphPtr& glyph) {
 }
 
 Glyph::GlyphPtr GlyphContainer::GetPreviousGlyph(GlyphPtr& glyph) {
-    auto currentGlyph =
-        std::find_if(components.begin(), components.end(),
-                     [&](const auto& elem) { return elem == glyph; });
+    auto currentGlyph = FindComponent(glyph);
 
     assert(currentGlyph != components.end());
 
     if (currentGlyph == components.begin()) {
         return nullptr;
     }
-    auto previousGlyph = std::prev(currentGlyph);
-    return *previousGlyph;
-}
\ No newline at end of file
+    return *std::prev(currentGlyph);
+}
+
+Range<GlyphContainer::GlyphVector::iterator>
+GlyphContainer::GetComponentsOnAxis(const GlyphPtr& glyph, Axis axis) {
+    // borders are read from the metrics, so the search doesn't visit the
+    // components
+    const std::vector<int>& begins =
+        axis == HORIZONTAL ? metrics.x : metrics.y;
+    const std::vector<int>& sizes =
+        axis == HORIZONTAL ? metrics.width : metrics.height;
+    int glyphBegin =
+        axis == HORIZONTAL ? glyph->GetPosition().x : glyph->GetPosition().y;
+    int glyphEnd =
+        axis == HORIZONTAL ? glyph->GetRightBorder() : glyph->GetBottomBorder();
+
+    // index of the first component for which the predicate is false
+    auto partitionPoint = [](size_t first, size_t last, auto predicate) {
+        while (first < last) {
+            size_t middle = first + (last - first) / 2;
+            if (predicate(middle)) {
+                first = middle + 1;
+            } else {
+                last = middle;
+            }
+        }
+        return first;
+    };
+    size_t first = partitionPoint(0, components.size(), [&](size_t i) {
+        return begins[i] + sizes[i] < glyphBegin;
+    });
+    size_t last = partitionPoint(first, components.size(), [&](size_t i) {
+        return begins[i] <= glyphEnd;
+    });
+    return Range<GlyphVector::iterator>(components.begin() + first,
+                                        components.begin() + last);
+}
+
+GlyphContainer::GlyphVector::iterator GlyphContainer::FindIntersectingComponent(
+    const GlyphPtr& glyph, Axis axis) {
+    Range<GlyphVector::iterator> candidates = GetComponentsOnAxis(glyph, axis);
+    auto it = std::find_if(
+        candidates.begin(), candidates.end(),
+        [&](const GlyphPtr& component) { return component->Intersects(glyph); });
+    if (it != candidates.end()) {
+        return it;
+    }
+    // components may overlap until the compositor places them again
+    return std::find_if(
+        components.begin(), components.end(),
+        [&](const GlyphPtr& component) { return component->Intersects(glyph); });
+}
+
+GlyphContainer::GlyphVector::iterator GlyphContainer::FindComponent(
+    const GlyphPtr& glyph) {
+    if (glyph == nullptr) {
+        return components.end();
+    }
+    size_t index = glyph->isPlaced ? glyph->place.index : components.size();
+    if (index < components.size() && components[index] == glyph) {
+        return components.begin() + index;
+    }
+    // the glyph may be shared with another container, e.g. by a copy
+    return std::find(components.begin(), components.end(), glyph);
+}
+
+GlyphContainer::GlyphVector::iterator GlyphContainer::InsertComponent(
+    GlyphVector::iterator position, const GlyphPtr& glyph) {
+    size_t index = std::distance(components.begin(), position);
+    components.insert(position, glyph);
+    metrics.Insert(index, *glyph);
+    UpdateIndices(index);
+    isCharactersIndexValid = false;
+    ChangeCharactersCount(CountCharacters(*glyph));
+    return components.begin() + index;
+}
+
+GlyphContainer::GlyphVector::iterator GlyphContainer::InsertComponents(
+    GlyphVector::iterator position, const GlyphVector& glyphs) {
+    size_t index = std::distance(components.begin(), position);
+    components.insert(position, glyphs.begin(), glyphs.end());
+    metrics.Insert(index, glyphs);
+    UpdateIndices(index);
+    size_t count = 0;
+    for (const auto& glyph : glyphs) {
+        count += CountCharacters(*glyph);
+    }
+    isCharactersIndexValid = false;
+    ChangeCharactersCount(count);
+    return components.begin() + index;
+}
+
+GlyphContainer::GlyphVector::iterator GlyphContainer::EraseComponent(
+    GlyphVector::iterator position) {
+    size_t index = std::distance(components.begin(), position);
+    DetachComponent(index);
+    size_t count = CountCharacters(**position);
+    components.erase(position);
+    metrics.Erase(index, index + 1);
+    UpdateIndices(index);
+    isCharactersIndexValid = false;
+    ChangeCharactersCount(-static_cast<ptrdiff_t>(count));
+    return components.begin() + index;
+}
+
+GlyphContainer::GlyphVector::iterator GlyphContainer::EraseComponents(
+    GlyphVector::iterator first, GlyphVector::iterator last) {
+    size_t index = std::distance(components.begin(), first);
+    size_t charactersRemoved = 0;
+    for (auto it = first; it != last; ++it) {
+        DetachComponent(std::distance(components.begin(), it));
+        charactersRemoved += CountCharacters(**it);
+    }
+    size_t count = std::distance(first, last);
+    components.erase(first, last);
+    metrics.Erase(index, index + count);
+    UpdateIndices(index);
+    isCharactersIndexValid = false;
+    ChangeCharactersCount(-static_cast<ptrdiff_t>(charactersRemoved));
+    return components.begin() + index;
+}
+
+void GlyphContainer::CloneComponents(const GlyphContainer& other) {
+    // the copy owns its components, the ones of the other container keep
+    // their parent
+    components.clear();
+    components.reserve(other.components.size());
+    for (const auto& component : other.components) {
+        components.push_back(component->Clone());
+    }
+    UpdateIndices(0);
+    CountComponentsCharacters();
+}
+
+size_t GlyphContainer::CountCharacters(const Glyph& glyph) {
+    if (glyph.IsContainer()) {
+        return static_cast<const GlyphContainer&>(glyph).charactersCount;
+    }
+    return glyph.GetKind() == CHARACTER ? 1 : 0;
+}
+
+const FenwickTree& GlyphContainer::GetCharactersIndex() const {
+    if (!isCharactersIndexValid) {
+        std::vector<size_t> counts;
+        counts.reserve(components.size());
+        for (const auto& component : components) {
+            counts.push_back(CountCharacters(*component));
+        }
+        charactersIndex.Assign(counts);
+        isCharactersIndexValid = true;
+    }
+    return charactersIndex;
+}
+
+void GlyphContainer::ChangeCharactersCount(ptrdiff_t delta) {
+    if (delta == 0) {
+        return;
+    }
+    GlyphContainer* container = this;
+    while (true) {
+        container->charactersCount += delta;
+        GlyphContainer* parent = container->GetContainer();
+        if (parent == nullptr) {
+            if (container->charactersCountListener != nullptr) {
+                container->charactersCountListener->OnCharactersCountChanged(
+                    *container, delta);
+            }
+            return;
+        }
+        // the counts of the parent are rebuilt if it doesn't keep the
+        // container at its index
+        size_t index = container->place.index;
+        if (parent->isCharactersIndexValid) {
+            if (index < parent->components.size() &&
+                parent->components[index].get() == container) {
+                parent->charactersIndex.Add(index, delta);
+            } else {
+                parent->isCharactersIndexValid = false;
+            }
+        }
+        container = parent;
+    }
+}
+
+void GlyphContainer::CountComponentsCharacters() {
+    size_t count = 0;
+    for (const auto& component : components) {
+        count += CountCharacters(*component);
+    }
+    isCharactersIndexValid = false;
+    ChangeCharactersCount(static_cast<ptrdiff_t>(count) -
+                          static_cast<ptrdiff_t>(charactersCount));
+}
+
+void GlyphContainer::UpdateIndices(size_t first) {
+    for (size_t i = first; i < components.size(); ++i) {
+        components[i]->place = {this, i};
+        components[i]->isPlaced = true;
+    }
+}
+
+void GlyphContainer::DetachComponent(size_t index) {
+    Glyph& component = *components[index];
+    // a shared component is described by the container it was added to last
+    if (component.GetContainer() != this) {
+        return;
+    }
+    Rect rect = metrics.GetRect(index);
+    component.isPlaced = false;
+    component.bounds = {rect.x, rect.y, rect.width, rect.height};
+    Character* character = component.As<Character>();
+    if (character != nullptr) {
+        character->SetChar(metrics.symbols[index]);
+    }
+}
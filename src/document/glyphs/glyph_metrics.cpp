@@ -0,0 +1,65 @@
+#include "document/glyphs/glyph_metrics.h"
+
+#include <cassert>
+
+#include "document/glyphs/character.h"
+
+namespace {
+
+char GetSymbol(const Glyph& glyph) {
+    const Character* character = glyph.As<Character>();
+    return character != nullptr ? character->GetChar() : '\0';
+}
+
+}  // namespace
+
+size_t GlyphMetrics::GetSize() const { return x.size(); }
+
+Rect GlyphMetrics::GetRect(size_t index) const {
+    return Rect(x[index], y[index], width[index], height[index]);
+}
+
+void GlyphMetrics::Insert(size_t index, const Glyph::GlyphVector& glyphs) {
+    assert(index <= GetSize() && "Invalid index of glyph metrics");
+    size_t count = glyphs.size();
+    x.insert(x.begin() + index, count, 0);
+    y.insert(y.begin() + index, count, 0);
+    width.insert(width.begin() + index, count, 0);
+    height.insert(height.begin() + index, count, 0);
+    symbols.insert(symbols.begin() + index, count, '\0');
+    for (size_t i = 0; i < count; ++i) {
+        Set(index + i, *glyphs[i]);
+        symbols[index + i] = GetSymbol(*glyphs[i]);
+    }
+}
+
+void GlyphMetrics::Insert(size_t index, const Glyph& glyph) {
+    assert(index <= GetSize() && "Invalid index of glyph metrics");
+    x.insert(x.begin() + index, glyph.GetPosition().x);
+    y.insert(y.begin() + index, glyph.GetPosition().y);
+    width.insert(width.begin() + index, glyph.GetWidth());
+    height.insert(height.begin() + index, glyph.GetHeight());
+    symbols.insert(symbols.begin() + index, GetSymbol(glyph));
+}
+
+void GlyphMetrics::Erase(size_t first, size_t last) {
+    assert(first <= last && last <= GetSize() &&
+           "Invalid range of glyph metrics");
+    x.erase(x.begin() + first, x.begin() + last);
+    y.erase(y.begin() + first, y.begin() + last);
+    width.erase(width.begin() + first, width.begin() + last);
+    height.erase(height.begin() + first, height.begin() + last);
+    symbols.erase(symbols.begin() + first, symbols.begin() + last);
+}
+
+void GlyphMetrics::Set(size_t index, const Glyph& glyph) {
+    x[index] = glyph.GetPosition().x;
+    y[index] = glyph.GetPosition().y;
+    width[index] = glyph.GetWidth();
+    height[index] = glyph.GetHeight();
+}
+
+void GlyphMetrics::Assign(const Glyph::GlyphVector& glyphs) {
+    Erase(0, GetSize());
+    Insert(0, glyphs);
+}
@@ -2,7 +2,7 @@
 
 MonoGlyph::MonoGlyph(GlyphPtr& glyph)
     : Glyph(glyph->GetPosition().x, glyph->GetPosition().y, glyph->GetWidth(),
-            glyph->GetHeight()) {
+            glyph->GetHeight(), kKind) {
     std::cout << "Monoglyph::Constructor()" << std::endl;
     component = glyph;
 }
@@ -32,6 +32,8 @@ Glyph::GlyphPtr MonoGlyph::GetLastGlyph() { return component; }
 Glyph::GlyphPtr MonoGlyph::GetNextGlyph(GlyphPtr& glyph) { return nullptr; }
 Glyph::GlyphPtr MonoGlyph::GetPreviousGlyph(GlyphPtr& glyph) { return nullptr; }
 
+void MonoGlyph::Accept(GlyphVisitor& visitor) { visitor.VisitMonoGlyph(*this); }
+
 std::shared_ptr<Glyph> MonoGlyph::Clone() const {
     // MonoGlyph* copy =
     //     new MonoGlyph(this->component);
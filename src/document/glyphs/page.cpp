@@ -12,15 +12,17 @@ BOOST_CLASS_EXPORT_IMPLEMENT(Page)
 #include "utils/find_all_if.h"
 
 Page::Page(const int x, const int y, const int width, const int height)
-    : GlyphContainer(x, y, width, height) {
+    : GlyphContainer(x, y, width, height, kKind) {
     Glyph::GlyphPtr firstColumnPtr =
         std::make_shared<Column>(Column(x, y, width, height));
     Add(firstColumnPtr);
 }
 
 Glyph::GlyphList Page::Select(const Glyph::GlyphPtr& area) {
+    Range<GlyphVector::iterator> candidates =
+        GetComponentsOnAxis(area, HORIZONTAL);
     auto intersectedColumns = find_all_if(
-        components.begin(), components.end(),
+        candidates.begin(), candidates.end(),
         [&](const auto& component) { return component->Intersects(area); });
 
     Glyph::GlyphList list;
@@ -34,9 +36,7 @@ Glyph::GlyphList Page::Select(const Glyph::GlyphPtr& area) {
 }
 
 void Page::Insert(GlyphPtr& glyph) {
-    auto intersectedGlyphIt = std::find_if(
-        components.begin(), components.end(),
-        [&](const auto& component) { return component->Intersects(glyph); });
+    auto intersectedGlyphIt = FindIntersectingComponent(glyph, HORIZONTAL);
     assert((intersectedGlyphIt != components.end()) &&
            "No suitable column for inserting");
 
@@ -45,15 +45,13 @@ void Page::Insert(GlyphPtr& glyph) {
 
 void Page::Remove(const GlyphPtr& glyph) {
     assert(glyph != nullptr && "Cannot remove glyph by nullptr");
-    auto it = std::find(components.begin(), components.end(), glyph);
+    auto it = FindComponent(glyph);
     if (it != components.end()) {
-        if (it != components.begin()) components.erase(it);
+        if (it != components.begin()) EraseComponent(it);
         return;
     }
 
-    auto intersectedGlyphIt = std::find_if(
-        components.begin(), components.end(),
-        [&](const auto& component) { return component->Intersects(glyph); });
+    auto intersectedGlyphIt = FindIntersectingComponent(glyph, HORIZONTAL);
     assert(intersectedGlyphIt != components.end() &&
            "No suitable column for removing");
 
@@ -62,7 +60,8 @@ void Page::Remove(const GlyphPtr& glyph) {
 
 size_t Page::GetColumnsCount() { return components.size(); }
 
+void Page::Accept(GlyphVisitor& visitor) { visitor.VisitPage(*this); }
+
 std::shared_ptr<Glyph> Page::Clone() const {
-    Page* copy = new Page(this->x, this->y, this->width, this->height);
-    return std::make_shared<Page>(*copy);
+    return std::make_shared<Page>(*this);
 }
\ No newline at end of file
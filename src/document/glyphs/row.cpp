@@ -9,11 +9,13 @@ BOOST_CLASS_EXPORT_IMPLEMENT(Row)
 #include "utils/find_all_if.h"
 
 Row::Row(const int x, const int y, const int width, const int height)
-    : GlyphContainer(x, y, width, height) {}
+    : GlyphContainer(x, y, width, height, kKind) {}
 
 Glyph::GlyphList Row::Select(const Glyph::GlyphPtr& area) {
+    Range<GlyphVector::iterator> candidates =
+        GetComponentsOnAxis(area, HORIZONTAL);
     auto intersectedCharacters = find_all_if(
-        components.begin(), components.end(),
+        candidates.begin(), candidates.end(),
         [&](const auto& component) { return component->Intersects(area); });
 
     Glyph::GlyphList list;
@@ -26,17 +28,11 @@ Glyph::GlyphList Row::Select(const Glyph::GlyphPtr& area) {
 
 void Row::Insert(GlyphPtr& glyph) {
     if (components.empty()) {
-        components.push_back(glyph);
-        usedWidth += glyph->GetWidth();
-        if (glyph->GetHeight() > this->height) {
-            this->height = glyph->GetHeight();
-        }
+        Add(glyph);
         return;
     }
 
-    auto intersectedGlyphIt = std::find_if(
-        components.begin(), components.end(),
-        [&](const auto& component) { return component->Intersects(glyph); });
+    auto intersectedGlyphIt = FindIntersectingComponent(glyph, HORIZONTAL);
 
     assert(intersectedGlyphIt != components.end() &&
            "No suitable character for inserting next to");
@@ -50,16 +46,67 @@ void Row::Insert(GlyphPtr& glyph) {
         ++intersectedGlyphIt;
     }
 
-    components.insert(intersectedGlyphIt, glyph);
+    InsertComponent(intersectedGlyphIt, glyph);
+    usedWidth += glyph->GetWidth();
+    if (glyph->GetHeight() > GetHeight()) {
+        SetHeight(glyph->GetHeight());
+    }
+}
+
+void Row::InsertAfter(const GlyphPtr& glyph, const GlyphPtr& previous) {
+    InsertAfter(GlyphVector{glyph}, previous);
+}
+
+void Row::InsertAfter(const GlyphVector& glyphs, const GlyphPtr& previous) {
+    auto position = components.begin();
+    int x = GetPosition().x;
+    if (previous != nullptr) {
+        position = FindComponent(previous);
+        assert(position != components.end() &&
+               "No such glyph to insert after");
+        ++position;
+        x = previous->GetRightBorder();
+    }
+    int insertedWidth = 0;
+    for (const auto& glyph : glyphs) {
+        glyph->SetPosition(x + insertedWidth, GetPosition().y);
+        insertedWidth += glyph->GetWidth();
+        if (glyph->GetHeight() > GetHeight()) {
+            SetHeight(glyph->GetHeight());
+        }
+    }
+
+    position = InsertComponents(position, glyphs);
+    for (position += glyphs.size(); position != components.end(); ++position) {
+        (*position)->SetPosition((*position)->GetPosition().x + insertedWidth,
+                                 (*position)->GetPosition().y);
+    }
+    usedWidth += insertedWidth;
+}
+
+void Row::Add(GlyphPtr glyph) {
     usedWidth += glyph->GetWidth();
-    if (glyph->GetHeight() > this->height) {
-        this->height = glyph->GetHeight();
+    if (glyph->GetHeight() > GetHeight()) {
+        SetHeight(glyph->GetHeight());
+    }
+    GlyphContainer::Add(std::move(glyph));
+}
+
+void Row::Add(const GlyphVector& glyphs) {
+    int maxHeight = GetHeight();
+    for (const auto& glyph : glyphs) {
+        usedWidth += glyph->GetWidth();
+        maxHeight = std::max(maxHeight, glyph->GetHeight());
+    }
+    if (maxHeight > GetHeight()) {
+        SetHeight(maxHeight);
     }
+    InsertComponents(components.end(), glyphs);
 }
 
 void Row::Remove(const GlyphPtr& ptr) {
     assert(ptr != nullptr && "Cannot remove glyph by nullptr");
-    auto it = std::find(components.begin(), components.end(), ptr);
+    auto it = FindComponent(ptr);
 
     if (it == components.end()) {
         it = find_if(
@@ -71,15 +118,28 @@ void Row::Remove(const GlyphPtr& ptr) {
     assert(it != components.end() && "No suitable character for removing");
 
     usedWidth -= (*it)->GetWidth();
-    components.erase(it);
+    EraseComponent(it);
+}
+
+void Row::Remove(const GlyphPtr& first, const GlyphPtr& last) {
+    auto begin = FindComponent(first);
+    auto end = FindComponent(last);
+    assert(begin != components.end() && end != components.end() &&
+           begin <= end && "No such glyphs to remove");
+    ++end;
+    for (auto it = begin; it != end; ++it) {
+        usedWidth -= (*it)->GetWidth();
+    }
+    EraseComponents(begin, end);
 }
 
 bool Row::IsEmpty() const { return components.empty(); }
-bool Row::IsFull() const { return usedWidth >= width; }
-int Row::GetFreeSpace() const { return width - usedWidth; }
+bool Row::IsFull() const { return usedWidth >= GetWidth(); }
+int Row::GetFreeSpace() const { return GetWidth() - usedWidth; }
 int Row::GetUsedSpace() const { return usedWidth; }
 
+void Row::Accept(GlyphVisitor& visitor) { visitor.VisitRow(*this); }
+
 std::shared_ptr<Glyph> Row::Clone() const {
-    Row* copy = new Row(this->x, this->y, this->width, this->height);
-    return std::make_shared<Row>(*copy);
+    return std::make_shared<Row>(*this);
 }
\ No newline at end of file
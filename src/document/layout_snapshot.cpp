@@ -0,0 +1,40 @@
+#include "document/layout_snapshot.h"
+
+#include <algorithm>
+
+void LayoutSnapshot::Draw(Renderer& renderer, const Cursor& cursor) const {
+    // the cursor is drawn after the character before it, before the character
+    // after it if it keeps to the next row, or at the beginning of the first
+    // row
+    size_t count = GetCharactersCount();
+    size_t cursorOffset = std::min(cursor.offset, count);
+    bool isBefore =
+        cursor.affinity == Cursor::DOWNSTREAM && cursorOffset < count;
+    size_t cursorCharacter = isBefore ? cursorOffset : cursorOffset - 1;
+    renderer.Clear();
+    size_t offset = 0;
+    for (size_t index = 0; index < pages.size(); ++index) {
+        const PageLayout& page = *pages[index];
+        renderer.DrawPage(page.width, page.height);
+        for (const CharacterBox& box : page.characters) {
+            renderer.DrawChar(box.symbol, box.rect.x, box.rect.y,
+                              box.rect.width, box.rect.height);
+            if (offset++ == cursorCharacter) {
+                int x = isBefore ? box.rect.x : box.rect.GetRightBorder();
+                renderer.DrawCursor(x, box.rect.y, box.rect.height);
+            }
+        }
+        if (index == 0 && cursorOffset == 0 && !isBefore) {
+            renderer.DrawCursor(firstRow.x, firstRow.y, firstRow.height);
+        }
+    }
+    renderer.Present();
+}
+
+size_t LayoutSnapshot::GetCharactersCount() const {
+    size_t count = 0;
+    for (const PageLayoutPtr& page : pages) {
+        count += page->characters.size();
+    }
+    return count;
+}
@@ -0,0 +1,68 @@
+#include "document/memory_pool.h"
+
+#include <cassert>
+#include <new>
+
+MemoryPool::MemoryPool(size_t slabSize)
+    : slabSize(slabSize), freeLists(kMaxBlockSize / kAlignment, nullptr) {
+    assert(slabSize >= kMaxBlockSize && "Slab is smaller than a block");
+}
+
+void* MemoryPool::Allocate(size_t size) {
+    if (size > kMaxBlockSize) {
+        return ::operator new(size);
+    }
+
+    size_t sizeClass = GetSizeClass(size);
+    std::lock_guard<std::mutex> lock(mutex);
+    ++usedBlocksCount;
+    FreeBlock* block = freeLists[sizeClass];
+    if (block != nullptr) {
+        freeLists[sizeClass] = block->next;
+        return block;
+    }
+
+    size_t blockSize = (sizeClass + 1) * kAlignment;
+    if (slabRemainder < blockSize) {
+        // the rest of the current slab is smaller than any request of this
+        // size class, so it stays unused
+        slabs.emplace_back(new char[slabSize]);
+        slabPosition = slabs.back().get();
+        slabRemainder = slabSize;
+    }
+    void* pointer = slabPosition;
+    slabPosition += blockSize;
+    slabRemainder -= blockSize;
+    return pointer;
+}
+
+void MemoryPool::Deallocate(void* pointer, size_t size) {
+    if (pointer == nullptr) {
+        return;
+    }
+    if (size > kMaxBlockSize) {
+        ::operator delete(pointer);
+        return;
+    }
+
+    size_t sizeClass = GetSizeClass(size);
+    std::lock_guard<std::mutex> lock(mutex);
+    --usedBlocksCount;
+    FreeBlock* block = static_cast<FreeBlock*>(pointer);
+    block->next = freeLists[sizeClass];
+    freeLists[sizeClass] = block;
+}
+
+size_t MemoryPool::GetReservedSize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return slabs.size() * slabSize;
+}
+
+size_t MemoryPool::GetUsedBlocksCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return usedBlocksCount;
+}
+
+size_t MemoryPool::GetSizeClass(size_t size) {
+    return size == 0 ? 0 : (size - 1) / kAlignment;
+}
@@ -0,0 +1,350 @@
+#include "document/text_buffer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+TextBuffer::TextBuffer() {}
+
+TextBuffer::TextBuffer(std::string original) {
+    auto text = std::make_shared<const std::string>(std::move(original));
+    // the pointer shares ownership of the string
+    *this = TextBuffer(std::shared_ptr<const char>(text, text->data()),
+                       text->size());
+}
+
+TextBuffer::TextBuffer(std::shared_ptr<const char> original, size_t length)
+    : original(std::move(original)) {
+    if (length != 0) {
+        root = MakeNode({this->original.get(), length, 0, 0}, NextPriority(),
+                        nullptr, nullptr);
+    }
+}
+
+TextBuffer::TextBuffer(const TextBuffer& other)
+    : original(other.original),
+      chunk(other.chunk),
+      chunkLength(other.chunkLength),
+      root(other.root),
+      seed(other.seed) {}
+
+TextBuffer& TextBuffer::operator=(const TextBuffer& other) {
+    if (this != &other) {
+        original = other.original;
+        chunk = other.chunk;
+        chunkLength = other.chunkLength;
+        isChunkOwner = false;
+        root = other.root;
+        seed = other.seed;
+    }
+    return *this;
+}
+
+TextBuffer::Chunk::~Chunk() {
+    // the list is released iteratively, so a long one doesn't overflow the
+    // stack
+    std::shared_ptr<Chunk> next = std::move(previous);
+    while (next != nullptr && next.use_count() == 1) {
+        next = std::move(next->previous);
+    }
+}
+
+void TextBuffer::Insert(size_t offset, const char* text, size_t length,
+                        int width, int height) {
+    assert(offset <= GetLength() && "Invalid offset in text");
+    if (length == 0) {
+        return;
+    }
+
+    Piece piece = {Append(text, length), length, width, height};
+    NodePtr left, right;
+    Split(root, offset, left, right);
+
+    // typing appends to the last inserted piece instead of adding a new one;
+    // a piece can't end right before the beginning of a chunk
+    NodePtr extended;
+    if (left != nullptr && piece.data != chunk->data.get()) {
+        extended = ExtendLastPiece(left, piece);
+    }
+    if (extended == nullptr) {
+        extended = Merge(left, MakeNode(piece, NextPriority(), nullptr,
+                                        nullptr));
+    }
+    root = Merge(extended, right);
+}
+
+void TextBuffer::Insert(size_t offset, const char* text, size_t length) {
+    Insert(offset, text, length, 0, 0);
+}
+
+void TextBuffer::Insert(size_t offset, const std::string& text) {
+    Insert(offset, text.data(), text.size());
+}
+
+void TextBuffer::Insert(size_t offset, char symbol) {
+    Insert(offset, &symbol, 1);
+}
+
+void TextBuffer::Remove(size_t offset, size_t length) {
+    assert(offset + length <= GetLength() && "Invalid range in text");
+    if (length == 0) {
+        return;
+    }
+
+    NodePtr left, middle, right;
+    Split(root, offset, left, right);
+    Split(right, length, middle, right);
+    root = Merge(left, right);
+}
+
+void TextBuffer::SetSize(size_t offset, size_t length, int width,
+                         int height) {
+    assert(offset + length <= GetLength() && "Invalid range in text");
+    if (length == 0) {
+        return;
+    }
+
+    NodePtr left, middle, right;
+    Split(root, offset, left, right);
+    Split(right, length, middle, right);
+    root = Merge(Merge(left, Resize(middle, width, height)), right);
+}
+
+void TextBuffer::SetSizes(const std::vector<CharacterRun>& runs) {
+    size_t offset = 0;
+    for (const CharacterRun& run : runs) {
+        SetSize(offset, run.count, run.width, run.height);
+        offset += run.count;
+    }
+}
+
+char TextBuffer::GetChar(size_t offset) const {
+    assert(offset < GetLength() && "Invalid offset in text");
+    const Node* node = root.get();
+    while (true) {
+        size_t leftLength = GetLength(node->left);
+        if (offset < leftLength) {
+            node = node->left.get();
+        } else if (offset < leftLength + node->piece.length) {
+            return node->piece.data[offset - leftLength];
+        } else {
+            offset -= leftLength + node->piece.length;
+            node = node->right.get();
+        }
+    }
+}
+
+std::string TextBuffer::GetText() const { return GetText(0, GetLength()); }
+
+std::string TextBuffer::GetText(size_t offset, size_t length) const {
+    assert(offset + length <= GetLength() && "Invalid range in text");
+    std::string text;
+    text.reserve(length);
+    auto append = [&](const Piece& piece, size_t begin, size_t end) {
+        text.append(piece.data + begin, end - begin);
+    };
+    ForEachPiece(offset, length, append);
+    return text;
+}
+
+std::vector<CharacterRun> TextBuffer::GetRuns() const {
+    return GetRuns(0, GetLength());
+}
+
+std::vector<CharacterRun> TextBuffer::GetRuns(size_t offset,
+                                              size_t length) const {
+    assert(offset + length <= GetLength() && "Invalid range in text");
+    std::vector<CharacterRun> runs;
+    auto append = [&](const Piece& piece, size_t begin, size_t end) {
+        // neighbouring pieces of the same size make a single run
+        if (runs.empty() || runs.back().width != piece.width ||
+            runs.back().height != piece.height) {
+            runs.push_back({0, piece.width, piece.height});
+        }
+        runs.back().count += end - begin;
+    };
+    ForEachPiece(offset, length, append);
+    return runs;
+}
+
+bool TextBuffer::Write(std::ostream& os) const {
+    auto write = [&](const Piece& piece, size_t begin, size_t end) {
+        os.write(piece.data + begin, end - begin);
+    };
+    ForEachPiece(0, GetLength(), write);
+    return bool(os);
+}
+
+size_t TextBuffer::GetLength() const { return GetLength(root); }
+
+size_t TextBuffer::GetPiecesCount() const {
+    size_t count = 0;
+    auto counter = [&](const Piece&, size_t, size_t) { ++count; };
+    ForEachPiece(0, GetLength(), counter);
+    return count;
+}
+
+void TextBuffer::Clear() { *this = TextBuffer(); }
+
+const char* TextBuffer::Append(const char* text, size_t length) {
+    if (!isChunkOwner || chunk == nullptr ||
+        chunk->capacity - chunkLength < length) {
+        std::shared_ptr<Chunk> next = std::make_shared<Chunk>();
+        next->capacity = length > kChunkSize ? length : kChunkSize;
+        next->data.reset(new char[next->capacity]);
+        next->previous = std::move(chunk);
+        chunk = std::move(next);
+        chunkLength = 0;
+        isChunkOwner = true;
+    }
+    // the characters are written after the ones the pieces refer to, so the
+    // copies of the buffer may read the chunk meanwhile
+    char* data = chunk->data.get() + chunkLength;
+    std::copy(text, text + length, data);
+    chunkLength += length;
+    return data;
+}
+
+uint32_t TextBuffer::NextPriority() {
+    // xorshift32
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+TextBuffer::NodePtr TextBuffer::MakeNode(const Piece& piece, uint32_t priority,
+                                         NodePtr left, NodePtr right) {
+    size_t length = GetLength(left) + piece.length + GetLength(right);
+    return std::make_shared<const Node>(
+        Node{piece, length, priority, std::move(left), std::move(right)});
+}
+
+size_t TextBuffer::GetLength(const NodePtr& node) {
+    return node == nullptr ? 0 : node->length;
+}
+
+TextBuffer::NodePtr TextBuffer::Merge(const NodePtr& left,
+                                      const NodePtr& right) {
+    if (left == nullptr) {
+        return right;
+    }
+    if (right == nullptr) {
+        return left;
+    }
+    if (left->priority > right->priority) {
+        return MakeNode(left->piece, left->priority, left->left,
+                        Merge(left->right, right));
+    }
+    return MakeNode(right->piece, right->priority, Merge(left, right->left),
+                    right->right);
+}
+
+void TextBuffer::Split(NodePtr node, size_t offset, NodePtr& left,
+                       NodePtr& right) {
+    // the tree is left as it is if nothing is cut off
+    if (node == nullptr || offset == 0) {
+        left = nullptr;
+        right = std::move(node);
+        return;
+    }
+    if (offset >= node->length) {
+        left = std::move(node);
+        right = nullptr;
+        return;
+    }
+
+    size_t leftLength = GetLength(node->left);
+    if (offset <= leftLength) {
+        NodePtr subtree;
+        Split(node->left, offset, left, subtree);
+        right = MakeNode(node->piece, node->priority, std::move(subtree),
+                         node->right);
+    } else if (offset >= leftLength + node->piece.length) {
+        NodePtr subtree;
+        Split(node->right, offset - leftLength - node->piece.length, subtree,
+              right);
+        left = MakeNode(node->piece, node->priority, node->left,
+                        std::move(subtree));
+    } else {
+        // the piece crosses the offset, so its tail becomes a new piece
+        size_t headLength = offset - leftLength;
+        Piece head = node->piece;
+        head.length = headLength;
+        Piece tail = node->piece;
+        tail.data += headLength;
+        tail.length -= headLength;
+
+        left = MakeNode(head, node->priority, node->left, nullptr);
+        right = Merge(MakeNode(tail, NextPriority(), nullptr, nullptr),
+                      node->right);
+    }
+}
+
+TextBuffer::NodePtr TextBuffer::ExtendLastPiece(const NodePtr& node,
+                                                const Piece& piece) {
+    if (node->right != nullptr) {
+        NodePtr right = ExtendLastPiece(node->right, piece);
+        if (right == nullptr) {
+            return nullptr;
+        }
+        return MakeNode(node->piece, node->priority, node->left,
+                        std::move(right));
+    }
+    const Piece& last = node->piece;
+    if (last.data + last.length != piece.data || last.width != piece.width ||
+        last.height != piece.height) {
+        return nullptr;
+    }
+    Piece extended = last;
+    extended.length += piece.length;
+    return MakeNode(extended, node->priority, node->left, nullptr);
+}
+
+TextBuffer::NodePtr TextBuffer::Resize(const NodePtr& node, int width,
+                                       int height) {
+    if (node == nullptr) {
+        return nullptr;
+    }
+    Piece piece = node->piece;
+    piece.width = width;
+    piece.height = height;
+    return MakeNode(piece, node->priority, Resize(node->left, width, height),
+                    Resize(node->right, width, height));
+}
+
+template <class Function>
+void TextBuffer::ForEachPiece(size_t offset, size_t length,
+                              Function& function) const {
+    size_t end = offset + length;
+    // in-order traversal without recursion that enters only the subtrees
+    // overlapping the range, each node is kept with the offset of its subtree
+    std::vector<std::pair<const Node*, size_t>> stack;
+    const Node* node = length > 0 ? root.get() : nullptr;
+    size_t start = 0;
+    while (node != nullptr || !stack.empty()) {
+        while (node != nullptr) {
+            stack.emplace_back(node, start);
+            node = offset < start + GetLength(node->left) ? node->left.get()
+                                                           : nullptr;
+        }
+        node = stack.back().first;
+        size_t pieceStart = stack.back().second + GetLength(node->left);
+        stack.pop_back();
+        size_t pieceEnd = pieceStart + node->piece.length;
+        if (pieceStart >= end) {
+            return;
+        }
+        if (pieceEnd > offset) {
+            function(node->piece, std::max(offset, pieceStart) - pieceStart,
+                     std::min(end, pieceEnd) - pieceStart);
+        }
+        if (pieceEnd < end) {
+            node = node->right.get();
+            start = pieceEnd;
+        } else {
+            return;
+        }
+    }
+}
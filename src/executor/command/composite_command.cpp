@@ -0,0 +1,45 @@
+#include "executor/command/composite_command.h"
+
+#include <utility>
+
+CompositeCommand::CompositeCommand(std::shared_ptr<IDocument> doc)
+    : doc(std::move(doc))
+{}
+
+void CompositeCommand::Add(std::shared_ptr<Command> command) {
+    if (commands.empty() || !commands.back()->Merge(*command)) {
+        commands.push_back(std::move(command));
+    }
+}
+
+bool CompositeCommand::IsEmpty() const { return commands.empty(); }
+
+void CompositeCommand::Execute() {
+    doc->BeginBatch();
+    for (auto& command : commands) {
+        command->Execute();
+    }
+    doc->EndBatch();
+}
+
+void CompositeCommand::Unexecute() {
+    doc->BeginBatch();
+    for (auto it = commands.rbegin(); it != commands.rend(); ++it) {
+        auto reversible = std::dynamic_pointer_cast<ReversibleCommand>(*it);
+        if (reversible) {
+            reversible->Unexecute();
+        }
+    }
+    doc->EndBatch();
+}
+
+std::size_t CompositeCommand::GetSize() const {
+    std::size_t size = sizeof(*this) +
+                       commands.capacity() * sizeof(std::shared_ptr<Command>);
+    for (const auto& command : commands) {
+        size += command->GetSize();
+    }
+    return size;
+}
+
+CompositeCommand::~CompositeCommand() {}
\ No newline at end of file
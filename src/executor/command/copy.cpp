@@ -8,4 +8,12 @@ void Copy::Execute(){
     doc->SelectGlyphs(from, to);
 }
 
+JournalRecord Copy::GetRecord() const {
+    JournalRecord record;
+    record.type = JournalRecord::COPY;
+    record.start = from;
+    record.end = to;
+    return record;
+}
+
 Copy::~Copy() {}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#include "executor/command/cut.h"
+
+Cut::Cut(std::shared_ptr<IDocument> doc, const Point& from, const Point& to):
+ doc(doc),from(from), to(to)
+{}
+
+void Cut::Execute(){
+    doc->CutGlyphs(from, to);
+}
+
+JournalRecord Cut::GetRecord() const {
+    JournalRecord record;
+    record.type = JournalRecord::CUT;
+    record.start = from;
+    record.end = to;
+    return record;
+}
+
+Cut::~Cut() {}
\ No newline at end of file
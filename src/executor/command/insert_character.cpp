@@ -1,5 +1,6 @@
 #include "executor/command/insert_character.h"
 
+#include <cctype>
 #include <utility>
 
 #include "document/glyphs/character.h"
@@ -9,8 +10,51 @@ InsertCharacter::InsertCharacter(std::shared_ptr<IDocument> doc, char symbol)
       character(symbol)
 {}
 
-void InsertCharacter::Execute() { doc->InsertChar(character); }
+void InsertCharacter::Execute() {
+    if (isExecuted) {
+        doc->SetCursorOffset(offset);
+    } else {
+        offset = doc->GetCursorOffset();
+        isExecuted = true;
+    }
+    doc->InsertChar(character);
+    for (char symbol : appended) {
+        doc->InsertChar(symbol);
+    }
+}
 
-void InsertCharacter::Unexecute() { (void) doc->RemoveChar(); }
+void InsertCharacter::Unexecute() {
+    // the characters are found by the offset wherever the cursor is
+    (void) doc->RemoveRange(offset, offset + 1 + appended.size());
+}
+
+std::size_t InsertCharacter::GetSize() const {
+    return sizeof(*this) + appended.capacity();
+}
+
+bool InsertCharacter::Merge(const Command& next) {
+    auto insert = dynamic_cast<const InsertCharacter*>(&next);
+    if (insert == nullptr || insert->doc != doc ||
+        !insert->appended.empty() ||
+        insert->offset != offset + 1 + appended.size()) {
+        return false;
+    }
+    // typing is grouped by words, a word ends with the spaces after it
+    char last = appended.empty() ? character : appended.back();
+    if (std::isspace(static_cast<unsigned char>(last)) &&
+        !std::isspace(static_cast<unsigned char>(insert->character))) {
+        return false;
+    }
+    appended.push_back(insert->character);
+    return true;
+}
+
+JournalRecord InsertCharacter::GetRecord() const {
+    JournalRecord record;
+    record.type = JournalRecord::INSERT_CHAR;
+    record.offset = offset;
+    record.symbol = character;
+    return record;
+}
 
 InsertCharacter::~InsertCharacter() {}
\ No newline at end of file
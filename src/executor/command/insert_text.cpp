@@ -0,0 +1,36 @@
+#include "executor/command/insert_text.h"
+
+#include <utility>
+
+InsertText::InsertText(std::shared_ptr<IDocument> doc, std::string text)
+    : doc(std::move(doc)),
+      text(std::move(text))
+{}
+
+void InsertText::Execute() {
+    if (isExecuted) {
+        doc->SetCursorOffset(offset);
+    } else {
+        offset = doc->GetCursorOffset();
+        isExecuted = true;
+    }
+    doc->InsertText(text);
+}
+
+void InsertText::Unexecute() {
+    (void) doc->RemoveRange(offset, offset + text.size());
+}
+
+std::size_t InsertText::GetSize() const {
+    return sizeof(*this) + text.capacity();
+}
+
+JournalRecord InsertText::GetRecord() const {
+    JournalRecord record;
+    record.type = JournalRecord::INSERT_TEXT;
+    record.offset = offset;
+    record.text = text;
+    return record;
+}
+
+InsertText::~InsertText() {}
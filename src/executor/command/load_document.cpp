@@ -1,21 +1,26 @@
 #include "executor/command/load_document.h"
 
-#include <fstream>
-#include <boost/archive/text_iarchive.hpp>
-#include <boost/archive/text_oarchive.hpp>
+#include "document/document_format.h"
 
 LoadDocument::LoadDocument(std::shared_ptr<IDocument>* doc, std::string path):
         doc(doc), path(std::move(path)) {}
 
 void LoadDocument::Execute()
 {
-    IDocument* document;
+    // pages are composed when they are shown
+    std::shared_ptr<Document> loaded = DocumentFormat::Map(path);
+    // the current document is kept if the file cannot be read
+    if (loaded == nullptr) {
+        return;
+    }
 
-    std::ifstream ofs(path);
-    boost::archive::text_iarchive ia(ofs);
-    ia >> document;
+    // the loaded document is shown on the same device
+    auto previous = std::dynamic_pointer_cast<Document>(*doc);
+    if (previous != nullptr) {
+        loaded->SetRenderer(previous->GetRenderer());
+    }
 
-    doc->reset(document);
+    *doc = loaded;
 }
 
-LoadDocument::~LoadDocument() = default;
\ No newline at end of file
+LoadDocument::~LoadDocument() = default;
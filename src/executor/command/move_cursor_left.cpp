@@ -3,7 +3,15 @@
 MoveCursorLeft::MoveCursorLeft(std::shared_ptr<IDocument> doc): doc(doc){}
 
 void MoveCursorLeft::Execute() {
+    offset = doc->GetCursorOffset();
     doc->MoveCursorLeft();
 }
 
+JournalRecord MoveCursorLeft::GetRecord() const {
+    JournalRecord record;
+    record.type = JournalRecord::MOVE_CURSOR_LEFT;
+    record.offset = offset;
+    return record;
+}
+
 MoveCursorLeft::~MoveCursorLeft() = default;
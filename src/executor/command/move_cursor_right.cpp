@@ -3,7 +3,15 @@
 MoveCursorRight::MoveCursorRight(std::shared_ptr<IDocument> doc): doc(doc){}
 
 void MoveCursorRight::Execute() {
+    offset = doc->GetCursorOffset();
     doc->MoveCursorRight();
 }
 
+JournalRecord MoveCursorRight::GetRecord() const {
+    JournalRecord record;
+    record.type = JournalRecord::MOVE_CURSOR_RIGHT;
+    record.offset = offset;
+    return record;
+}
+
 MoveCursorRight::~MoveCursorRight() = default;
@@ -8,9 +8,24 @@ void Paste::Execute(){
 }
 
 void Paste::Unexecute(){
+    doc->BeginBatch();
     for(auto gl : pasted_glyphs){
         doc->Remove(gl);
     }
+    doc->EndBatch();
+}
+
+JournalRecord Paste::GetRecord() const {
+    JournalRecord record;
+    record.type = JournalRecord::PASTE;
+    record.start = begin_with;
+    return record;
+}
+
+std::size_t Paste::GetSize() const {
+    // nodes of the list, the glyphs are owned by the document
+    return sizeof(*this) + pasted_glyphs.size() *
+                               (sizeof(Glyph::GlyphPtr) + 2 * sizeof(void*));
 }
 
 Paste::~Paste(){}
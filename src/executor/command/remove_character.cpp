@@ -1,5 +1,6 @@
 #include "executor/command/remove_character.h"
 
+#include <cctype>
 #include <utility>
 
 #include "document/glyphs/character.h"
@@ -8,8 +9,57 @@ RemoveCharacter::RemoveCharacter(std::shared_ptr<IDocument> doc)
     : doc(std::move(doc))
 {}
 
-void RemoveCharacter::Execute() { character = doc->RemoveChar(); }
+void RemoveCharacter::Execute() {
+    if (isExecuted) {
+        doc->SetCursorOffset(offset);
+    } else {
+        offset = doc->GetCursorOffset();
+        isExecuted = true;
+    }
+    character = doc->RemoveChar();
+    for (char& symbol : appended) {
+        symbol = doc->RemoveChar();
+    }
+}
 
-void RemoveCharacter::Unexecute() { doc->InsertChar(character); }
+void RemoveCharacter::Unexecute() {
+    // nothing has been removed in the beginning of the document
+    if (offset == 0) {
+        return;
+    }
+    // the characters are put back in the document order before the offset
+    std::string removed(appended.rbegin(), appended.rend());
+    removed.push_back(character);
+    doc->SetCursorOffset(offset - removed.size());
+    doc->InsertText(removed);
+}
+
+std::size_t RemoveCharacter::GetSize() const {
+    return sizeof(*this) + appended.capacity();
+}
+
+bool RemoveCharacter::Merge(const Command& next) {
+    auto remove = dynamic_cast<const RemoveCharacter*>(&next);
+    if (remove == nullptr || remove->doc != doc ||
+        !remove->appended.empty() || remove->offset == 0 ||
+        remove->offset + 1 + appended.size() != offset) {
+        return false;
+    }
+    // characters removed one by one are grouped by words like typed ones
+    char last = appended.empty() ? character : appended.back();
+    if (std::isspace(static_cast<unsigned char>(last)) &&
+        !std::isspace(static_cast<unsigned char>(remove->character))) {
+        return false;
+    }
+    appended.push_back(remove->character);
+    return true;
+}
+
+JournalRecord RemoveCharacter::GetRecord() const {
+    JournalRecord record;
+    record.type = JournalRecord::REMOVE_CHAR;
+    record.offset = offset;
+    return record;
+}
 
 RemoveCharacter::~RemoveCharacter() {}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#include "executor/command/remove_range.h"
+
+#include <utility>
+
+RemoveRange::RemoveRange(std::shared_ptr<IDocument> doc, std::size_t begin,
+                         std::size_t end)
+    : doc(std::move(doc)),
+      begin(begin),
+      end(end)
+{}
+
+void RemoveRange::Execute() {
+    removed = doc->RemoveRange(begin, end);
+}
+
+void RemoveRange::Unexecute() {
+    doc->SetCursorOffset(begin);
+    doc->InsertText(removed);
+}
+
+std::size_t RemoveRange::GetSize() const {
+    return sizeof(*this) + removed.capacity();
+}
+
+JournalRecord RemoveRange::GetRecord() const {
+    JournalRecord record;
+    record.type = JournalRecord::REMOVE_RANGE;
+    record.rangeBegin = begin;
+    record.rangeEnd = end;
+    return record;
+}
+
+RemoveRange::~RemoveRange() {}
@@ -1,17 +1,20 @@
 #include "executor/command/save_document.h"
 
-#include <fstream>
-#include <boost/archive/text_iarchive.hpp>
-#include <boost/archive/text_oarchive.hpp>
+#include <cassert>
+
+#include "document/document_format.h"
 
 SaveDocument::SaveDocument(const std::shared_ptr<IDocument> doc, std::string path):
     doc(doc), path(std::move(path)) {}
 
 void SaveDocument::Execute()
 {
-    std::ofstream ofs(path);
-    boost::archive::text_oarchive oa(ofs);
-    oa << doc.get();
+    auto document = std::dynamic_pointer_cast<Document>(doc);
+    assert(document != nullptr && "Only a document can be saved");
+
+    // the text of a loaded document may still refer to the file, so the file
+    // is replaced rather than overwritten
+    DocumentFormat::Save(path, document->GetSnapshot());
 }
 
-SaveDocument::~SaveDocument() = default;
\ No newline at end of file
+SaveDocument::~SaveDocument() = default;
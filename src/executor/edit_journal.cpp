@@ -0,0 +1,419 @@
+#include "executor/edit_journal.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "document/document_format.h"
+#include "document/glyphs/character.h"
+#include "executor/command/copy.h"
+#include "executor/command/cut.h"
+#include "executor/command/insert_character.h"
+#include "executor/command/insert_text.h"
+#include "executor/command/move_cursor_left.h"
+#include "executor/command/move_cursor_right.h"
+#include "executor/command/paste.h"
+#include "executor/command/remove_character.h"
+#include "executor/command/remove_range.h"
+#include "executor/executor.h"
+#include "utils/binary_io.h"
+
+constexpr uint16_t EditJournal::kVersion;
+
+namespace {
+
+const char kMagic[4] = {'L', 'X', 'E', 'J'};
+// the worker writes the save of a checkpoint next to the previous one
+const char kCheckpointExtension[] = ".checkpoint";
+const char kTemporaryExtension[] = ".tmp";
+
+/*
+ * Takes place of a command that doesn't change the document, so the history
+ * of the replaying executor matches the original one.
+ */
+class NoOperation : public Command {
+   public:
+    void Execute() override {}
+};
+
+/**
+ * @brief           Calculates FNV-1a hash of the data.
+ */
+uint64_t Hash(const std::string& data) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char symbol : data) {
+        hash ^= static_cast<unsigned char>(symbol);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool ReadFile(const std::string& path, std::string& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    data = contents.str();
+    return true;
+}
+
+bool WriteFile(const std::string& path, const std::string& data) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    return file.write(data.data(), data.size()) && file.flush();
+}
+
+/**
+ * @brief           Reads the header of the journal and its clipboard size.
+ * @return          Whether the journal belongs to the save with the hash.
+ */
+bool ReadHeader(BinaryReader& reader, uint64_t saveHash,
+                uint32_t& clipboardSize) {
+    const char* magic = reader.Skip(sizeof(kMagic));
+    uint16_t version, reserved;
+    uint64_t hash;
+    return magic != nullptr &&
+           std::equal(magic, magic + sizeof(kMagic), kMagic) &&
+           reader.Read(version) && version == EditJournal::kVersion &&
+           reader.Read(reserved) && reader.Read(hash) && hash == saveHash &&
+           reader.Read(clipboardSize);
+}
+
+void WritePoint(BinaryWriter& writer, const Point& point) {
+    writer.Write(int32_t(point.x));
+    writer.Write(int32_t(point.y));
+}
+
+bool ReadPoint(BinaryReader& reader, Point& point) {
+    int32_t x, y;
+    if (!reader.Read(x) || !reader.Read(y)) {
+        return false;
+    }
+    point = Point(x, y);
+    return true;
+}
+
+/**
+ * @brief           Checks whether the command of the record is executed at
+ * the offset of the cursor.
+ */
+bool HasOffset(JournalRecord::Type type) {
+    return type == JournalRecord::INSERT_CHAR ||
+           type == JournalRecord::REMOVE_CHAR ||
+           type == JournalRecord::INSERT_TEXT ||
+           type == JournalRecord::MOVE_CURSOR_LEFT ||
+           type == JournalRecord::MOVE_CURSOR_RIGHT;
+}
+
+void WriteRecord(BinaryWriter& writer, const JournalRecord& record) {
+    writer.Write(uint8_t(record.type));
+    if (HasOffset(record.type)) {
+        writer.Write(record.offset);
+    }
+    switch (record.type) {
+        case JournalRecord::INSERT_CHAR:
+            writer.Write(record.symbol);
+            break;
+        case JournalRecord::COPY:
+        case JournalRecord::CUT:
+            WritePoint(writer, record.start);
+            WritePoint(writer, record.end);
+            break;
+        case JournalRecord::PASTE:
+            WritePoint(writer, record.start);
+            break;
+        case JournalRecord::INSERT_TEXT:
+            writer.Write(uint32_t(record.text.size()));
+            writer.WriteBytes(record.text.data(), record.text.size());
+            break;
+        case JournalRecord::REMOVE_RANGE:
+            writer.Write(record.rangeBegin);
+            writer.Write(record.rangeEnd);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @return          Whether a complete record has been read.
+ */
+bool ReadRecord(BinaryReader& reader, JournalRecord& record) {
+    uint8_t type;
+    if (!reader.Read(type) || type > JournalRecord::REMOVE_RANGE) {
+        return false;
+    }
+    record.type = JournalRecord::Type(type);
+    if (HasOffset(record.type) && !reader.Read(record.offset)) {
+        return false;
+    }
+    switch (record.type) {
+        case JournalRecord::INSERT_CHAR:
+            return reader.Read(record.symbol);
+        case JournalRecord::COPY:
+        case JournalRecord::CUT:
+            return ReadPoint(reader, record.start) &&
+                   ReadPoint(reader, record.end);
+        case JournalRecord::PASTE:
+            return ReadPoint(reader, record.start);
+        case JournalRecord::INSERT_TEXT: {
+            uint32_t length;
+            const char* text;
+            if (!reader.Read(length) ||
+                (text = reader.Skip(length)) == nullptr) {
+                return false;
+            }
+            record.text.assign(text, length);
+            return true;
+        }
+        case JournalRecord::REMOVE_RANGE:
+            return reader.Read(record.rangeBegin) &&
+                   reader.Read(record.rangeEnd);
+        default:
+            return true;
+    }
+}
+
+std::shared_ptr<Command> MakeCommand(const JournalRecord& record,
+                                     const std::shared_ptr<IDocument>& doc) {
+    switch (record.type) {
+        case JournalRecord::INSERT_CHAR:
+            return std::make_shared<InsertCharacter>(doc, record.symbol);
+        case JournalRecord::REMOVE_CHAR:
+            return std::make_shared<RemoveCharacter>(doc);
+        case JournalRecord::MOVE_CURSOR_LEFT:
+            return std::make_shared<MoveCursorLeft>(doc);
+        case JournalRecord::MOVE_CURSOR_RIGHT:
+            return std::make_shared<MoveCursorRight>(doc);
+        case JournalRecord::COPY:
+            return std::make_shared<Copy>(doc, record.start, record.end);
+        case JournalRecord::CUT:
+            return std::make_shared<Cut>(doc, record.start, record.end);
+        case JournalRecord::PASTE:
+            return std::make_shared<Paste>(doc, record.start);
+        case JournalRecord::INSERT_TEXT:
+            return std::make_shared<InsertText>(doc, record.text);
+        case JournalRecord::REMOVE_RANGE:
+            return std::make_shared<RemoveRange>(doc, record.rangeBegin,
+                                                 record.rangeEnd);
+        default:
+            return std::make_shared<NoOperation>();
+    }
+}
+
+}  // namespace
+
+EditJournal::EditJournal(std::string path, std::string savePath,
+                         std::shared_ptr<const Document> document,
+                         size_t checkpointInterval)
+    : path(std::move(path)),
+      savePath(std::move(savePath)),
+      document(std::move(document)),
+      checkpointInterval(checkpointInterval),
+      saver(this->savePath + kCheckpointExtension,
+            [this](uint64_t number, bool isWritten) {
+                CompleteCheckpoint(number, isWritten);
+            }) {
+    Checkpoint();
+}
+
+EditJournal::~EditJournal() { Flush(); }
+
+bool EditJournal::Append(const JournalRecord& record) {
+    BinaryWriter writer;
+    WriteRecord(writer, record);
+    std::ostringstream bytes(std::ios::binary);
+    writer.Flush(bytes);
+    std::string data = bytes.str();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++recordsCount;
+    if (pending != nullptr) {
+        pending->records += data;
+    }
+    if (!isFileComplete) {
+        return pending != nullptr;
+    }
+    return file.write(data.data(), data.size()) && file.flush();
+}
+
+void EditJournal::Checkpoint(bool isJournalComplete) {
+    // only characters can be pasted after the document is recovered
+    BinaryWriter writer;
+    std::vector<const Character*> clipboard;
+    for (const auto& glyph : document->GetSelectedGlyphs()) {
+        const Character* character = glyph->As<Character>();
+        if (character != nullptr) {
+            clipboard.push_back(character);
+        }
+    }
+    writer.Write(uint32_t(clipboard.size()));
+    for (const Character* character : clipboard) {
+        writer.Write(character->GetChar());
+        writer.Write(int32_t(character->GetWidth()));
+        writer.Write(int32_t(character->GetHeight()));
+    }
+    std::ostringstream bytes(std::ios::binary);
+    writer.Flush(bytes);
+
+    std::unique_ptr<PendingCheckpoint> replaced;
+    {
+        // the lock is held while the snapshot is scheduled, so the worker
+        // finds the checkpoint by its number
+        std::lock_guard<std::mutex> lock(mutex);
+        replaced = std::move(pending);
+        pending.reset(new PendingCheckpoint{0, bytes.str(), std::string()});
+        pending->number = saver.Save(*document);
+        isFileComplete = isFileComplete && isJournalComplete;
+        recordsCount = 0;
+    }
+}
+
+void EditJournal::Flush() { saver.Flush(); }
+
+bool EditJournal::IsCheckpointDue() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return recordsCount >= checkpointInterval ||
+           (!isFileComplete && pending == nullptr);
+}
+
+void EditJournal::CompleteCheckpoint(uint64_t number, bool isWritten) {
+    // the hash is calculated before the lock is taken, so the editing thread
+    // isn't stopped while the save is read
+    std::string checkpointPath = savePath + kCheckpointExtension;
+    std::string save;
+    bool isRead = isWritten && ReadFile(checkpointPath, save);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    // a newer checkpoint will replace the files
+    if (pending == nullptr || pending->number != number) {
+        return;
+    }
+    std::unique_ptr<PendingCheckpoint> checkpoint = std::move(pending);
+    if (!isRead) {
+        return;
+    }
+
+    BinaryWriter writer;
+    for (char symbol : kMagic) {
+        writer.Write(symbol);
+    }
+    writer.Write(kVersion);
+    writer.Write(uint16_t(0));
+    writer.Write(Hash(save));
+    std::ostringstream journal(std::ios::binary);
+    writer.Flush(journal);
+    journal << checkpoint->clipboard << checkpoint->records;
+
+    // the journal is written before the save is replaced, so Recover finds it
+    // in the temporary file if the save is replaced and the journal is not
+    std::string temporaryPath = path + kTemporaryExtension;
+    if (!WriteFile(temporaryPath, journal.str()) ||
+        std::rename(checkpointPath.c_str(), savePath.c_str()) != 0) {
+        std::remove(temporaryPath.c_str());
+        return;
+    }
+    file.close();
+    isFileComplete = std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+    file.clear();
+    file.open(path, std::ios::binary | std::ios::app);
+    isFileComplete = isFileComplete && file.is_open();
+}
+
+size_t EditJournal::GetRecordsCount() const { return recordsCount; }
+
+std::shared_ptr<Document> EditJournal::Recover(const std::string& path,
+                                               const std::string& savePath,
+                                               size_t historyLength) {
+    std::string save;
+    if (!ReadFile(savePath, save)) {
+        return nullptr;
+    }
+    std::istringstream is(save, std::ios::binary);
+    std::shared_ptr<Document> document = DocumentFormat::Read(is);
+    if (document == nullptr) {
+        return document;
+    }
+
+    // a checkpoint stopped after replacing the save has left its journal in
+    // the temporary file
+    uint64_t saveHash = Hash(save);
+    std::string journal;
+    BinaryReader reader(nullptr, 0);
+    uint32_t clipboardSize;
+    bool isFound = false;
+    for (const std::string& journalPath : {path, path + kTemporaryExtension}) {
+        if (ReadFile(journalPath, journal)) {
+            reader = BinaryReader(journal.data(), journal.size());
+            isFound = ReadHeader(reader, saveHash, clipboardSize);
+        }
+        if (isFound) {
+            break;
+        }
+    }
+    if (!isFound) {
+        return document;
+    }
+
+    GlyphContainer::GlyphList clipboard;
+    for (uint32_t i = 0; i < clipboardSize; ++i) {
+        char symbol;
+        int32_t width, height;
+        if (!reader.Read(symbol) || !reader.Read(width) ||
+            !reader.Read(height)) {
+            return document;
+        }
+        clipboard.push_back(
+            std::make_shared<Character>(0, 0, width, height, symbol));
+    }
+    document->SetSelectedGlyphs(std::move(clipboard));
+
+    // the history is bounded only by length, so it keeps every command the
+    // journal can undo whatever memory budget it has been written with
+    Executor executor(historyLength, std::numeric_limits<std::size_t>::max());
+    std::shared_ptr<IDocument> doc = document;
+    JournalRecord record;
+    bool isInTransaction = false;
+    while (ReadRecord(reader, record)) {
+        // such records are never written, so the journal is damaged
+        bool isValid =
+            isInTransaction
+                ? record.type != JournalRecord::UNDO &&
+                      record.type != JournalRecord::REDO &&
+                      record.type != JournalRecord::BEGIN_TRANSACTION
+                : record.type != JournalRecord::COMMIT;
+        if (!isValid) {
+            break;
+        }
+        if (record.type == JournalRecord::UNDO) {
+            executor.Undo();
+        } else if (record.type == JournalRecord::REDO) {
+            executor.Redo();
+        } else if (record.type == JournalRecord::BEGIN_TRANSACTION) {
+            executor.BeginTransaction(doc);
+            isInTransaction = true;
+        } else if (record.type == JournalRecord::COMMIT) {
+            executor.Commit();
+            isInTransaction = false;
+        } else {
+            // the cursor is put where the command has been executed, it may
+            // have been moved without commands
+            if (HasOffset(record.type)) {
+                if (record.offset > document->GetText().GetLength()) {
+                    break;
+                }
+                doc->SetCursorOffset(record.offset);
+            }
+            executor.Do(MakeCommand(record, doc));
+        }
+    }
+    // commands of an unfinished transaction have been applied as well
+    if (isInTransaction) {
+        executor.Commit();
+    }
+    return document;
+}
@@ -1,25 +1,104 @@
 #include "executor/executor.h"
 
-Executor::Executor(const std::size_t command_queue_length)
+#include <algorithm>
+#include <cassert>
+
+constexpr std::size_t Executor::kDefaultMemoryBudget;
+
+Executor::Executor(const std::size_t command_queue_length,
+                   const std::size_t memory_budget)
     : command_history(
-          CircularBuffer<Command>(command_queue_length))
+          CircularBuffer<Command>(command_queue_length)),
+      history_length(command_queue_length),
+      memory_budget(memory_budget)
           {}
 
 void Executor::Do(std::shared_ptr<Command>&& command) {
     command->Execute();
-    command_history.push(std::move(command));
+    JournalRecord record = command->GetRecord();
+    if (transaction) {
+        transaction->Add(std::move(command));
+    } else {
+        Push(std::move(command));
+    }
+    if (journal) {
+        Journal(record);
+    }
+}
+
+void Executor::BeginTransaction(std::shared_ptr<IDocument> doc) {
+    assert(!transaction && "Transactions cannot be nested");
+    transaction = std::make_shared<CompositeCommand>(doc);
+    transaction_doc = std::move(doc);
+    transaction_doc->BeginBatch();
+    if (journal) {
+        JournalRecord record;
+        record.type = JournalRecord::BEGIN_TRANSACTION;
+        Journal(record);
+    }
+}
+
+void Executor::Commit() {
+    assert(transaction && "No transaction to commit");
+    std::shared_ptr<CompositeCommand> composite = std::move(transaction);
+    transaction = nullptr;
+    transaction_doc->EndBatch();
+    transaction_doc = nullptr;
+    if (!composite->IsEmpty()) {
+        Push(std::move(composite));
+    }
+    if (journal) {
+        JournalRecord record;
+        record.type = JournalRecord::COMMIT;
+        Journal(record);
+    }
+}
+
+void Executor::Push(std::shared_ptr<Command>&& command) {
+    auto last = command_history.top();
+    std::size_t last_size = last ? last->GetSize() : 0;
+    if (last && last->Merge(*command)) {
+        // a merged command is journaled by itself and merged again on replay
+        history_size += last->GetSize() - last_size;
+    } else {
+        if (command_history.size() == history_length) {
+            DropOldest();
+        }
+        history_size += command->GetSize();
+        command_history.push(std::move(command));
+        journaled_count = std::min(journaled_count + 1, history_length);
+    }
+    journaled_undone_count = 0;
+    // the last command is kept whatever memory it takes
+    while (history_size > memory_budget && command_history.size() > 1) {
+        DropOldest();
+    }
     future_impossible = true;
 }
 
 void Executor::Redo() {
+    assert(!transaction && "Cannot redo in a transaction");
     if(!future_impossible) {
         auto c = command_history.get_next();
 
-        if (c) c->Execute();
+        if (c) {
+            c->Execute();
+            history_size += c->GetSize();
+            if (journal && journaled_undone_count > 0) {
+                --journaled_undone_count;
+                ++journaled_count;
+                JournalRecord record;
+                record.type = JournalRecord::REDO;
+                Journal(record);
+            } else if (journal) {
+                Checkpoint();
+            }
+        }
     }
 }
 
 void Executor::Undo() {
+    assert(!transaction && "Cannot undo in a transaction");
     auto c = command_history.pop();
 
     if(c) {
@@ -27,6 +106,47 @@ void Executor::Undo() {
         if (rc) {
             rc->Unexecute();
         }
+        history_size -= c->GetSize();
         future_impossible = false;
+
+        if (journal && journaled_count > 0) {
+            --journaled_count;
+            ++journaled_undone_count;
+            JournalRecord record;
+            record.type = JournalRecord::UNDO;
+            Journal(record);
+        } else if (journal) {
+            Checkpoint();
+        }
+    }
+}
+
+void Executor::SetJournal(std::shared_ptr<EditJournal> journal) {
+    this->journal = std::move(journal);
+    journaled_count = 0;
+    journaled_undone_count = 0;
+}
+
+void Executor::Journal(const JournalRecord& record) {
+    journal->Append(record);
+    // the journal of a transaction is replayed only from its beginning
+    if (!transaction && journal->IsCheckpointDue()) {
+        // the journal has every command, so it is kept till the save is
+        // written
+        Checkpoint(true);
     }
+}
+
+void Executor::DropOldest() {
+    auto c = command_history.pop_front();
+    if (c) {
+        history_size -= c->GetSize();
+    }
+    journaled_count = std::min(journaled_count, command_history.size());
+}
+
+void Executor::Checkpoint(bool isJournalComplete) {
+    journal->Checkpoint(isJournalComplete);
+    journaled_count = 0;
+    journaled_undone_count = 0;
 }
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "renderer/framebuffer_renderer/framebuffer_renderer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+constexpr char FramebufferRenderer::kBackground;
+
+void FramebufferRenderer::Clear() {
+    back.pages.clear();
+    back.cursorPage = 0;
+    back.cursorPosition = Point();
+    currentPage = 0;
+}
+
+void FramebufferRenderer::DrawPage(int width, int height) {
+    assert(width >= 0 && height >= 0 && "Invalid page size");
+    back.pages.push_back(
+        {width, height, std::vector<char>(size_t(width) * height, kBackground)});
+    currentPage = back.pages.size() - 1;
+}
+
+void FramebufferRenderer::BeginUpdate(size_t pagesCount) {
+    back = front;
+    if (back.pages.size() > pagesCount) {
+        back.pages.resize(pagesCount);
+    }
+    currentPage = 0;
+}
+
+void FramebufferRenderer::SelectPage(size_t index, int width, int height) {
+    assert(width >= 0 && height >= 0 && "Invalid page size");
+    while (back.pages.size() <= index) {
+        back.pages.push_back({width, height,
+                              std::vector<char>(size_t(width) * height,
+                                                kBackground)});
+    }
+    currentPage = index;
+}
+
+void FramebufferRenderer::ClearRegion(int x, int y, int width, int height) {
+    assert(currentPage < back.pages.size() && "Region is cleared before page");
+    Fill(kBackground, x, y, width, height);
+}
+
+void FramebufferRenderer::DrawChar(char symbol, int x, int y, int width,
+                                   int height) {
+    assert(currentPage < back.pages.size() && "Character is drawn before page");
+    Fill(symbol, x, y, width, height);
+}
+
+// cells hold only symbols, so the cursor is kept as a position without its
+// height
+void FramebufferRenderer::DrawCursor(int x, int y, int) {
+    assert(currentPage < back.pages.size() && "Cursor is drawn before page");
+    back.cursorPage = currentPage;
+    back.cursorPosition = Point(x, y);
+}
+
+void FramebufferRenderer::Present() {
+    std::swap(front, back);
+    ++framesCount;
+}
+
+char FramebufferRenderer::GetCell(size_t page, int x, int y) const {
+    assert(page < front.pages.size() && "Invalid page index");
+    const Page& current = front.pages[page];
+    assert(x >= 0 && x < current.width && y >= 0 && y < current.height &&
+           "Cell is out of page");
+    return current.cells[size_t(y) * current.width + x];
+}
+
+size_t FramebufferRenderer::GetPagesCount() const { return front.pages.size(); }
+
+size_t FramebufferRenderer::GetCursorPage() const { return front.cursorPage; }
+
+Point FramebufferRenderer::GetCursorPosition() const {
+    return front.cursorPosition;
+}
+
+size_t FramebufferRenderer::GetFramesCount() const { return framesCount; }
+
+void FramebufferRenderer::Fill(char symbol, int x, int y, int width,
+                               int height) {
+    Page& page = back.pages[currentPage];
+    // areas are clipped by the page borders
+    int left = std::max(x, 0);
+    int right = std::min(x + width, page.width);
+    int top = std::max(y, 0);
+    int bottom = std::min(y + height, page.height);
+    for (int row = top; row < bottom; ++row) {
+        std::fill_n(page.cells.begin() + size_t(row) * page.width + left,
+                    std::max(right - left, 0), symbol);
+    }
+}
@@ -0,0 +1,76 @@
+#include "renderer/text_renderer/text_renderer.h"
+
+TextRenderer::TextRenderer(std::ostream& os) : os(os) {}
+
+void TextRenderer::Clear() { frame = "-----DrawDocument()\n"; }
+
+void TextRenderer::DrawPage(int width, int height) {
+    frame += "DrawPage(): ";
+    AppendNumber(width);
+    frame += ' ';
+    AppendNumber(height);
+    frame += '\n';
+}
+
+void TextRenderer::BeginUpdate(size_t pagesCount) {
+    frame = "-----Redraw(): ";
+    frame += std::to_string(pagesCount);
+    frame += '\n';
+}
+
+void TextRenderer::SelectPage(size_t index, int width, int height) {
+    frame += "SelectPage(): ";
+    frame += std::to_string(index);
+    frame += ' ';
+    AppendNumber(width);
+    frame += ' ';
+    AppendNumber(height);
+    frame += '\n';
+}
+
+void TextRenderer::ClearRegion(int x, int y, int width, int height) {
+    frame += "ClearRegion(): ";
+    AppendNumber(x);
+    frame += ' ';
+    AppendNumber(y);
+    frame += ' ';
+    AppendNumber(width);
+    frame += ' ';
+    AppendNumber(height);
+    frame += '\n';
+}
+
+void TextRenderer::DrawChar(char symbol, int x, int y, int width,
+                            int height) {
+    frame += "DrawChar(): x: ";
+    AppendNumber(x);
+    frame += " y: ";
+    AppendNumber(y);
+    frame += " width: ";
+    AppendNumber(width);
+    frame += " height: ";
+    AppendNumber(height);
+    frame += " symbol: ";
+    frame += symbol;
+    frame += '\n';
+}
+
+void TextRenderer::DrawCursor(int x, int y, int height) {
+    frame += "DrawCursor(): ";
+    AppendNumber(x);
+    frame += ' ';
+    AppendNumber(y);
+    frame += ' ';
+    AppendNumber(height);
+    frame += '\n';
+}
+
+void TextRenderer::Present() {
+    os.write(frame.data(), frame.size());
+    os.flush();
+    frame.clear();
+}
+
+void TextRenderer::AppendNumber(int number) {
+    frame += std::to_string(number);
+}
@@ -0,0 +1,45 @@
+#include "utils/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+std::shared_ptr<MappedFile> MappedFile::Open(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        close(fd);
+        return nullptr;
+    }
+
+    size_t size = static_cast<size_t>(status.st_size);
+    const char* data = nullptr;
+    if (size != 0) {
+        void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            close(fd);
+            return nullptr;
+        }
+        data = static_cast<const char*>(address);
+    }
+    // the mapping stays valid after the descriptor is closed
+    close(fd);
+    return std::shared_ptr<MappedFile>(new MappedFile(data, size));
+}
+
+MappedFile::MappedFile(const char* data, size_t size)
+    : data(data), size(size) {}
+
+MappedFile::~MappedFile() {
+    if (data != nullptr) {
+        munmap(const_cast<char*>(data), size);
+    }
+}
+
+const char* MappedFile::GetData() const { return data; }
+
+size_t MappedFile::GetSize() const { return size; }
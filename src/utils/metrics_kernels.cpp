@@ -0,0 +1,273 @@
+#include "utils/metrics_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define TEXT_EDITOR_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace {
+
+int SumScalar(const int* values, size_t count) {
+    int sum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        sum += values[i];
+    }
+    return sum;
+}
+
+int MaxScalar(const int* values, size_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    return *std::max_element(values, values + count);
+}
+
+void PrefixSumScalar(const int* values, size_t count, int* sums, int sum) {
+    for (size_t i = 0; i < count; ++i) {
+        sum += values[i];
+        sums[i] = sum;
+    }
+}
+
+size_t FindGreaterScalar(const int* values, size_t count, int limit) {
+    for (size_t i = 0; i < count; ++i) {
+        if (values[i] > limit) {
+            return i;
+        }
+    }
+    return count;
+}
+
+#ifdef TEXT_EDITOR_X86_KERNELS
+
+// SSE2 is a part of x86-64, so these versions need no checks
+
+int SumSse2(const int* values, size_t count) {
+    __m128i sum = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        sum = _mm_add_epi32(
+            sum, _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum) + SumScalar(values + i, count - i);
+}
+
+// SSE2 has no maximum of 32-bit integers, it is taken by a comparison
+__m128i MaxSse2(__m128i first, __m128i second) {
+    __m128i isGreater = _mm_cmpgt_epi32(first, second);
+    return _mm_or_si128(_mm_and_si128(isGreater, first),
+                        _mm_andnot_si128(isGreater, second));
+}
+
+int MaxSse2(const int* values, size_t count) {
+    if (count < 4) {
+        return MaxScalar(values, count);
+    }
+    __m128i max = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+    size_t i = 4;
+    for (; i + 4 <= count; i += 4) {
+        max = MaxSse2(
+            max, _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i)));
+    }
+    // the last values are loaded once more, so no scalar tail is needed
+    max = MaxSse2(max, _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                           values + count - 4)));
+    max = MaxSse2(max, _mm_shuffle_epi32(max, _MM_SHUFFLE(1, 0, 3, 2)));
+    max = MaxSse2(max, _mm_shuffle_epi32(max, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(max);
+}
+
+void PrefixSumSse2(const int* values, size_t count, int* sums) {
+    __m128i carry = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i x =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+        x = _mm_add_epi32(x, carry);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + i), x);
+        carry = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    PrefixSumScalar(values + i, count - i, sums + i, _mm_cvtsi128_si32(carry));
+}
+
+size_t FindGreaterSse2(const int* values, size_t count, int limit) {
+    __m128i limits = _mm_set1_epi32(limit);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i x =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        int mask =
+            _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(x, limits)));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + FindGreaterScalar(values + i, count - i, limit);
+}
+
+__attribute__((target("avx2"))) int SumAvx2(const int* values, size_t count) {
+    __m256i sum = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        sum = _mm256_add_epi32(
+            sum,
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                                 _mm256_extracti128_si256(sum, 1));
+    half =
+        _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half =
+        _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(half) + SumScalar(values + i, count - i);
+}
+
+__attribute__((target("avx2"))) int MaxAvx2(const int* values, size_t count) {
+    if (count < 8) {
+        return MaxScalar(values, count);
+    }
+    __m256i max = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values));
+    size_t i = 8;
+    for (; i + 8 <= count; i += 8) {
+        max = _mm256_max_epi32(
+            max,
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)));
+    }
+    max = _mm256_max_epi32(
+        max, _mm256_loadu_si256(
+                 reinterpret_cast<const __m256i*>(values + count - 8)));
+    __m128i half = _mm_max_epi32(_mm256_castsi256_si128(max),
+                                 _mm256_extracti128_si256(max, 1));
+    half =
+        _mm_max_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half =
+        _mm_max_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(half);
+}
+
+__attribute__((target("avx2"))) void PrefixSumAvx2(const int* values,
+                                                   size_t count, int* sums) {
+    __m256i carry = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i x =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        // sums inside both halves, then the sum of the lower half is added
+        // to the upper one
+        x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+        x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+        __m256i lowerSum = _mm256_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+        x = _mm256_add_epi32(
+            x, _mm256_permute2x128_si256(lowerSum, lowerSum, 0x08));
+        x = _mm256_add_epi32(x, carry);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(sums + i), x);
+        carry = _mm256_permutevar8x32_epi32(x, _mm256_set1_epi32(7));
+    }
+    PrefixSumScalar(values + i, count - i, sums + i,
+                    _mm256_cvtsi256_si32(carry));
+}
+
+__attribute__((target("avx2"))) size_t FindGreaterAvx2(const int* values,
+                                                       size_t count,
+                                                       int limit) {
+    __m256i limits = _mm256_set1_epi32(limit);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i x =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        int mask = _mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpgt_epi32(x, limits)));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return i + FindGreaterScalar(values + i, count - i, limit);
+}
+
+#endif  // TEXT_EDITOR_X86_KERNELS
+
+std::atomic<MetricsKernels::InstructionSet> instructionSet(
+    MetricsKernels::GetSupportedInstructionSet());
+
+}  // namespace
+
+MetricsKernels::InstructionSet MetricsKernels::GetSupportedInstructionSet() {
+#ifdef TEXT_EDITOR_X86_KERNELS
+    // it may be called before the constructors of the runtime
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? AVX2 : SSE2;
+#else
+    return SCALAR;
+#endif
+}
+
+MetricsKernels::InstructionSet MetricsKernels::GetInstructionSet() {
+    return instructionSet.load(std::memory_order_relaxed);
+}
+
+void MetricsKernels::SetInstructionSet(InstructionSet set) {
+    instructionSet.store(std::min(set, GetSupportedInstructionSet()),
+                         std::memory_order_relaxed);
+}
+
+int MetricsKernels::Sum(const int* values, size_t count) {
+    switch (GetInstructionSet()) {
+#ifdef TEXT_EDITOR_X86_KERNELS
+        case AVX2:
+            return SumAvx2(values, count);
+        case SSE2:
+            return SumSse2(values, count);
+#endif
+        default:
+            return SumScalar(values, count);
+    }
+}
+
+int MetricsKernels::Max(const int* values, size_t count) {
+    switch (GetInstructionSet()) {
+#ifdef TEXT_EDITOR_X86_KERNELS
+        case AVX2:
+            return MaxAvx2(values, count);
+        case SSE2:
+            return MaxSse2(values, count);
+#endif
+        default:
+            return MaxScalar(values, count);
+    }
+}
+
+void MetricsKernels::PrefixSum(const int* values, size_t count, int* sums) {
+    switch (GetInstructionSet()) {
+#ifdef TEXT_EDITOR_X86_KERNELS
+        case AVX2:
+            PrefixSumAvx2(values, count, sums);
+            return;
+        case SSE2:
+            PrefixSumSse2(values, count, sums);
+            return;
+#endif
+        default:
+            PrefixSumScalar(values, count, sums, 0);
+    }
+}
+
+size_t MetricsKernels::FindGreater(const int* values, size_t count,
+                                   int limit) {
+    switch (GetInstructionSet()) {
+#ifdef TEXT_EDITOR_X86_KERNELS
+        case AVX2:
+            return FindGreaterAvx2(values, count, limit);
+        case SSE2:
+            return FindGreaterSse2(values, count, limit);
+#endif
+        default:
+            return FindGreaterScalar(values, count, limit);
+    }
+}
@@ -0,0 +1,60 @@
+#include "utils/rect.h"
+
+#include <algorithm>
+
+Rect::Rect(int x, int y, int width, int height)
+    : x(x), y(y), width(width), height(height) {}
+
+int Rect::GetRightBorder() const noexcept { return x + width; }
+
+int Rect::GetBottomBorder() const noexcept { return y + height; }
+
+bool Rect::IsEmpty() const noexcept { return width <= 0 || height <= 0; }
+
+bool Rect::Intersects(const Rect& rect) const noexcept {
+    return !IsEmpty() && !rect.IsEmpty() && x < rect.GetRightBorder() &&
+           rect.x < GetRightBorder() && y < rect.GetBottomBorder() &&
+           rect.y < GetBottomBorder();
+}
+
+bool Rect::Contains(const Rect& rect) const noexcept {
+    return rect.IsEmpty() ||
+           (x <= rect.x && rect.GetRightBorder() <= GetRightBorder() &&
+            y <= rect.y && rect.GetBottomBorder() <= GetBottomBorder());
+}
+
+bool Rect::Touches(const Rect& rect) const noexcept {
+    return !IsEmpty() && !rect.IsEmpty() && x <= rect.GetRightBorder() &&
+           rect.x <= GetRightBorder() && y <= rect.GetBottomBorder() &&
+           rect.y <= GetBottomBorder();
+}
+
+Rect Rect::Intersection(const Rect& rect) const noexcept {
+    int left = std::max(x, rect.x);
+    int top = std::max(y, rect.y);
+    int right = std::min(GetRightBorder(), rect.GetRightBorder());
+    int bottom = std::min(GetBottomBorder(), rect.GetBottomBorder());
+    if (left >= right || top >= bottom) {
+        return Rect();
+    }
+    return Rect(left, top, right - left, bottom - top);
+}
+
+Rect Rect::Union(const Rect& rect) const noexcept {
+    if (IsEmpty()) {
+        return rect;
+    }
+    if (rect.IsEmpty()) {
+        return *this;
+    }
+    int left = std::min(x, rect.x);
+    int top = std::min(y, rect.y);
+    int right = std::max(GetRightBorder(), rect.GetRightBorder());
+    int bottom = std::max(GetBottomBorder(), rect.GetBottomBorder());
+    return Rect(left, top, right - left, bottom - top);
+}
+
+bool Rect::operator==(const Rect& rect) const noexcept {
+    return x == rect.x && y == rect.y && width == rect.width &&
+           height == rect.height;
+}
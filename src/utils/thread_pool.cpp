@@ -0,0 +1,76 @@
+#include "utils/thread_pool.h"
+
+ThreadPool::ThreadPool(size_t threadsCount) {
+    workers.reserve(threadsCount);
+    for (size_t i = 0; i < threadsCount; ++i) {
+        workers.emplace_back(&ThreadPool::Run, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopped = true;
+    }
+    started.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count,
+                             const std::function<void(size_t)>& function) {
+    if (count == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> loopLock(loopMutex);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        loop = &function;
+        loopCount = count;
+        nextIndex = 0;
+        busyWorkersCount = workers.size();
+        ++loopNumber;
+    }
+    started.notify_all();
+
+    RunLoop(function, count);
+
+    // the function must outlive the workers using it
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] { return busyWorkersCount == 0; });
+    loop = nullptr;
+}
+
+size_t ThreadPool::GetThreadsCount() const { return workers.size(); }
+
+void ThreadPool::Run() {
+    size_t lastLoopNumber = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        started.wait(lock, [&] {
+            return isStopped || loopNumber != lastLoopNumber;
+        });
+        if (isStopped) {
+            return;
+        }
+        lastLoopNumber = loopNumber;
+        const std::function<void(size_t)>& function = *loop;
+        size_t count = loopCount;
+
+        lock.unlock();
+        RunLoop(function, count);
+        lock.lock();
+
+        if (--busyWorkersCount == 0) {
+            finished.notify_all();
+        }
+    }
+}
+
+void ThreadPool::RunLoop(const std::function<void(size_t)>& function,
+                         size_t count) {
+    for (size_t index = nextIndex++; index < count; index = nextIndex++) {
+        function(index);
+    }
+}
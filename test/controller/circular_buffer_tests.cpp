@@ -167,4 +167,33 @@ TEST(CircularBufferGetNext, WhenCalled_Wraparound_Correct) {
     ASSERT_EQ(cb.get_next(), nullptr);
 
     ASSERT_TRUE(!cb.empty());
-}
\ No newline at end of file
+}
+
+TEST(CircularBufferPopFront, WhenCalled_Wraparound_Correct) {
+    auto cb = CircularBuffer<int>(5);
+
+    ASSERT_EQ(cb.top(), nullptr);
+    ASSERT_EQ(cb.pop_front(), nullptr);
+
+    for (int i = 0; i < 7; ++i){
+        cb.push(std::make_shared<int>(i));
+    }
+    // 5 6 2 3 4
+    ASSERT_EQ(cb.size(), 5);
+    ASSERT_EQ(*cb.top(), 6);
+
+    ASSERT_EQ(*cb.pop_front(), 2);
+    ASSERT_EQ(*cb.pop_front(), 3);
+    // 5 6 . . 4
+    ASSERT_EQ(cb.size(), 3);
+
+    cb.push(std::make_shared<int>(7));
+    // 5 6 7 . 4
+    ASSERT_EQ(*cb.top(), 7);
+    ASSERT_EQ(*cb.pop_front(), 4);
+    ASSERT_EQ(*cb.pop_front(), 5);
+    ASSERT_EQ(*cb.pop(), 7);
+    ASSERT_EQ(*cb.pop(), 6);
+    ASSERT_EQ(cb.pop_front(), nullptr);
+    ASSERT_TRUE(cb.empty());
+}
@@ -5,8 +5,18 @@
 
 #include "document/document.h"
 
+#include "compositor/simple_compositor/simple_compositor.h"
+#include "executor/edit_journal.h"
 #include "executor/executor.h"
 #include "executor/command/insert_character.h"
+#include "executor/command/insert_text.h"
+#include "executor/command/load_document.h"
+#include "executor/command/move_cursor_left.h"
+#include "executor/command/move_cursor_right.h"
+#include "executor/command/paste.h"
+#include "executor/command/remove_character.h"
+#include "executor/command/remove_range.h"
+#include "executor/command/save_document.h"
 
 class DocumentMock : public IDocument {
 public:
@@ -17,9 +27,15 @@ public:
     MOCK_METHOD(void, CutGlyphs, (const Point& start, const Point& end), (override));
     MOCK_METHOD(void, InsertChar, (char symbol), (override));
     MOCK_METHOD(char, RemoveChar, (), (override));
+    MOCK_METHOD(void, InsertText, (const std::string& text), (override));
+    MOCK_METHOD(std::string, RemoveRange, (size_t begin, size_t end), (override));
     MOCK_METHOD(void, DrawDocument, (), (override));
     MOCK_METHOD(void, MoveCursorLeft, (), (override));
     MOCK_METHOD(void, MoveCursorRight, (), (override));
+    MOCK_METHOD(size_t, GetCursorOffset, (), (const, override));
+    MOCK_METHOD(void, SetCursorOffset, (size_t offset), (override));
+    MOCK_METHOD(void, BeginBatch, (), (override));
+    MOCK_METHOD(void, EndBatch, (), (override));
 };
 
 
@@ -67,11 +83,11 @@ TEST(ExecutorDoUndoRedo, WhenCalled_DoUndoRedo_Correct){
     e.Do(std::move(c4));
     // c4 - c2 - c3
 
-    EXPECT_CALL(*d_mock.get(), RemoveChar()).Times(1);
+    EXPECT_CALL(*d_mock.get(), RemoveRange(_, _)).Times(1);
     e.Undo();
     // .c4 - c2 - c3
 
-    EXPECT_CALL(*d_mock.get(), RemoveChar()).Times(1);
+    EXPECT_CALL(*d_mock.get(), RemoveRange(_, _)).Times(1);
     e.Undo();
     // .c4 - .c2 - c3
 
@@ -113,19 +129,19 @@ TEST(ExecutorDoUndoRedo, WhenCalled_WraparoundUndo_Correct){
     e.Do(std::move(c4));
     // c4 - c2 - c3
 
-    EXPECT_CALL(*d_mock.get(), RemoveChar()).Times(1);
+    EXPECT_CALL(*d_mock.get(), RemoveRange(_, _)).Times(1);
     e.Undo();
     // c4 - c2 - .c3
 
-    EXPECT_CALL(*d_mock.get(), RemoveChar()).Times(1);
+    EXPECT_CALL(*d_mock.get(), RemoveRange(_, _)).Times(1);
     e.Undo();
     // c4 - .c2 - .c3
 
-    EXPECT_CALL(*d_mock.get(), RemoveChar()).Times(1);
+    EXPECT_CALL(*d_mock.get(), RemoveRange(_, _)).Times(1);
     e.Undo();
     // .c4 - .c2 - .c3
 
-    EXPECT_CALL(*d_mock.get(), RemoveChar()).Times(0);
+    EXPECT_CALL(*d_mock.get(), RemoveRange(_, _)).Times(0);
     e.Undo();
     // .c4 - .c2 - .c3
 }
@@ -155,11 +171,11 @@ TEST(ExecutorDoUndoRedo, WhenCalled_DoDoDoUndoUndoDoRedo_RedoDoNothing){
     e.Do(std::move(c4));
     // c4 - c2 - c3
 
-    EXPECT_CALL(*d_mock.get(), RemoveChar()).Times(1);
+    EXPECT_CALL(*d_mock.get(), RemoveRange(_, _)).Times(1);
     e.Undo();
     // .c4 - c2 - c3
 
-    EXPECT_CALL(*d_mock.get(), RemoveChar()).Times(1);
+    EXPECT_CALL(*d_mock.get(), RemoveRange(_, _)).Times(1);
     e.Undo();
     // .c4 - c2 - .c3
 
@@ -173,4 +189,346 @@ TEST(ExecutorDoUndoRedo, WhenCalled_DoDoDoUndoUndoDoRedo_RedoDoNothing){
     EXPECT_CALL(*d_mock.get(), InsertChar(_)).Times(0);
     e.Redo();
     // .c4 - c2 - c5
-}
\ No newline at end of file
+}
+
+TEST(ExecutorMerge, WhenCalled_TypingAndRemoving_UndoesWords){
+    auto d = std::make_shared<Document>(std::make_shared<SimpleCompositor>());
+    std::shared_ptr<IDocument> doc = d;
+    auto e = Executor(10);
+    for (char symbol : std::string("hello big world")) {
+        e.Do(std::make_shared<InsertCharacter>(doc, symbol));
+    }
+    ASSERT_EQ(e.command_history.size(), 3);
+
+    e.Undo();
+    ASSERT_EQ(d->GetText().GetText(), "hello big ");
+    e.Redo();
+    ASSERT_EQ(d->GetText().GetText(), "hello big world");
+
+    for (int i = 0; i < 7; ++i) {
+        e.Do(std::make_shared<RemoveCharacter>(doc));
+    }
+    // "dlrow " and "g" are removed by two commands
+    ASSERT_EQ(d->GetText().GetText(), "hello bi");
+    ASSERT_EQ(e.command_history.size(), 5);
+    e.Undo();
+    ASSERT_EQ(d->GetText().GetText(), "hello big");
+    e.Undo();
+    ASSERT_EQ(d->GetText().GetText(), "hello big world");
+
+    // the cursor has been moved, so the next character starts a new command
+    e.Do(std::make_shared<MoveCursorLeft>(doc));
+    e.Do(std::make_shared<InsertCharacter>(doc, 'X'));
+    e.Do(std::make_shared<InsertCharacter>(doc, 'Y'));
+    ASSERT_EQ(d->GetText().GetText(), "hello big worlXYd");
+    e.Undo();
+    ASSERT_EQ(d->GetText().GetText(), "hello big world");
+}
+
+TEST(ExecutorUndo, WhenCalled_AfterCursorMoved_UndoesAtRecordedOffsets){
+    auto d = std::make_shared<Document>(std::make_shared<SimpleCompositor>());
+    std::shared_ptr<IDocument> doc = d;
+    auto e = Executor(10);
+    for (char symbol : std::string("abc")) {
+        e.Do(std::make_shared<InsertCharacter>(doc, symbol));
+    }
+    e.Do(std::make_shared<RemoveCharacter>(doc));
+    ASSERT_EQ(d->GetText().GetText(), "ab");
+
+    // the cursor is moved past the commands, they are undone where they
+    // have been executed
+    d->SetCursorOffset(0);
+    e.Undo();
+    ASSERT_EQ(d->GetText().GetText(), "abc");
+    d->SetCursorOffset(1);
+    e.Undo();
+    ASSERT_EQ(d->GetText().GetText(), "");
+    ASSERT_EQ(d->GetCursorOffset(), 0);
+
+    e.Redo();
+    ASSERT_EQ(d->GetText().GetText(), "abc");
+    d->SetCursorOffset(0);
+    e.Redo();
+    ASSERT_EQ(d->GetText().GetText(), "ab");
+    ASSERT_EQ(d->GetCursorOffset(), 2);
+}
+
+TEST(ExecutorMemoryBudget, WhenCalled_OverBudget_DropsOldestCommands){
+    auto d_mock = std::make_shared<DocumentMock>();
+    std::size_t command_size = InsertCharacter(d_mock, 'A').GetSize();
+    auto e = Executor(100, 3 * command_size);
+
+    // the mock reports the same cursor offset, so commands are not merged
+    EXPECT_CALL(*d_mock.get(), InsertChar(_)).Times(10);
+    for (int i = 0; i < 10; ++i) {
+        e.Do(std::make_shared<InsertCharacter>(d_mock, 'A'));
+    }
+    ASSERT_EQ(e.command_history.size(), 3);
+    ASSERT_LE(e.history_size, 3 * command_size);
+
+    EXPECT_CALL(*d_mock.get(), RemoveRange(_, _)).Times(3);
+    for (int i = 0; i < 10; ++i) {
+        e.Undo();
+    }
+    ASSERT_EQ(e.history_size, 0);
+}
+
+TEST(ExecutorTransaction, WhenCalled_Commit_UndoesAsOneCommand){
+    auto d = std::make_shared<Document>(std::make_shared<SimpleCompositor>());
+    std::shared_ptr<IDocument> doc = d;
+    auto e = Executor(10);
+    e.Do(std::make_shared<InsertCharacter>(doc, 'a'));
+
+    e.BeginTransaction(doc);
+    e.Do(std::make_shared<MoveCursorLeft>(doc));
+    for (char symbol : std::string("xy z")) {
+        e.Do(std::make_shared<InsertCharacter>(doc, symbol));
+    }
+    e.Do(std::make_shared<RemoveCharacter>(doc));
+    e.Commit();
+    ASSERT_EQ(d->GetText().GetText(), "xy a");
+    ASSERT_EQ(e.command_history.size(), 2);
+
+    e.Undo();
+    // moves of the cursor are not undone
+    ASSERT_EQ(d->GetText().GetText(), "a");
+    ASSERT_EQ(d->GetCursorOffset(), 0);
+    e.Redo();
+    ASSERT_EQ(d->GetText().GetText(), "xy a");
+    ASSERT_EQ(d->GetCursorOffset(), 3);
+}
+
+TEST(ExecutorText, WhenCalled_InsertTextRemoveRange_UndoRedo){
+    auto d = std::make_shared<Document>(std::make_shared<SimpleCompositor>());
+    std::shared_ptr<IDocument> doc = d;
+    auto e = Executor(10);
+    e.Do(std::make_shared<InsertText>(doc, "hello world"));
+    e.Do(std::make_shared<MoveCursorLeft>(doc));
+    e.Do(std::make_shared<InsertText>(doc, ", big"));
+    ASSERT_EQ(d->GetText().GetText(), "hello worl, bigd");
+    e.Do(std::make_shared<RemoveRange>(doc, 2, 12));
+    ASSERT_EQ(d->GetText().GetText(), "hebigd");
+    ASSERT_EQ(d->GetCursorOffset(), 2);
+
+    e.Undo();
+    ASSERT_EQ(d->GetText().GetText(), "hello worl, bigd");
+    e.Undo();
+    ASSERT_EQ(d->GetText().GetText(), "hello world");
+    e.Redo();
+    e.Redo();
+    ASSERT_EQ(d->GetText().GetText(), "hebigd");
+}
+
+class CountingCompositor : public SimpleCompositor {
+public:
+    std::size_t compose_count = 0;
+
+    void Compose() override {
+        ++compose_count;
+        SimpleCompositor::Compose();
+    }
+    void Compose(const Page::PagePtr& page,
+                 const Glyph::GlyphPtr& glyph) override {
+        ++compose_count;
+        SimpleCompositor::Compose(page, glyph);
+    }
+};
+
+TEST(ExecutorPaste, WhenCalled_PasteUndoCut_ComposesOnce){
+    auto compositor = std::make_shared<CountingCompositor>();
+    auto d = std::make_shared<Document>(compositor);
+    std::shared_ptr<IDocument> doc = d;
+    d->InsertText("some text to paste");
+    d->SelectGlyphs(Point(0, 0), Point(1000, 1000));
+    ASSERT_GT(d->GetSelectedGlyphs().size(), 1);
+
+    compositor->compose_count = 0;
+    Paste paste(doc, Point(3, 5));
+    paste.Execute();
+    EXPECT_EQ(compositor->compose_count, 1);
+    EXPECT_EQ(d->GetText().GetText().size(), 36);
+
+    compositor->compose_count = 0;
+    paste.Unexecute();
+    EXPECT_EQ(compositor->compose_count, 1);
+    EXPECT_EQ(d->GetText().GetText(), "some text to paste");
+
+    compositor->compose_count = 0;
+    d->CutGlyphs(Point(0, 0), Point(1000, 1000));
+    EXPECT_EQ(compositor->compose_count, 1);
+    EXPECT_EQ(d->GetText().GetText(), "");
+}
+
+TEST(SaveDocument_Execute, WhenCalled_AfterLoadFromSamePath_KeepsText){
+    const char* path = "save_document_test.lxdf";
+    std::string text;
+    for (int i = 0; i < 20000; ++i) {
+        text.push_back('a' + i % 26);
+    }
+    auto d = std::make_shared<Document>(std::make_shared<SimpleCompositor>());
+    d->InsertText(text);
+    std::shared_ptr<IDocument> doc = d;
+    SaveDocument(doc, path).Execute();
+
+    // the loaded text refers to the mapped file till it is saved over it
+    LoadDocument(&doc, path).Execute();
+    ASSERT_NE(doc, d);
+    doc->SetCursorOffset(0);
+    doc->InsertText("new ");
+    SaveDocument(doc, path).Execute();
+    EXPECT_EQ(std::dynamic_pointer_cast<Document>(doc)->GetText().GetText(),
+              "new " + text);
+
+    LoadDocument(&doc, path).Execute();
+    EXPECT_EQ(std::dynamic_pointer_cast<Document>(doc)->GetText().GetText(),
+              "new " + text);
+    std::remove(path);
+}
+
+TEST(EditJournal_Recover, WhenCalled_AfterEdits_RestoresDocument){
+    const char* path = "edit_journal_test.lxej";
+    const char* save_path = "edit_journal_test.lxdf";
+    auto d = std::make_shared<Document>(std::make_shared<SimpleCompositor>());
+    std::shared_ptr<IDocument> doc = d;
+    {
+        auto e = Executor(4);
+        e.SetJournal(std::make_shared<EditJournal>(path, save_path, d));
+        for (char symbol : std::string("journal")) {
+            e.Do(std::make_shared<InsertCharacter>(doc, symbol));
+        }
+        e.Undo();
+        e.Undo();
+        e.Redo();
+        e.Do(std::make_shared<MoveCursorLeft>(doc));
+        e.Do(std::make_shared<RemoveCharacter>(doc));
+        e.Undo();
+        e.Do(std::make_shared<InsertText>(doc, " text"));
+        e.Do(std::make_shared<RemoveRange>(doc, 1, 3));
+        // the journal is closed without a checkpoint
+    }
+    ASSERT_EQ(d->GetText().GetText(), "jrna textl");
+
+    std::shared_ptr<Document> recovered = EditJournal::Recover(path, save_path, 4);
+    ASSERT_NE(recovered, nullptr);
+    EXPECT_EQ(recovered->GetText().GetText(), d->GetText().GetText());
+    EXPECT_EQ(recovered->GetCursorOffset(), d->GetCursorOffset());
+    std::remove(path);
+    std::remove(save_path);
+}
+
+TEST(EditJournal_Recover, WhenCursorMovedBetweenEdits_ReplaysAtSameOffsets){
+    const char* path = "edit_journal_test.lxej";
+    const char* save_path = "edit_journal_test.lxdf";
+    auto d = std::make_shared<Document>(std::make_shared<SimpleCompositor>());
+    std::shared_ptr<IDocument> doc = d;
+    {
+        auto e = Executor(4);
+        e.SetJournal(std::make_shared<EditJournal>(path, save_path, d));
+        e.Do(std::make_shared<InsertText>(doc, "hello world"));
+        // the cursor is put by offsets, as by clicks, not by commands
+        doc->SetCursorOffset(5);
+        e.Do(std::make_shared<InsertCharacter>(doc, ','));
+        doc->SetCursorOffset(3);
+        e.Do(std::make_shared<RemoveCharacter>(doc));
+        doc->SetCursorOffset(11);
+        e.Do(std::make_shared<InsertText>(doc, "!"));
+        doc->SetCursorOffset(0);
+        e.Do(std::make_shared<MoveCursorRight>(doc));
+    }
+    ASSERT_EQ(d->GetText().GetText(), "helo, world!");
+
+    std::shared_ptr<Document> recovered = EditJournal::Recover(path, save_path, 4);
+    ASSERT_NE(recovered, nullptr);
+    EXPECT_EQ(recovered->GetText().GetText(), d->GetText().GetText());
+    EXPECT_EQ(recovered->GetCursorOffset(), d->GetCursorOffset());
+    std::remove(path);
+    std::remove(save_path);
+}
+
+TEST(EditJournal_Recover, WhenCalled_AfterCheckpoints_RestoresDocument){
+    const char* path = "edit_journal_test.lxej";
+    const char* save_path = "edit_journal_test.lxdf";
+    auto d = std::make_shared<Document>(std::make_shared<SimpleCompositor>());
+    std::shared_ptr<IDocument> doc = d;
+    auto journal = std::make_shared<EditJournal>(path, save_path, d, 4);
+    auto e = Executor(5);
+    e.SetJournal(journal);
+    e.Do(std::make_shared<InsertCharacter>(doc, 'a'));
+    e.Do(std::make_shared<InsertCharacter>(doc, 'b'));
+    e.Do(std::make_shared<MoveCursorLeft>(doc));
+    e.Do(std::make_shared<MoveCursorRight>(doc));
+    EXPECT_EQ(journal->GetRecordsCount(), 0);
+    e.Do(std::make_shared<InsertCharacter>(doc, 'c'));
+    e.Undo();
+    EXPECT_EQ(journal->GetRecordsCount(), 2);
+
+    // undo and redo of commands from before the checkpoint make a new one
+    e.Undo();
+    EXPECT_EQ(journal->GetRecordsCount(), 0);
+    e.Redo();
+    e.Redo();
+    e.Do(std::make_shared<InsertCharacter>(doc, '!'));
+    EXPECT_EQ(journal->GetRecordsCount(), 1);
+    ASSERT_EQ(d->GetText().GetText(), "abc!");
+    journal->Flush();
+
+    std::shared_ptr<Document> recovered = EditJournal::Recover(path, save_path, 5);
+    ASSERT_NE(recovered, nullptr);
+    EXPECT_EQ(recovered->GetText().GetText(), "abc!");
+    EXPECT_EQ(recovered->GetCursorOffset(), 4);
+    std::remove(path);
+    std::remove(save_path);
+}
+
+TEST(EditJournal_Recover, WhenCheckpointInterrupted_ReadsTemporaryJournal){
+    const char* path = "edit_journal_test.lxej";
+    const char* save_path = "edit_journal_test.lxdf";
+    const std::string temporary_path = std::string(path) + ".tmp";
+    auto d = std::make_shared<Document>(std::make_shared<SimpleCompositor>());
+    std::shared_ptr<IDocument> doc = d;
+    {
+        auto journal = std::make_shared<EditJournal>(path, save_path, d);
+        auto e = Executor(4);
+        e.SetJournal(journal);
+        for (char symbol : std::string("save")) {
+            e.Do(std::make_shared<InsertCharacter>(doc, symbol));
+        }
+        journal->Checkpoint(true);
+        // the records go to the journal of the checkpoint as well
+        e.Do(std::make_shared<InsertCharacter>(doc, '!'));
+    }
+    ASSERT_EQ(d->GetText().GetText(), "save!");
+    // as if the save had been replaced and the journal had not
+    ASSERT_EQ(std::rename(path, temporary_path.c_str()), 0);
+
+    std::shared_ptr<Document> recovered = EditJournal::Recover(path, save_path, 4);
+    ASSERT_NE(recovered, nullptr);
+    EXPECT_EQ(recovered->GetText().GetText(), "save!");
+    std::remove(temporary_path.c_str());
+    std::remove(save_path);
+}
+
+TEST(EditJournal_Recover, WhenJournalOfOtherVersion_IgnoresJournal){
+    const char* path = "edit_journal_test.lxej";
+    const char* save_path = "edit_journal_test.lxdf";
+    auto d = std::make_shared<Document>(std::make_shared<SimpleCompositor>());
+    std::shared_ptr<IDocument> doc = d;
+    {
+        auto e = Executor(4);
+        e.SetJournal(std::make_shared<EditJournal>(path, save_path, d));
+        e.Do(std::make_shared<InsertText>(doc, "lost"));
+    }
+    // the version follows the magic
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in |
+                                    std::ios::out);
+        file.seekp(4);
+        file.put(char(EditJournal::kVersion - 1));
+    }
+
+    std::shared_ptr<Document> recovered = EditJournal::Recover(path, save_path, 4);
+    ASSERT_NE(recovered, nullptr);
+    EXPECT_EQ(recovered->GetText().GetText(), "");
+    std::remove(path);
+    std::remove(save_path);
+}
@@ -1,13 +1,35 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstdio>
 #include <cstdlib>
+#include <fstream>
+#include <future>
+#include <sstream>
 
 #include "compositor/compositor.h"
+#include "compositor/optimal_compositor/optimal_compositor.h"
 #include "compositor/simple_compositor/simple_compositor.h"
+#include "document/autosave.h"
+#include "document/background_compositor.h"
+#include "document/dirty_region.h"
 #include "document/document.h"
+#include "document/document_format.h"
 #include "document/glyphs/character.h"
+#include "document/glyphs/character_factory.h"
+#include "document/glyphs/column.h"
 #include "document/glyphs/glyph.h"
+#include "document/glyphs/glyph_visitor.h"
+#include "document/glyphs/page.h"
 #include "document/glyphs/row.h"
+#include "document/memory_pool.h"
+#include "document/text_buffer.h"
+#include "renderer/framebuffer_renderer/framebuffer_renderer.h"
+#include "renderer/null_renderer/null_renderer.h"
+#include "renderer/text_renderer/text_renderer.h"
+#include "utils/latest_task_worker.h"
+#include "utils/metrics_kernels.h"
+#include "utils/thread_pool.h"
 
 //----------------------------------------Glyph---------------------------------------------------
 TEST(Glyph_Constructor, GlyphConstructor_WhenCalled_CreatesGlyphWithPosition) {
@@ -2247,4 +2269,1914 @@ TEST(Document_RemoveChar2,
     Glyph::GlyphPtr selectedGlyph = d->GetSelectedGlyph();
     Row::RowPtr selectedRow = std::dynamic_pointer_cast<Row>(selectedGlyph);
     EXPECT_EQ(selectedRow, d->GetFirstPage()->GetFirstGlyph()->GetFirstGlyph());
-}
\ No newline at end of file
+}
+//-----------------------------------Incremental compose------------------------------------------
+// Flattens positions and sizes of all rows and characters of the document
+std::vector<std::vector<int>> GetDocumentLayout(Document& document) {
+    std::vector<std::vector<int>> layout;
+    layout.push_back({static_cast<int>(document.GetPagesCount())});
+    for (Page::PagePtr page = document.GetFirstPage(); page != nullptr;
+         page = document.GetNextPage(page)) {
+        for (Glyph::GlyphPtr column = page->GetFirstGlyph(); column != nullptr;
+             column = page->GetNextGlyph(column)) {
+            for (Glyph::GlyphPtr row = column->GetFirstGlyph(); row != nullptr;
+                 row = column->GetNextGlyph(row)) {
+                layout.push_back({row->GetPosition().x, row->GetPosition().y,
+                                  row->GetWidth(), row->GetHeight()});
+                for (Glyph::GlyphPtr character = row->GetFirstGlyph();
+                     character != nullptr;
+                     character = row->GetNextGlyph(character)) {
+                    layout.push_back(
+                        {character->GetPosition().x,
+                         character->GetPosition().y, character->GetWidth(),
+                         character->GetHeight(),
+                         std::static_pointer_cast<Character>(character)
+                             ->GetChar()});
+                }
+            }
+        }
+    }
+    return layout;
+}
+
+// Inserts character of the specified size right after the cursor
+void InsertAfterCursor(Document& document, char symbol, int width,
+                       int height = 1) {
+    Glyph::GlyphPtr selected = document.GetSelectedGlyph();
+    int x = selected->GetPosition().x;
+    if (std::dynamic_pointer_cast<Character>(selected) != nullptr) {
+        x += selected->GetWidth();
+    }
+    Glyph::GlyphPtr character = std::make_shared<Character>(
+        x, selected->GetPosition().y + 1, width, height, symbol);
+    document.Insert(character);
+}
+
+void ExpectSameLayoutAsFullCompose(Document& document) {
+    std::vector<std::vector<int>> layout = GetDocumentLayout(document);
+    document.GetCompositor()->Compose();
+    EXPECT_EQ(layout, GetDocumentLayout(document));
+}
+
+// Fills the document with characters of different widths while the cursor
+// stays on the first page
+void FillDocument(Document& document, int count, bool check = false) {
+    for (int i = 0; i < count; ++i) {
+        InsertAfterCursor(document, 'a' + i % 26, 1 + i % 3);
+        if (i >= 40) {
+            document.MoveCursorLeft();
+        }
+        if (check) {
+            ExpectSameLayoutAsFullCompose(document);
+        }
+    }
+}
+
+TEST(SimpleCompositor_IncrementalCompose1,
+     InsertCharacters_WhenCalled_LayoutIsTheSameAsAfterFullCompose) {
+    for (auto alignment : {Compositor::LEFT, Compositor::CENTER,
+                           Compositor::RIGHT, Compositor::JUSTIFIED}) {
+        // 17 pixels wide rows, 10 rows per page
+        Document document(
+            std::make_shared<SimpleCompositor>(5, 10, 3, 480, alignment, 100));
+
+        FillDocument(document, 200, true);
+        EXPECT_GT(document.GetPagesCount(), 2);
+
+        for (int i = 0; i < 20; ++i) {
+            document.MoveCursorLeft();
+        }
+        for (int i = 0; i < 20; ++i) {
+            InsertAfterCursor(document, 'A' + i % 26, 3 - i % 3);
+            ExpectSameLayoutAsFullCompose(document);
+        }
+    }
+}
+
+TEST(SimpleCompositor_IncrementalCompose2,
+     RemoveCharacters_WhenCalled_LayoutIsTheSameAsAfterFullCompose) {
+    Document document(std::make_shared<SimpleCompositor>(
+        5, 10, 3, 480, Compositor::LEFT, 100));
+
+    FillDocument(document, 200);
+    EXPECT_GT(document.GetPagesCount(), 2);
+
+    // characters from the next rows and pages move up to the shortened rows
+    // and empty pages are removed from the end of document
+    while (document.GetPagesCount() > 1) {
+        document.MoveCursorRight();
+        document.RemoveChar();
+        ExpectSameLayoutAsFullCompose(document);
+    }
+
+    for (int i = 0; i < 200; ++i) {
+        document.MoveCursorRight();
+    }
+    while (std::dynamic_pointer_cast<Character>(
+               document.GetSelectedGlyph()) != nullptr) {
+        document.RemoveChar();
+        ExpectSameLayoutAsFullCompose(document);
+    }
+    EXPECT_EQ(document.GetFirstPage()
+                  ->GetFirstGlyph()
+                  ->GetFirstGlyph()
+                  ->GetFirstGlyph(),
+              nullptr);
+}
+
+TEST(SimpleCompositor_IncrementalCompose3,
+     ChangeRowHeightOrSettings_WhenCalled_LayoutIsTheSameAsAfterFullCompose) {
+    auto compositor = std::make_shared<SimpleCompositor>(5, 10, 3, 480,
+                                                         Compositor::LEFT, 100);
+    Document document(compositor);
+
+    for (int i = 0; i < 50; ++i) {
+        InsertAfterCursor(document, 'a' + i % 26, 2);
+    }
+    for (int i = 0; i < 30; ++i) {
+        document.MoveCursorLeft();
+    }
+
+    // rows below the taller character have to be moved down
+    InsertAfterCursor(document, 'T', 1, 20);
+    ExpectSameLayoutAsFullCompose(document);
+
+    compositor->SetAlignment(Compositor::RIGHT);
+    InsertAfterCursor(document, 'R', 2);
+    ExpectSameLayoutAsFullCompose(document);
+}
+
+//--------------------------------------Cursor navigation-----------------------------------------
+TEST(Document_MoveCursor3,
+     DocumentMoveCursorThroughPages_WhenCalled_VisitsCharactersInLayoutOrder) {
+    Document document(std::make_shared<SimpleCompositor>(
+        5, 10, 3, 480, Compositor::LEFT, 100));
+    FillDocument(document, 200);
+    EXPECT_GT(document.GetPagesCount(), 2);
+
+    Glyph::GlyphList characters;
+    for (Page::PagePtr page = document.GetFirstPage(); page != nullptr;
+         page = document.GetNextPage(page)) {
+        for (Glyph::GlyphPtr column = page->GetFirstGlyph(); column != nullptr;
+             column = page->GetNextGlyph(column)) {
+            for (Glyph::GlyphPtr row = column->GetFirstGlyph(); row != nullptr;
+                 row = column->GetNextGlyph(row)) {
+                for (Glyph::GlyphPtr character = row->GetFirstGlyph();
+                     character != nullptr;
+                     character = row->GetNextGlyph(character)) {
+                    characters.push_back(character);
+                }
+            }
+        }
+    }
+    ASSERT_EQ(characters.size(), 200);
+
+    for (int i = 0; i < 300; ++i) {
+        document.MoveCursorLeft();
+    }
+    EXPECT_EQ(document.GetSelectedGlyph(),
+              document.GetFirstPage()->GetFirstGlyph()->GetFirstGlyph());
+
+    for (const auto& character : characters) {
+        document.MoveCursorRight();
+        EXPECT_EQ(document.GetSelectedGlyph(), character);
+    }
+    // cursor stays at the end of document
+    document.MoveCursorRight();
+    EXPECT_EQ(document.GetSelectedGlyph(), characters.back());
+
+    for (auto it = characters.rbegin(); it != characters.rend(); ++it) {
+        EXPECT_EQ(document.GetSelectedGlyph(), *it);
+        document.MoveCursorLeft();
+    }
+}
+
+TEST(Document_MoveCursor4,
+     DocumentMoveCursorAfterRemove_WhenCalled_SkipsRemovedCharacters) {
+    auto d = std::make_shared<Document>(std::make_shared<SimpleCompositor>());
+
+    d->InsertChar('A');
+    d->InsertChar('B');
+    d->InsertChar('C');
+    d->MoveCursorLeft();
+    d->RemoveChar();
+
+    Character::CharPtr selectedChar =
+        std::dynamic_pointer_cast<Character>(d->GetSelectedGlyph());
+    EXPECT_EQ(selectedChar->GetChar(), 'A');
+
+    d->MoveCursorRight();
+    selectedChar = std::dynamic_pointer_cast<Character>(d->GetSelectedGlyph());
+    EXPECT_EQ(selectedChar->GetChar(), 'C');
+
+    d->MoveCursorLeft();
+    d->MoveCursorLeft();
+    d->InsertChar('D');
+    d->MoveCursorRight();
+    selectedChar = std::dynamic_pointer_cast<Character>(d->GetSelectedGlyph());
+    EXPECT_EQ(selectedChar->GetChar(), 'A');
+    d->MoveCursorLeft();
+    d->MoveCursorLeft();
+    EXPECT_EQ(d->GetSelectedGlyph(),
+              d->GetFirstPage()->GetFirstGlyph()->GetFirstGlyph());
+}
+//----------------------------------------Text buffer---------------------------------------------
+TEST(TextBuffer_Insert1, TextBufferInsert_WhenCalled_InsertsAtOffset) {
+    TextBuffer text("Lexi");
+    text.Insert(4, " editor");
+    text.Insert(0, 'A');
+    text.Insert(1, " text", 5);
+    EXPECT_EQ(text.GetText(), "A textLexi editor");
+    EXPECT_EQ(text.GetLength(), 17);
+    EXPECT_EQ(text.GetChar(6), 'L');
+    EXPECT_EQ(text.GetText(2, 4), "text");
+}
+
+TEST(TextBuffer_Insert2, TextBufferTyping_WhenCalled_ExtendsLastPiece) {
+    TextBuffer text("text");
+    for (int i = 0; i < 100; ++i) {
+        text.Insert(2 + i, 'a' + i % 26);
+    }
+    EXPECT_EQ(text.GetLength(), 104);
+    // head of original text, typed characters, tail of original text
+    EXPECT_EQ(text.GetPiecesCount(), 3);
+}
+
+TEST(TextBuffer_Remove1, TextBufferRemove_WhenCalled_RemovesRange) {
+    TextBuffer text("Lexi text editor");
+    text.Remove(4, 5);
+    EXPECT_EQ(text.GetText(), "Lexi editor");
+    text.Remove(0, 5);
+    text.Remove(5, 1);
+    EXPECT_EQ(text.GetText(), "edito");
+    text.Remove(0, 5);
+    EXPECT_EQ(text.GetLength(), 0);
+    EXPECT_EQ(text.GetPiecesCount(), 0);
+}
+
+TEST(TextBuffer_InsertRemove, TextBufferRandomEdits_WhenCalled_MatchesString) {
+    std::srand(7);
+    std::string expected = "original text";
+    TextBuffer text(expected);
+    for (int i = 0; i < 2000; ++i) {
+        size_t offset = std::rand() % (expected.size() + 1);
+        if (std::rand() % 3 != 0 || expected.empty()) {
+            std::string inserted(1 + std::rand() % 4, 'a' + i % 26);
+            text.Insert(offset, inserted);
+            expected.insert(offset, inserted);
+        } else {
+            size_t length =
+                std::min<size_t>(1 + std::rand() % 3, expected.size() - offset);
+            text.Remove(offset, length);
+            expected.erase(offset, length);
+        }
+        ASSERT_EQ(text.GetLength(), expected.size());
+    }
+    EXPECT_EQ(text.GetText(), expected);
+    // ranges are read from the pieces overlapping them
+    for (int i = 0; i < 200; ++i) {
+        size_t offset = std::rand() % (expected.size() + 1);
+        size_t length = std::rand() % (expected.size() - offset + 1);
+        ASSERT_EQ(text.GetText(offset, length), expected.substr(offset, length));
+        size_t count = 0;
+        for (const CharacterRun& run : text.GetRuns(offset, length)) {
+            count += run.count;
+        }
+        ASSERT_EQ(count, length);
+    }
+
+    TextBuffer copy = text;
+    copy.Remove(0, copy.GetLength());
+    EXPECT_EQ(text.GetText(), expected);
+}
+
+TEST(TextBuffer_Copy, TextBufferCopy_WhenBothTyped_KeepsOwnCharacters) {
+    TextBuffer text("ab");
+    text.Insert(2, 'c');
+    TextBuffer copy = text;
+    // both append after the same characters of the shared chunk
+    text.Insert(3, 'd');
+    copy.Insert(3, 'x');
+    copy.Insert(4, 'y');
+    text.Insert(4, 'e');
+    EXPECT_EQ(text.GetText(), "abcde");
+    EXPECT_EQ(copy.GetText(), "abcxy");
+    EXPECT_EQ(text.GetPiecesCount(), 2);
+}
+
+TEST(TextBuffer_SetSize, TextBufferSetSize_WhenCalled_ChangesRuns) {
+    TextBuffer text("Lexi editor");
+    text.SetSizes({{11, 2, 2}});
+    text.SetSize(2, 3, 4, 5);
+    text.Insert(11, "!", 1, 2, 2);
+    TextBuffer copy = text;
+    text.Remove(0, 4);
+
+    std::vector<CharacterRun> runs = copy.GetRuns();
+    ASSERT_EQ(runs.size(), 3);
+    EXPECT_EQ(runs[0].count, 2);
+    EXPECT_EQ(runs[1].count, 3);
+    EXPECT_EQ(runs[1].width, 4);
+    EXPECT_EQ(runs[1].height, 5);
+    EXPECT_EQ(runs[2].count, 7);
+    EXPECT_EQ(runs[2].width, 2);
+    runs = text.GetRuns();
+    ASSERT_EQ(runs.size(), 2);
+    EXPECT_EQ(runs[0].count, 1);
+    EXPECT_EQ(runs[1].count, 7);
+    EXPECT_EQ(copy.GetRuns(3, 4).size(), 2);
+}
+
+// Concatenates characters of the document in the layout order
+std::string GetLayoutText(Document& document) {
+    std::string text;
+    for (const auto& entry : GetDocumentLayout(document)) {
+        if (entry.size() == 5) {
+            text.push_back(static_cast<char>(entry[4]));
+        }
+    }
+    return text;
+}
+
+TEST(Document_Text1, DocumentEdit_WhenCalled_KeepsTextInLayoutOrder) {
+    Document document(std::make_shared<SimpleCompositor>(
+        5, 10, 3, 480, Compositor::LEFT, 100));
+    FillDocument(document, 150);
+    EXPECT_EQ(document.GetText().GetText(), GetLayoutText(document));
+
+    std::srand(3);
+    for (int i = 0; i < 100; ++i) {
+        switch (std::rand() % 4) {
+            case 0:
+                document.MoveCursorLeft();
+                break;
+            case 1:
+                document.MoveCursorRight();
+                break;
+            case 2:
+                InsertAfterCursor(document, 'A' + i % 26, 2);
+                break;
+            default:
+                if (std::dynamic_pointer_cast<Character>(
+                        document.GetSelectedGlyph()) != nullptr) {
+                    document.RemoveChar();
+                }
+        }
+        ASSERT_EQ(document.GetText().GetText(), GetLayoutText(document));
+    }
+
+    for (int i = 0; i < 300; ++i) {
+        document.MoveCursorLeft();
+    }
+    EXPECT_EQ(document.GetCursorOffset(), 0);
+    document.MoveCursorRight();
+    document.MoveCursorRight();
+    EXPECT_EQ(document.GetCursorOffset(), 2);
+}
+
+TEST(Document_Text2, DocumentCutPaste_WhenCalled_KeepsTextInLayoutOrder) {
+    auto d = std::make_shared<Document>(std::make_shared<SimpleCompositor>());
+    for (char symbol : std::string("Lexi editor")) {
+        d->InsertChar(symbol);
+    }
+    EXPECT_EQ(d->GetText().GetText(), "Lexi editor");
+    EXPECT_EQ(d->GetCursorOffset(), 11);
+
+    Point start = d->GetFirstPage()->GetFirstGlyph()->GetFirstGlyph()
+                      ->GetFirstGlyph()->GetPosition();
+    d->SelectGlyphs(start, Point(start.x + 10, start.y + 2));
+    size_t selectedCount = d->GetText().GetLength();
+    Glyph::GlyphPtr last = d->GetSelectedGlyph();
+    d->PasteGlyphs(Point(last->GetPosition().x + last->GetWidth(),
+                         last->GetPosition().y + 1));
+    EXPECT_EQ(d->GetText().GetText(), GetLayoutText(*d));
+    EXPECT_GT(d->GetText().GetLength(), selectedCount);
+
+    d->CutGlyphs(start, Point(start.x + 10, start.y + 2));
+    EXPECT_EQ(d->GetText().GetText(), GetLayoutText(*d));
+}
+//-------------------------------------Character factory------------------------------------------
+TEST(CharacterFactory_CreateCharacter1,
+     CharacterFactoryCreate_WhenCalled_CreatesSeparateCharacters) {
+    CharacterFactory factory;
+    Character::CharPtr a1 = factory.CreateCharacter(1, 2, 'a', 3);
+    Character::CharPtr a2 = factory.CreateCharacter(4, 5, 'a', 3);
+    Character::CharPtr b = factory.CreateCharacter(1, 2, 'b', 3);
+    Character::CharPtr wideA = factory.CreateCharacter(1, 2, 5, 3, 'a');
+
+    EXPECT_NE(a1, a2);
+    EXPECT_EQ(a1->GetPosition().x, 1);
+    EXPECT_EQ(a1->GetPosition().y, 2);
+    EXPECT_EQ(a2->GetPosition().x, 4);
+    EXPECT_EQ(a2->GetPosition().y, 5);
+    EXPECT_EQ(a2->GetWidth(), 3);
+    EXPECT_EQ(a2->GetHeight(), 3);
+    EXPECT_EQ(b->GetChar(), 'b');
+    EXPECT_EQ(wideA->GetWidth(), 5);
+    EXPECT_EQ(wideA->GetHeight(), 3);
+    EXPECT_EQ(wideA->GetChar(), 'a');
+}
+
+TEST(CharacterFactory_CreateCharacter2,
+     CharacterFactoryCreate_WhenPoolGiven_AllocatesCharactersInPool) {
+    auto pool = std::make_shared<MemoryPool>();
+    CharacterFactory factory(pool);
+    Character::CharPtr a = factory.CreateCharacter(0, 0, 'a', 1);
+    size_t used = pool->GetUsedBlocksCount();
+    EXPECT_GT(used, 0);
+
+    a.reset();
+    EXPECT_LT(pool->GetUsedBlocksCount(), used);
+}
+
+TEST(Character_Clone, CharacterClone_WhenCalled_CopiesCharacterWithoutParent) {
+    Row row(0, 0, 10, 1);
+    Glyph::GlyphPtr character = std::make_shared<Character>(1, 0, 1, 1, 'b');
+    row.Add(character);
+
+    Glyph::GlyphPtr copy = character->Clone();
+    ASSERT_NE(copy->As<Character>(), nullptr);
+    EXPECT_EQ(copy->As<Character>()->GetChar(), 'b');
+    EXPECT_EQ(copy->GetPosition().x, 1);
+    EXPECT_EQ(copy->GetParent(), nullptr);
+    EXPECT_EQ(character->GetParent(), &row);
+}
+
+TEST(Character_Size, CharacterSize_WhenCompiled_FitsVtableAndBounds) {
+    // the vtable pointer, the bounds or the place in the container, the
+    // flags and the symbol
+    EXPECT_LE(sizeof(Character), sizeof(void*) + 4 * sizeof(int) + 8);
+}
+//----------------------------------------Memory pool---------------------------------------------
+TEST(MemoryPool_Allocate, MemoryPoolAllocate_WhenCalled_ReusesFreedBlocks) {
+    MemoryPool pool(1024);
+    void* first = pool.Allocate(40);
+    void* second = pool.Allocate(40);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % MemoryPool::kAlignment, 0);
+    EXPECT_EQ(pool.GetUsedBlocksCount(), 2);
+    EXPECT_EQ(pool.GetReservedSize(), 1024);
+
+    pool.Deallocate(first, 40);
+    EXPECT_EQ(pool.Allocate(33), first);
+
+    // large objects are not taken from slabs
+    void* large = pool.Allocate(MemoryPool::kMaxBlockSize + 1);
+    pool.Deallocate(large, MemoryPool::kMaxBlockSize + 1);
+    EXPECT_EQ(pool.GetReservedSize(), 1024);
+    EXPECT_EQ(pool.GetUsedBlocksCount(), 2);
+}
+
+TEST(MemoryPool_AllocateShared,
+     AllocateShared_WhenCalled_KeepsPoolAliveWhileObjectsExist) {
+    auto pool = std::make_shared<MemoryPool>();
+    std::weak_ptr<MemoryPool> weakPool = pool;
+    Character::CharPtr character =
+        AllocateShared<Character>(pool, 1, 2, 3, 4, 'a');
+    EXPECT_EQ(pool->GetUsedBlocksCount(), 1);
+
+    pool.reset();
+    EXPECT_FALSE(weakPool.expired());
+    EXPECT_EQ(character->GetChar(), 'a');
+    character.reset();
+    EXPECT_TRUE(weakPool.expired());
+}
+
+TEST(MemoryPool_Document, DocumentInsertChar_WhenCalled_AllocatesGlyphsInPool) {
+    std::weak_ptr<MemoryPool> weakPool;
+    {
+        Document document(std::make_shared<SimpleCompositor>());
+        weakPool = document.GetGlyphPool();
+        size_t usedBlocks = document.GetGlyphPool()->GetUsedBlocksCount();
+        for (int i = 0; i < 300; ++i) {
+            document.InsertChar('a' + i % 26);
+        }
+        EXPECT_EQ(document.GetGlyphPool()->GetUsedBlocksCount(),
+                  usedBlocks + 300);
+    }
+    EXPECT_TRUE(weakPool.expired());
+}
+//-------------------------------------Glyph container order--------------------------------------
+TEST(GlyphContainer_Order1,
+     GlyphContainerInsertRemove_WhenCalled_KeepsNeighboursOfGlyphs) {
+    Row row(0, 0, 100, 1);
+    Glyph::GlyphList glyphs;
+    for (int i = 0; i < 10; ++i) {
+        Glyph::GlyphPtr character =
+            std::make_shared<Character>(i, 0, 1, 1, 'a' + i);
+        row.Add(character);
+        glyphs.push_back(character);
+    }
+    Glyph::GlyphPtr removed = row.GetGlyphByIndex(3);
+    row.Remove(removed);
+    glyphs.remove(removed);
+
+    int index = 0;
+    for (Glyph::GlyphPtr glyph : glyphs) {
+        EXPECT_EQ(row.GetGlyphIndex(glyph), index);
+        EXPECT_EQ(row.GetGlyphByIndex(index), glyph);
+        ++index;
+    }
+    EXPECT_EQ(row.GetNextGlyph(glyphs.front()), *std::next(glyphs.begin()));
+    EXPECT_EQ(row.GetPreviousGlyph(glyphs.back()), *std::prev(glyphs.end(), 2));
+}
+
+TEST(GlyphContainer_Order2,
+     GlyphContainerSharedGlyph_WhenCalled_FindsGlyphInBothContainers) {
+    Row first(0, 0, 100, 1);
+    Row second(0, 0, 100, 1);
+    Glyph::GlyphPtr a = std::make_shared<Character>(0, 0, 1, 1, 'a');
+    Glyph::GlyphPtr b = std::make_shared<Character>(1, 0, 1, 1, 'b');
+    first.Add(a);
+    first.Add(b);
+    // b has index 0 in the second row and 1 in the first one
+    second.Add(b);
+
+    EXPECT_EQ(first.GetGlyphIndex(b), 1);
+    EXPECT_EQ(first.GetPreviousGlyph(b), a);
+    EXPECT_EQ(second.GetGlyphIndex(b), 0);
+    EXPECT_EQ(second.GetPreviousGlyph(b), nullptr);
+}
+
+TEST(GlyphContainer_Order3,
+     GlyphContainerCopy_WhenCalled_LeavesOriginalComponentsInPlace) {
+    auto row = std::make_shared<Row>(0, 0, 100, 1);
+    Glyph::GlyphPtr a = std::make_shared<Character>(0, 0, 1, 1, 'a');
+    Glyph::GlyphPtr b = std::make_shared<Character>(1, 0, 1, 1, 'b');
+    row->Add(a);
+    row->Add(b);
+    {
+        Row copy(*row);
+        ASSERT_NE(copy.GetGlyphByIndex(1), nullptr);
+        EXPECT_NE(copy.GetGlyphByIndex(1), b);
+        EXPECT_EQ(copy.GetGlyphByIndex(1)->GetPosition().x, 1);
+    }
+    // the copy is gone, the original still receives the geometry of b
+    b->SetWidth(3);
+    EXPECT_EQ(row->GetMetrics().width[1], 3);
+    EXPECT_EQ(row->GetGlyphIndex(b), 1);
+}
+TEST(GlyphContainer_Order4,
+     GlyphContainerGetCharacter_WhenCalled_FindsCharacterByIndex) {
+    auto page = std::make_shared<Page>(0, 0, 100, 100);
+    Glyph::GlyphPtr column = std::make_shared<Column>(0, 0, 100, 100);
+    page->Add(column);
+    std::vector<Glyph::GlyphPtr> characters;
+    for (int i = 0; i < 5; ++i) {
+        Glyph::GlyphPtr row = std::make_shared<Row>(0, i, 100, 1);
+        column->Add(row);
+        // rows hold different numbers of characters, one of them is empty
+        for (int j = 0; j < i % 3; ++j) {
+            Glyph::GlyphPtr character =
+                std::make_shared<Character>(j, i, 1, 1, 'a');
+            row->Add(character);
+            characters.push_back(character);
+        }
+    }
+    ASSERT_EQ(page->GetCharactersCount(), characters.size());
+
+    for (size_t i = 0; i < characters.size(); ++i) {
+        const GlyphContainer* root;
+        EXPECT_EQ(page->GetCharacter(i), characters[i]);
+        EXPECT_EQ(GlyphContainer::CountCharactersBefore(*characters[i], root),
+                  i);
+        EXPECT_EQ(root, page.get());
+    }
+    EXPECT_EQ(page->GetCharacter(characters.size()), nullptr);
+
+    // counts of the outer containers follow the rows
+    Glyph::GlyphPtr removed = characters[1];
+    removed->GetParent()->Remove(removed);
+    characters.erase(characters.begin() + 1);
+    EXPECT_EQ(page->GetCharactersCount(), characters.size());
+    for (size_t i = 0; i < characters.size(); ++i) {
+        EXPECT_EQ(page->GetCharacter(i), characters[i]);
+    }
+}
+//---------------------------------------Document walker------------------------------------------
+TEST(Glyph_GetChildren, GlyphGetChildren_WhenCalled_ReturnsNestedGlyphs) {
+    Character c(0, 0, 1, 1, 'a');
+    EXPECT_TRUE(c.GetChildren().empty());
+
+    Row row(0, 0, 10, 1);
+    Glyph::GlyphPtr a = std::make_shared<Character>(0, 0, 1, 1, 'a');
+    Glyph::GlyphPtr b = std::make_shared<Character>(1, 0, 1, 1, 'b');
+    row.Add(a);
+    row.Add(b);
+    Glyph::GlyphList children(row.GetChildren().begin(),
+                              row.GetChildren().end());
+    EXPECT_EQ(children, Glyph::GlyphList({a, b}));
+}
+
+TEST(DocumentWalker_Walk1,
+     DocumentWalker_WhenCalled_YieldsGlyphsInReadingOrder) {
+    Document document(std::make_shared<SimpleCompositor>(
+        5, 10, 3, 480, Compositor::LEFT, 100));
+    FillDocument(document, 200);
+    ASSERT_GT(document.GetPagesCount(), 2);
+
+    Glyph::GlyphList rows;
+    Glyph::GlyphList characters;
+    for (Page::PagePtr page = document.GetFirstPage(); page != nullptr;
+         page = document.GetNextPage(page)) {
+        for (Glyph::GlyphPtr column = page->GetFirstGlyph(); column != nullptr;
+             column = page->GetNextGlyph(column)) {
+            for (Glyph::GlyphPtr row = column->GetFirstGlyph(); row != nullptr;
+                 row = column->GetNextGlyph(row)) {
+                rows.push_back(row);
+                for (Glyph::GlyphPtr character = row->GetFirstGlyph();
+                     character != nullptr;
+                     character = row->GetNextGlyph(character)) {
+                    characters.push_back(character);
+                }
+            }
+        }
+    }
+
+    DocumentRange documentRows = document.GetRows();
+    EXPECT_EQ(Glyph::GlyphList(documentRows.begin(), documentRows.end()),
+              rows);
+    DocumentRange documentCharacters = document.GetCharacters();
+    EXPECT_EQ(Glyph::GlyphList(documentCharacters.begin(),
+                               documentCharacters.end()),
+              characters);
+    EXPECT_EQ(characters.size(), 200);
+}
+
+TEST(DocumentWalker_Walk2, DocumentWalkerEmptyRows_WhenCalled_SkipsThem) {
+    Document document(std::make_shared<SimpleCompositor>());
+    EXPECT_TRUE(document.GetCharacters().empty());
+    EXPECT_EQ(std::distance(document.GetRows().begin(),
+                            document.GetRows().end()),
+              1);
+
+    // an empty page between pages with characters
+    Page::PagePtr second = std::make_shared<Page>(0, 0, 10, 10);
+    Page::PagePtr third = std::make_shared<Page>(0, 0, 10, 10);
+    Glyph::GlyphPtr a = std::make_shared<Character>(0, 0, 1, 1, 'a');
+    Glyph::GlyphPtr b = std::make_shared<Character>(0, 0, 1, 1, 'b');
+    document.GetFirstPage()->GetFirstGlyph()->GetFirstGlyph()->Add(a);
+    third->GetFirstGlyph()->GetFirstGlyph()->Add(b);
+    document.AddPage(second);
+    document.AddPage(third);
+
+    DocumentRange characters = document.GetCharacters();
+    EXPECT_EQ(Glyph::GlyphList(characters.begin(), characters.end()),
+              Glyph::GlyphList({a, b}));
+}
+//------------------------------------------Hit testing-------------------------------------------
+TEST(Glyph_Intersects_Glyph3,
+     GlyphIntersectsCrossingGlyph_WhenCalled_ReturnFalse) {
+    // no corner of one glyph falls into the other one
+    Character wide(0, 5, 10, 2, 'a');
+    Glyph::GlyphPtr tall = std::make_shared<Character>(4, 0, 2, 10, 'b');
+    EXPECT_FALSE(wide.Intersects(tall));
+
+    Glyph::GlyphPtr touching = std::make_shared<Character>(10, 7, 3, 3, 'c');
+    EXPECT_TRUE(wide.Intersects(touching));
+}
+
+TEST(Row_Select2, RowSelectInLongRow_WhenCalled_ReturnsGlyphsInArea) {
+    Row row(0, 0, 3000, 2);
+    Glyph::GlyphList glyphs;
+    for (int i = 0; i < 1000; ++i) {
+        Glyph::GlyphPtr character =
+            std::make_shared<Character>(i * 3, 0, 2, 2, 'a' + i % 26);
+        row.Add(character);
+        glyphs.push_back(character);
+    }
+
+    Glyph::GlyphPtr area = std::make_shared<Column>(Column(301, 1, 10, 5));
+    Glyph::GlyphList expected;
+    std::copy_if(glyphs.begin(), glyphs.end(), std::back_inserter(expected),
+                 [&](const auto& glyph) { return glyph->Intersects(area); });
+    EXPECT_EQ(expected.size(), 4);
+    EXPECT_EQ(row.Select(area), expected);
+
+    // inserted between the glyphs at 1500 and 1503
+    Glyph::GlyphPtr inserted = std::make_shared<Character>(1502, 0, 1, 2, 'z');
+    row.Insert(inserted);
+    EXPECT_EQ(row.GetGlyphIndex(inserted), 501);
+}
+
+TEST(Column_Insert2, ColumnInsert_WhenCalled_InsertsIntoRowAtPosition) {
+    Document document(std::make_shared<SimpleCompositor>(
+        5, 10, 3, 480, Compositor::LEFT, 100));
+    FillDocument(document, 100);
+
+    Glyph::GlyphPtr column = document.GetFirstPage()->GetFirstGlyph();
+    Glyph::GlyphPtr row = *std::next(column->GetChildren().begin(), 3);
+    Glyph::GlyphPtr character = std::make_shared<Character>(
+        row->GetPosition().x, row->GetPosition().y + 1, 1, 1, 'z');
+    column->Insert(character);
+    EXPECT_EQ(row->GetFirstGlyph(), character);
+}
+//--------------------------------------------Renderer--------------------------------------------
+TEST(Document_Renderer1, DocumentEdit_WhenCalled_OnlyMarksRedraw) {
+    auto renderer = std::make_shared<FramebufferRenderer>();
+    Document document(std::make_shared<SimpleCompositor>());
+    document.SetRenderer(renderer);
+    EXPECT_TRUE(document.IsRedrawNeeded());
+
+    document.DrawDocument();
+    EXPECT_FALSE(document.IsRedrawNeeded());
+    EXPECT_EQ(renderer->GetFramesCount(), 1);
+
+    document.InsertChar('a');
+    document.InsertChar('b');
+    EXPECT_TRUE(document.IsRedrawNeeded());
+    EXPECT_EQ(renderer->GetFramesCount(), 1);
+
+    document.DrawDocument();
+    EXPECT_EQ(renderer->GetFramesCount(), 2);
+    document.MoveCursorLeft();
+    EXPECT_TRUE(document.IsRedrawNeeded());
+}
+
+TEST(Document_Renderer2, FramebufferRenderer_WhenCalled_DrawsCharacters) {
+    auto renderer = std::make_shared<FramebufferRenderer>();
+    Document document(std::make_shared<SimpleCompositor>());
+    document.SetRenderer(renderer);
+    document.InsertChar('a');
+    document.InsertChar('b');
+    document.DrawDocument();
+
+    ASSERT_EQ(renderer->GetPagesCount(), 1);
+    Glyph::GlyphPtr a = document.GetFirstPage()
+                            ->GetFirstGlyph()
+                            ->GetFirstGlyph()
+                            ->GetFirstGlyph();
+    Glyph::GlyphPtr b = document.GetSelectedGlyph();
+    EXPECT_EQ(renderer->GetCell(0, a->GetPosition().x, a->GetPosition().y),
+              'a');
+    EXPECT_EQ(renderer->GetCell(0, b->GetPosition().x, b->GetPosition().y),
+              'b');
+    EXPECT_EQ(renderer->GetCell(0, 0, 0), FramebufferRenderer::kBackground);
+    EXPECT_EQ(renderer->GetCursorPage(), 0);
+    EXPECT_EQ(renderer->GetCursorPosition().x, b->GetRightBorder());
+}
+
+TEST(Document_Renderer3, TextRenderer_WhenCalled_WritesFrameOnPresent) {
+    std::ostringstream os;
+    auto renderer = std::make_shared<TextRenderer>(os);
+    Document document(std::make_shared<SimpleCompositor>());
+    document.SetRenderer(renderer);
+    document.InsertChar('a');
+    EXPECT_TRUE(os.str().empty());
+
+    document.DrawDocument();
+    EXPECT_EQ(os.str(),
+              "-----DrawDocument()\n"
+              "DrawPage(): 500 1000\n"
+              "DrawChar(): x: 3 y: 5 width: 1 height: 1 symbol: a\n"
+              "DrawCursor(): 4 5 1\n");
+}
+
+TEST(DirtyRegion_Add, DirtyRegionAdd_WhenCalled_JoinsTouchingAreas) {
+    Row page(0, 0, 20, 20);
+    DirtyRegion region;
+    EXPECT_TRUE(region.IsEmpty());
+
+    region.Add(&page, Rect(0, 0, 2, 1));
+    region.Add(&page, Rect(2, 0, 2, 1));
+    region.Add(&page, Rect(10, 10, 1, 1));
+    ASSERT_EQ(region.GetRects(&page).size(), 2);
+    EXPECT_EQ(region.GetRects(&page)[0], Rect(0, 0, 4, 1));
+
+    // joins both areas, since the union touches each of them
+    region.Add(&page, Rect(3, 1, 7, 9));
+    ASSERT_EQ(region.GetRects(&page).size(), 1);
+    EXPECT_EQ(region.GetRects(&page)[0], Rect(0, 0, 11, 11));
+
+    region.Remove(&page, Rect(0, 0, 5, 5));
+    EXPECT_FALSE(region.IsEmpty());
+    region.Remove(&page, Rect(0, 0, 20, 20));
+    EXPECT_TRUE(region.IsEmpty());
+
+    region.AddAll();
+    region.Add(&page, Rect(0, 0, 1, 1));
+    EXPECT_TRUE(region.IsAllDirty());
+    EXPECT_TRUE(region.GetRects(&page).empty());
+}
+
+class CountingRenderer : public NullRenderer {
+   public:
+    std::vector<size_t> selectedPages;
+    size_t charsCount = 0;
+
+    void SelectPage(size_t index, int, int) override {
+        selectedPages.push_back(index);
+    }
+    void DrawChar(char, int, int, int, int) override {
+        ++charsCount;
+    }
+};
+
+TEST(Document_DrawDocument1,
+     DocumentDrawDocument_WhenNotLoaded_DrawsOnlyLoadedPages) {
+    std::string text;
+    for (int i = 0; i < 40000; ++i) {
+        text.push_back('a' + i % 26);
+    }
+    auto renderer = std::make_shared<CountingRenderer>();
+    Document document(std::make_shared<SimpleCompositor>(
+        5, 10, 3, 480, Compositor::LEFT, 100));
+    document.SetCharacters(TextBuffer(text), {{text.size(), 1, 1}}, 2);
+    document.SetRenderer(renderer);
+    document.DrawDocument();
+
+    EXPECT_FALSE(document.IsLoaded());
+    EXPECT_GT(renderer->charsCount, 0);
+    EXPECT_LT(renderer->charsCount, text.size());
+}
+
+TEST(Document_Redraw1, DocumentRedraw_WhenCalled_DrawsOnlyVisibleChanges) {
+    auto renderer = std::make_shared<CountingRenderer>();
+    Document document(
+        std::make_shared<SimpleCompositor>(5, 10, 3, 480, Compositor::LEFT, 100));
+    FillDocument(document, 200);
+    ASSERT_GT(document.GetPagesCount(), 2);
+    document.SetRenderer(renderer);
+    document.DrawDocument();
+    EXPECT_EQ(renderer->charsCount, 200);
+
+    renderer->charsCount = 0;
+    InsertAfterCursor(document, 'Z', 1);
+    // the change is on the first page
+    Rect secondPage(0, pageHeight, pageWidth, pageHeight);
+    document.Redraw(secondPage);
+    EXPECT_EQ(renderer->charsCount, 0);
+    EXPECT_TRUE(document.IsRedrawNeeded());
+
+    Rect firstPage(0, 0, pageWidth, pageHeight);
+    document.Redraw(firstPage);
+    EXPECT_GT(renderer->charsCount, 0);
+    EXPECT_LT(renderer->charsCount, 40);
+    EXPECT_EQ(renderer->selectedPages, std::vector<size_t>{0});
+    EXPECT_FALSE(document.IsRedrawNeeded());
+}
+
+TEST(Document_Redraw2, DocumentRedraw_WhenCalled_FrameIsTheSameAsAfterDraw) {
+    auto updated = std::make_shared<FramebufferRenderer>();
+    Document document(
+        std::make_shared<SimpleCompositor>(5, 10, 3, 480, Compositor::LEFT, 100));
+    document.SetRenderer(updated);
+    Rect viewport(0, 0, pageWidth, pageHeight * 100);
+
+    FillDocument(document, 200);
+    document.Redraw(viewport);
+    for (int i = 0; i < 30; ++i) {
+        if (i % 3 == 0) {
+            document.MoveCursorRight();
+        }
+        if (i % 2 == 0) {
+            document.RemoveChar();
+        } else {
+            InsertAfterCursor(document, 'A' + i, 1 + i % 3);
+        }
+        document.Redraw(viewport);
+    }
+    EXPECT_FALSE(document.IsRedrawNeeded());
+
+    auto drawn = std::make_shared<FramebufferRenderer>();
+    document.SetRenderer(drawn);
+    document.DrawDocument();
+    ASSERT_EQ(updated->GetPagesCount(), drawn->GetPagesCount());
+    for (size_t page = 0; page < drawn->GetPagesCount(); ++page) {
+        for (int y = 0; y < pageHeight; ++y) {
+            for (int x = 0; x < pageWidth; ++x) {
+                ASSERT_EQ(updated->GetCell(page, x, y),
+                          drawn->GetCell(page, x, y));
+            }
+        }
+    }
+    EXPECT_EQ(updated->GetCursorPage(), drawn->GetCursorPage());
+    EXPECT_EQ(updated->GetCursorPosition().x, drawn->GetCursorPosition().x);
+    EXPECT_EQ(updated->GetCursorPosition().y, drawn->GetCursorPosition().y);
+}
+
+TEST(DocumentFormat_WriteRead1,
+     DocumentWriteRead_WhenCalled_RestoresCharactersAndLayout) {
+    Document document(std::make_shared<SimpleCompositor>(
+        5, 10, 3, 480, Compositor::CENTER, 100));
+    FillDocument(document, 200);
+    document.InsertChar('Z');
+    ASSERT_GT(document.GetPagesCount(), 2);
+
+    std::stringstream stream;
+    ASSERT_TRUE(DocumentFormat::Write(stream, document));
+    // the layout isn't stored, only the header, the text and size runs
+    EXPECT_EQ(stream.str().size(),
+              53 + 201 + 16 * document.GetCharacterRuns().size());
+
+    std::shared_ptr<Document> loaded = DocumentFormat::Read(stream);
+    ASSERT_NE(loaded, nullptr);
+    EXPECT_EQ(loaded->GetText().GetText(), document.GetText().GetText());
+    EXPECT_EQ(loaded->GetCursorOffset(), document.GetCursorOffset());
+    EXPECT_EQ(loaded->GetCompositor()->GetAlignment(), Compositor::CENTER);
+    EXPECT_EQ(loaded->GetCompositor()->GetRightIndent(), 480);
+    EXPECT_EQ(GetDocumentLayout(*loaded), GetDocumentLayout(document));
+    EXPECT_EQ(loaded->GetSelectedGlyph()->GetPosition().x,
+              document.GetSelectedGlyph()->GetPosition().x);
+    EXPECT_EQ(loaded->GetSelectedGlyph()->GetPosition().y,
+              document.GetSelectedGlyph()->GetPosition().y);
+}
+
+TEST(DocumentFormat_Read2, DocumentRead_WhenCalled_RejectsInvalidStream) {
+    Document document(std::make_shared<SimpleCompositor>());
+    document.InsertChar('a');
+    std::stringstream stream;
+    ASSERT_TRUE(DocumentFormat::Write(stream, document));
+    std::string data = stream.str();
+
+    std::stringstream empty;
+    EXPECT_EQ(DocumentFormat::Read(empty), nullptr);
+
+    std::string wrongMagic = data;
+    wrongMagic[0] = 'X';
+    std::stringstream wrongMagicStream(wrongMagic);
+    EXPECT_EQ(DocumentFormat::Read(wrongMagicStream), nullptr);
+
+    std::string wrongVersion = data;
+    wrongVersion[4] = char(DocumentFormat::kVersion + 1);
+    std::stringstream wrongVersionStream(wrongVersion);
+    EXPECT_EQ(DocumentFormat::Read(wrongVersionStream), nullptr);
+
+    std::stringstream truncated(data.substr(0, data.size() - 1));
+    EXPECT_EQ(DocumentFormat::Read(truncated), nullptr);
+
+    std::stringstream valid(data);
+    EXPECT_NE(DocumentFormat::Read(valid), nullptr);
+}
+
+TEST(DocumentFormat_Map1, DocumentMap_WhenCalled_ComposesPagesOnRequest) {
+    std::string text;
+    for (int i = 0; i < 40000; ++i) {
+        text.push_back('a' + i % 26);
+    }
+    Document document(std::make_shared<SimpleCompositor>(
+        5, 10, 3, 480, Compositor::LEFT, 100));
+    document.SetCharacters(TextBuffer(text), {{text.size(), 1, 1}}, 10);
+    const char* path = "document_format_map_test.lxdf";
+    {
+        std::ofstream ofs(path, std::ios::binary);
+        ASSERT_TRUE(DocumentFormat::Write(ofs, document));
+    }
+
+    std::shared_ptr<Document> mapped = DocumentFormat::Map(path);
+    ASSERT_NE(mapped, nullptr);
+    EXPECT_FALSE(mapped->IsLoaded());
+    EXPECT_EQ(mapped->GetText().GetText(), text);
+    EXPECT_EQ(mapped->GetCursorOffset(), 10);
+    size_t pagesCount = mapped->GetPagesCount();
+    mapped->LoadPages(pagesCount + 5);
+    EXPECT_GT(mapped->GetPagesCount(), pagesCount + 5);
+
+    // edits of loaded pages are kept when the rest is loaded
+    mapped->InsertChar('Z');
+    text.insert(10, 1, 'Z');
+    mapped->LoadAll();
+    EXPECT_TRUE(mapped->IsLoaded());
+    EXPECT_EQ(mapped->GetText().GetText(), text);
+    EXPECT_EQ(mapped->GetCursorOffset(), 11);
+
+    std::string layoutText;
+    for (const auto& glyph : mapped->GetCharacters()) {
+        layoutText.push_back(std::static_pointer_cast<Character>(glyph)->GetChar());
+    }
+    EXPECT_EQ(layoutText, text);
+    std::vector<std::vector<int>> layout = GetDocumentLayout(*mapped);
+    mapped->GetCompositor()->Compose();
+    EXPECT_EQ(GetDocumentLayout(*mapped), layout);
+    std::remove(path);
+}
+
+//----------------------------------------Autosave---------------------------------------------------
+TEST(Document_GetSnapshot1, DocumentGetSnapshot_WhenEdited_KeepsSnapshot) {
+    Document document(std::make_shared<SimpleCompositor>());
+    for (char symbol : std::string("snapshot")) {
+        document.InsertChar(symbol);
+    }
+    DocumentSnapshot snapshot = document.GetSnapshot();
+    document.RemoveChar();
+    document.InsertChar('!');
+
+    EXPECT_EQ(snapshot.text.GetText(), "snapshot");
+    EXPECT_EQ(snapshot.cursorOffset, 8);
+    std::vector<CharacterRun> runs = snapshot.text.GetRuns();
+    ASSERT_EQ(runs.size(), 1);
+    EXPECT_EQ(runs[0].count, 8);
+    EXPECT_EQ(document.GetText().GetText(), "snapsho!");
+}
+
+TEST(Autosave_Save1, AutosaveSave_WhenFlushed_ReplacesFile) {
+    const char* path = "autosave_test.lxdf";
+    Document document(std::make_shared<SimpleCompositor>());
+    std::string text;
+    {
+        Autosave autosave(path);
+        for (int i = 0; i < 200; ++i) {
+            text.push_back('a' + i % 26);
+            document.InsertChar(text.back());
+            autosave.Save(document);
+        }
+        autosave.Flush();
+
+        Autosave::Metrics metrics = autosave.GetMetrics();
+        EXPECT_EQ(metrics.failuresCount, 0);
+        EXPECT_GE(metrics.savesCount, 1);
+        EXPECT_EQ(metrics.savesCount + metrics.skippedCount, 200);
+        EXPECT_GE(metrics.maxSnapshotTime, metrics.lastSnapshotTime);
+        EXPECT_GE(metrics.maxSaveLatency, metrics.lastSaveLatency);
+    }
+
+    std::ifstream ifs(path, std::ios::binary);
+    std::shared_ptr<Document> saved = DocumentFormat::Read(ifs);
+    ASSERT_NE(saved, nullptr);
+    EXPECT_EQ(saved->GetText().GetText(), text);
+    EXPECT_EQ(saved->GetCursorOffset(), text.size());
+    EXPECT_FALSE(std::ifstream(std::string(path) + ".tmp").good());
+    std::remove(path);
+}
+
+//----------------------------------------Batch------------------------------------------------------
+TEST(Document_Batch1, DocumentBatch_WhenEnded_ComposesAsWithoutBatch) {
+    Document expected(std::make_shared<SimpleCompositor>());
+    Document document(std::make_shared<SimpleCompositor>());
+    std::string text;
+    for (int i = 0; i < 2000; ++i) {
+        text.push_back(i % 7 == 6 ? ' ' : 'a' + i % 26);
+    }
+    for (char symbol : text) {
+        expected.InsertChar(symbol);
+    }
+
+    document.BeginBatch();
+    for (char symbol : text) {
+        document.InsertChar(symbol);
+    }
+    document.EndBatch();
+
+    EXPECT_EQ(document.GetText().GetText(), text);
+    EXPECT_EQ(GetLayoutText(document), text);
+    EXPECT_EQ(GetDocumentLayout(document), GetDocumentLayout(expected));
+}
+
+TEST(Document_Batch2, DocumentBatch_WhenEditedInRow_ComposesAsWithoutBatch) {
+    Document expected(std::make_shared<SimpleCompositor>());
+    Document document(std::make_shared<SimpleCompositor>());
+    for (char symbol : std::string("batch of edits")) {
+        expected.InsertChar(symbol);
+        document.InsertChar(symbol);
+    }
+
+    expected.RemoveChar();
+    expected.InsertChar('X');
+    expected.InsertChar('Y');
+    document.BeginBatch();
+    document.RemoveChar();
+    document.InsertChar('X');
+    document.InsertChar('Y');
+    document.EndBatch();
+
+    EXPECT_EQ(document.GetText().GetText(), "batch of editXY");
+    EXPECT_EQ(GetDocumentLayout(document), GetDocumentLayout(expected));
+}
+
+//----------------------------------------Text-------------------------------------------------------
+std::string GetSampleText(size_t length) {
+    std::string text;
+    for (size_t i = 0; i < length; ++i) {
+        text.push_back(i % 7 == 6 ? ' ' : 'a' + i % 26);
+    }
+    return text;
+}
+
+TEST(Document_InsertText1, DocumentInsertText_WhenCalled_ComposesAsInsertChar) {
+    Document expected(std::make_shared<SimpleCompositor>());
+    Document document(std::make_shared<SimpleCompositor>());
+    std::string text = GetSampleText(3000);
+    for (char symbol : text) {
+        expected.InsertChar(symbol);
+    }
+    document.InsertText(text.substr(0, 1000));
+    document.InsertText(text.substr(1000));
+
+    EXPECT_EQ(document.GetText().GetText(), text);
+    EXPECT_EQ(document.GetCursorOffset(), text.size());
+    EXPECT_EQ(GetLayoutText(document), text);
+    EXPECT_EQ(GetDocumentLayout(document), GetDocumentLayout(expected));
+}
+
+TEST(Document_InsertText2, DocumentInsertText_WhenCalledInMiddle_InsertsAtCursor) {
+    Document expected(std::make_shared<SimpleCompositor>());
+    Document document(std::make_shared<SimpleCompositor>());
+    std::string text = GetSampleText(2000);
+    expected.InsertText(text.substr(0, 500) + "inserted" + text.substr(500));
+    document.InsertText(text);
+    for (int i = 0; i < 1500; ++i) {
+        document.MoveCursorLeft();
+    }
+    document.InsertText("inserted");
+
+    EXPECT_EQ(document.GetCursorOffset(), 508);
+    EXPECT_EQ(document.GetText().GetText(), expected.GetText().GetText());
+    EXPECT_EQ(GetLayoutText(document), expected.GetText().GetText());
+    EXPECT_EQ(GetDocumentLayout(document), GetDocumentLayout(expected));
+}
+
+TEST(Document_RemoveRange1, DocumentRemoveRange_WhenCalled_RemovesCharacters) {
+    Document expected(std::make_shared<SimpleCompositor>());
+    Document document(std::make_shared<SimpleCompositor>());
+    std::string text = GetSampleText(200000);
+    expected.InsertText(text.substr(0, 100) + text.substr(150000));
+    document.InsertText(text);
+    ASSERT_GT(document.GetPagesCount(), 1);
+
+    EXPECT_EQ(document.RemoveRange(100, 150000), text.substr(100, 149900));
+    EXPECT_EQ(document.GetCursorOffset(), 100);
+    EXPECT_EQ(document.GetText().GetText(), expected.GetText().GetText());
+    EXPECT_EQ(GetLayoutText(document), expected.GetText().GetText());
+    EXPECT_EQ(GetDocumentLayout(document), GetDocumentLayout(expected));
+
+    EXPECT_EQ(document.RemoveRange(0, 50), text.substr(0, 50));
+    EXPECT_EQ(document.GetCursorOffset(), 0);
+    document.InsertChar('!');
+    EXPECT_EQ(document.GetText().GetText(),
+              "!" + text.substr(50, 50) + text.substr(150000));
+}
+
+TEST(Document_RemoveRange2, DocumentRemoveRange_WhenNotLoaded_LoadsCharacters) {
+    Document document(std::make_shared<SimpleCompositor>());
+    std::string text = GetSampleText(100000);
+    std::istringstream is(text);
+    ASSERT_TRUE(document.ImportText(is));
+    ASSERT_FALSE(document.IsLoaded());
+
+    EXPECT_EQ(document.RemoveRange(90000, 95000), text.substr(90000, 5000));
+    EXPECT_EQ(document.GetCursorOffset(), 90000);
+    document.LoadAll();
+    EXPECT_EQ(GetLayoutText(document),
+              text.substr(0, 90000) + text.substr(95000));
+}
+
+// Returns characters of every row of the document
+std::vector<std::string> GetRowTexts(const Document& document) {
+    std::vector<std::string> rows;
+    for (const auto& row : document.GetRows()) {
+        rows.emplace_back();
+        for (const auto& glyph : row->GetChildren()) {
+            rows.back().push_back(
+                dynamic_cast<const Character*>(glyph.get())->GetChar());
+        }
+    }
+    return rows;
+}
+
+TEST(TextBuffer_Write, TextBufferWrite_WhenCalled_WritesAllPieces) {
+    TextBuffer text(std::string("original"));
+    text.Insert(4, "added");
+    text.Remove(0, 2);
+    std::ostringstream os;
+    ASSERT_TRUE(text.Write(os));
+    EXPECT_EQ(os.str(), text.GetText());
+}
+
+TEST(Document_ImportText1, DocumentImportText_WhenCalled_BreaksRowsOnNewlines) {
+    Document document(std::make_shared<SimpleCompositor>());
+    // UTF-8 bytes of the last word are kept as they are
+    std::string word = "\xd1\x82\xd0\xb5\xd0\xba\xd1\x81\xd1\x82";
+    std::istringstream is("first\nsecond\n\n" + word);
+    ASSERT_TRUE(document.ImportText(is));
+
+    std::vector<std::string> expected = {"first\n", "second\n", "\n", word};
+    EXPECT_EQ(GetRowTexts(document), expected);
+    EXPECT_EQ(document.GetCursorOffset(), 0);
+    std::ostringstream os;
+    ASSERT_TRUE(document.ExportText(os));
+    EXPECT_EQ(os.str(), is.str());
+}
+
+TEST(Document_ImportText2, DocumentImportText_WhenLarge_ExportsWithoutLoading) {
+    Document document(std::make_shared<SimpleCompositor>());
+    std::string text;
+    for (int i = 0; i < 2000; ++i) {
+        text += GetSampleText(i % 200) + "\n";
+    }
+    std::istringstream is(text);
+    ASSERT_TRUE(document.ImportText(is));
+    ASSERT_FALSE(document.IsLoaded());
+
+    std::ostringstream os;
+    ASSERT_TRUE(document.ExportText(os));
+    EXPECT_EQ(os.str(), text);
+    EXPECT_FALSE(document.IsLoaded());
+
+    document.LoadAll();
+    std::vector<std::vector<int>> layout = GetDocumentLayout(document);
+    document.GetCompositor()->Compose();
+    EXPECT_EQ(GetDocumentLayout(document), layout);
+}
+
+TEST(Document_Newline, DocumentEditNewline_WhenCalled_ComposesAsWhole) {
+    Document document(std::make_shared<SimpleCompositor>());
+    std::string text = GetSampleText(3000);
+    document.InsertText(text);
+    for (int i = 0; i < 2000; ++i) {
+        document.MoveCursorLeft();
+    }
+    document.InsertChar('\n');
+    EXPECT_EQ(GetRowTexts(document)[2].back(), '\n');
+    std::vector<std::vector<int>> layout = GetDocumentLayout(document);
+    document.GetCompositor()->Compose();
+    EXPECT_EQ(GetDocumentLayout(document), layout);
+
+    // the paragraphs are joined again
+    document.RemoveChar();
+    EXPECT_EQ(GetLayoutText(document), text);
+    layout = GetDocumentLayout(document);
+    document.GetCompositor()->Compose();
+    EXPECT_EQ(GetDocumentLayout(document), layout);
+}
+
+//----------------------------------------Parallel---------------------------------------------------
+TEST(ThreadPool_ParallelFor, ThreadPoolParallelFor_WhenCalled_RunsEveryIndexOnce) {
+    for (size_t threadsCount : {0, 1, 3}) {
+        ThreadPool pool(threadsCount);
+        std::vector<int> calls(1000);
+        for (int loop = 0; loop < 3; ++loop) {
+            pool.ParallelFor(calls.size(), [&](size_t i) { ++calls[i]; });
+        }
+        EXPECT_EQ(std::count(calls.begin(), calls.end(), 3), 1000);
+    }
+}
+
+TEST(LatestTaskWorker_Schedule1, LatestTaskWorkerSchedule_WhenWorkerIsBusy_RunsOnlyLatestTask) {
+    using Worker = LatestTaskWorker<int>;
+    std::promise<void> started;
+    std::future<void> isStarted = started.get_future();
+    std::promise<void> released;
+    std::shared_future<void> isReleased = released.get_future().share();
+    std::vector<int> tasks;
+    Worker worker(
+        [&](int& task, uint64_t, Worker::Clock::time_point) {
+            if (task == 0) {
+                started.set_value();
+                isReleased.wait();
+            }
+            tasks.push_back(task);
+        },
+        false);
+    auto merge = [](int& replaced, int& next) { next += replaced * 10; };
+
+    Worker::Clock::time_point now = Worker::Clock::now();
+    worker.Schedule(0, now);
+    isStarted.wait();
+    worker.Schedule(1, now);
+    worker.Schedule(2, now, merge);
+    uint64_t number = worker.Schedule(3, now, merge);
+    released.set_value();
+    worker.Flush();
+
+    EXPECT_EQ(number, 4);
+    EXPECT_EQ(worker.GetSkippedCount(), 2);
+    EXPECT_EQ(tasks, std::vector<int>({0, 123}));
+}
+
+TEST(SimpleCompositor_Parallel, ComposeWithThreadPool_WhenCalled_LayoutIsTheSame) {
+    std::string text;
+    for (int i = 0; i < 1000; ++i) {
+        text += GetSampleText(i % 150) + "\n";
+    }
+    for (auto alignment : {Compositor::LEFT, Compositor::CENTER,
+                           Compositor::RIGHT, Compositor::JUSTIFIED}) {
+        auto compositor = std::make_shared<SimpleCompositor>();
+        Document document(compositor);
+        std::istringstream is(text);
+        ASSERT_TRUE(document.ImportText(is));
+        document.LoadAll();
+        compositor->SetAlignment(alignment);
+        compositor->Compose();
+        std::vector<std::vector<int>> layout = GetDocumentLayout(document);
+
+        compositor->SetThreadPool(std::make_shared<ThreadPool>(3));
+        compositor->SetLeftIndent(compositor->GetLeftIndent() + 1);
+        compositor->Compose();
+        compositor->SetLeftIndent(compositor->GetLeftIndent() - 1);
+        compositor->Compose();
+        EXPECT_EQ(GetDocumentLayout(document), layout);
+        EXPECT_EQ(GetLayoutText(document), text);
+    }
+}
+
+//----------------------------------------Background-------------------------------------------------
+std::vector<std::vector<int>> GetSnapshotLayout(const LayoutSnapshot& layout) {
+    std::vector<std::vector<int>> boxes;
+    for (size_t page = 0; page < layout.pages.size(); ++page) {
+        for (const auto& box : layout.pages[page]->characters) {
+            boxes.push_back({int(page), box.symbol, box.rect.x, box.rect.y,
+                             box.rect.width, box.rect.height});
+        }
+    }
+    return boxes;
+}
+
+TEST(BackgroundCompositor_Submit1, DocumentEdit_WhenComposedInBackground_LayoutIsTheSame) {
+    auto backgroundCompositor = std::make_shared<BackgroundCompositor>();
+    Document document(std::make_shared<SimpleCompositor>());
+    document.SetBackgroundCompositor(backgroundCompositor);
+    std::string text;
+    for (int i = 0; i < 3000; ++i) {
+        text.push_back(i % 300 == 299 ? '\n' : 'a' + i % 26);
+        document.InsertChar(text.back());
+    }
+    backgroundCompositor->Flush();
+
+    BackgroundCompositor::Metrics metrics = backgroundCompositor->GetMetrics();
+    EXPECT_GE(metrics.composedCount, 1);
+    EXPECT_EQ(metrics.composedCount + metrics.skippedCount, 3001);
+    EXPECT_GE(metrics.maxComposeLatency, metrics.lastComposeLatency);
+    std::shared_ptr<const LayoutSnapshot> layout =
+        backgroundCompositor->GetLayout();
+    ASSERT_NE(layout, nullptr);
+    EXPECT_EQ(layout->version, document.GetVersion());
+
+    Document expected(std::make_shared<SimpleCompositor>());
+    std::istringstream is(text);
+    ASSERT_TRUE(expected.ImportText(is));
+    expected.LoadAll();
+    EXPECT_EQ(GetSnapshotLayout(*layout),
+              GetSnapshotLayout(expected.GetLayout()));
+
+    // the pages are composed when the document stops composing in background
+    document.SetBackgroundCompositor(nullptr);
+    EXPECT_EQ(GetDocumentLayout(document), GetDocumentLayout(expected));
+    EXPECT_EQ(GetLayoutText(document), text);
+}
+
+TEST(BackgroundCompositor_Draw1, DocumentRedraw_WhenComposedInBackground_DrawsLatestLayout) {
+    auto backgroundCompositor = std::make_shared<BackgroundCompositor>();
+    auto updated = std::make_shared<FramebufferRenderer>();
+    Document document(std::make_shared<SimpleCompositor>());
+    document.SetRenderer(updated);
+    document.SetBackgroundCompositor(backgroundCompositor);
+    Document expected(std::make_shared<SimpleCompositor>());
+    auto drawn = std::make_shared<FramebufferRenderer>();
+    expected.SetRenderer(drawn);
+    Rect viewport(0, 0, pageWidth, pageHeight);
+
+    std::string text = GetSampleText(1000);
+    document.InsertText(text);
+    expected.InsertText(text);
+    for (int i = 0; i < 300; ++i) {
+        document.MoveCursorLeft();
+        expected.MoveCursorLeft();
+    }
+    document.RemoveChar();
+    expected.RemoveChar();
+    backgroundCompositor->Flush();
+    EXPECT_TRUE(document.IsRedrawNeeded());
+    document.Redraw(viewport);
+    EXPECT_FALSE(document.IsRedrawNeeded());
+
+    expected.DrawDocument();
+    ASSERT_EQ(updated->GetPagesCount(), drawn->GetPagesCount());
+    for (int y = 0; y < pageHeight; ++y) {
+        for (int x = 0; x < pageWidth; ++x) {
+            ASSERT_EQ(updated->GetCell(0, x, y), drawn->GetCell(0, x, y));
+        }
+    }
+    EXPECT_EQ(updated->GetCursorPosition().x, drawn->GetCursorPosition().x);
+    EXPECT_EQ(updated->GetCursorPosition().y, drawn->GetCursorPosition().y);
+}
+
+TEST(BackgroundCompositor_Edit1, DocumentEdit_WhenComposedInBackground_ChangesOnlyText) {
+    auto backgroundCompositor = std::make_shared<BackgroundCompositor>();
+    Document document(std::make_shared<SimpleCompositor>());
+    std::string text = GetSampleText(2000);
+    document.InsertText(text);
+    document.SetBackgroundCompositor(backgroundCompositor);
+    size_t charactersCount = GetLayoutText(document).size();
+
+    document.SetCursorOffset(100);
+    document.InsertText("xyz");
+    document.InsertChar('\n');
+    document.RemoveRange(500, 600);
+    document.RemoveChar();
+    text.insert(100, "xyz\n");
+    text.erase(499, 101);
+    EXPECT_EQ(document.GetText().GetText(), text);
+    EXPECT_EQ(document.GetCursorOffset(), 499);
+    // the glyphs catch up with the text only when they are requested
+    EXPECT_FALSE(document.IsLoaded());
+    EXPECT_EQ(GetLayoutText(document).size(), charactersCount);
+
+    backgroundCompositor->Flush();
+    Document expected(std::make_shared<SimpleCompositor>());
+    std::istringstream is(text);
+    ASSERT_TRUE(expected.ImportText(is));
+    expected.LoadAll();
+    EXPECT_EQ(GetSnapshotLayout(*backgroundCompositor->GetLayout()),
+              GetSnapshotLayout(expected.GetLayout()));
+
+    document.SetBackgroundCompositor(nullptr);
+    EXPECT_TRUE(document.IsLoaded());
+    EXPECT_EQ(GetLayoutText(document), text);
+    EXPECT_EQ(GetDocumentLayout(document), GetDocumentLayout(expected));
+}
+
+TEST(BackgroundCompositor_Update1, RandomEdits_WhenComposedIncrementally_LayoutIsTheSame) {
+    auto backgroundCompositor = std::make_shared<BackgroundCompositor>();
+    Document document(std::make_shared<SimpleCompositor>());
+    std::string text;
+    for (int i = 0; i < 20; ++i) {
+        text += GetSampleText(100 + i * 37) + "\n";
+    }
+    document.InsertText(text);
+    document.SetBackgroundCompositor(backgroundCompositor);
+
+    std::srand(11);
+    for (int i = 0; i < 200; ++i) {
+        size_t offset = std::rand() % (text.size() + 1);
+        if (std::rand() % 2 != 0 || text.empty()) {
+            std::string inserted(1 + std::rand() % 40, 'a' + i % 26);
+            if (std::rand() % 4 == 0) {
+                inserted.back() = '\n';
+            }
+            document.SetCursorOffset(offset);
+            document.InsertText(inserted);
+            text.insert(offset, inserted);
+        } else {
+            size_t end = std::min(text.size(), offset + 1 + std::rand() % 60);
+            document.RemoveRange(offset, end);
+            text.erase(offset, end - offset);
+        }
+        if (i % 7 == 0) {
+            backgroundCompositor->Flush();
+            Document expected(std::make_shared<SimpleCompositor>());
+            std::istringstream is(text);
+            ASSERT_TRUE(expected.ImportText(is));
+            expected.LoadAll();
+            ASSERT_EQ(GetSnapshotLayout(*backgroundCompositor->GetLayout()),
+                      GetSnapshotLayout(expected.GetLayout()));
+        }
+    }
+}
+
+TEST(BackgroundCompositor_Update2, DocumentEdit_WhenComposedIncrementally_SharesUnchangedPages) {
+    auto backgroundCompositor = std::make_shared<BackgroundCompositor>();
+    Document document(std::make_shared<SimpleCompositor>());
+    document.SetBackgroundCompositor(backgroundCompositor);
+    std::string text;
+    for (int i = 0; i < 3000; ++i) {
+        text += GetSampleText(10) + "\n";
+    }
+    document.InsertText(text);
+    backgroundCompositor->Flush();
+    std::shared_ptr<const LayoutSnapshot> previous =
+        backgroundCompositor->GetLayout();
+    ASSERT_GT(previous->pages.size(), 2);
+
+    document.InsertChar('x');
+    backgroundCompositor->Flush();
+    std::shared_ptr<const LayoutSnapshot> layout =
+        backgroundCompositor->GetLayout();
+    ASSERT_EQ(layout->pages.size(), previous->pages.size());
+    for (size_t page = 0; page + 1 < layout->pages.size(); ++page) {
+        EXPECT_EQ(layout->pages[page], previous->pages[page]);
+    }
+    EXPECT_NE(layout->pages.back(), previous->pages.back());
+    EXPECT_EQ(layout->GetCharactersCount(), text.size() + 1);
+}
+
+TEST(BackgroundCompositor_Update3, DocumentEdit_WhenComposedInBackground_UsesCompositorOfDocument) {
+    auto backgroundCompositor = std::make_shared<BackgroundCompositor>();
+    auto compositor = std::make_shared<OptimalCompositor>();
+    Document document(compositor);
+    std::string text;
+    for (int i = 0; i < 20; ++i) {
+        for (int j = 0; j < 40; ++j) {
+            text += std::string(1 + (i + j * j) % 80, 'a' + j % 26) + " ";
+        }
+        text += "\n";
+    }
+    document.InsertText(text);
+    document.SetBackgroundCompositor(backgroundCompositor);
+
+    document.SetCursorOffset(100);
+    document.InsertText("some more words ");
+    document.RemoveRange(700, 750);
+    text.insert(100, "some more words ");
+    text.erase(700, 50);
+    backgroundCompositor->Flush();
+    auto expectedCompositor = std::make_shared<OptimalCompositor>();
+    Document expected(expectedCompositor);
+    std::istringstream is(text);
+    ASSERT_TRUE(expected.ImportText(is));
+    expected.LoadAll();
+    EXPECT_EQ(GetSnapshotLayout(*backgroundCompositor->GetLayout()),
+              GetSnapshotLayout(expected.GetLayout()));
+    // the rows are broken differently than by the simple compositor
+    Document simple(std::make_shared<SimpleCompositor>());
+    std::istringstream simpleIs(text);
+    ASSERT_TRUE(simple.ImportText(simpleIs));
+    simple.LoadAll();
+    EXPECT_NE(GetSnapshotLayout(*backgroundCompositor->GetLayout()),
+              GetSnapshotLayout(simple.GetLayout()));
+
+    // the changed settings are used with the next edit
+    compositor->SetAlignment(Compositor::RIGHT);
+    document.InsertChar('x');
+    text.insert(document.GetCursorOffset() - 1, "x");
+    backgroundCompositor->Flush();
+    expectedCompositor->SetAlignment(Compositor::RIGHT);
+    expected.SetCursorOffset(document.GetCursorOffset() - 1);
+    expected.InsertChar('x');
+    EXPECT_EQ(expected.GetText().GetText(), text);
+    EXPECT_EQ(GetSnapshotLayout(*backgroundCompositor->GetLayout()),
+              GetSnapshotLayout(expected.GetLayout()));
+}
+
+TEST(TextChange_Merge1, TextChangeMerge_WhenCalled_CoversBothChanges) {
+    TextChange change = {10, 2, 5};
+    change.Merge({12, 6, 1});
+    EXPECT_EQ(change.offset, 10);
+    EXPECT_EQ(change.removedLength, 5);
+    EXPECT_EQ(change.insertedLength, 3);
+
+    change.Merge({0, 1, 0});
+    EXPECT_EQ(change.offset, 0);
+    EXPECT_EQ(change.removedLength, 15);
+    EXPECT_EQ(change.insertedLength, 12);
+
+    change.Merge({0, 0, 0, true});
+    EXPECT_TRUE(change.isFull);
+    change.Merge({3, 1, 1});
+    EXPECT_TRUE(change.isFull);
+}
+
+//----------------------------------------Optimal----------------------------------------------------
+// Sums squared free space of the rows except the last ones of paragraphs
+long GetRaggedness(const std::vector<std::string>& rows, int width) {
+    long raggedness = 0;
+    for (const std::string& row : rows) {
+        if (!row.empty() && row.back() != '\n') {
+            long space = width - long(row.size());
+            raggedness += space * space;
+        }
+    }
+    return raggedness;
+}
+
+// Fills rows with words while the next one fits
+std::vector<std::string> WrapWords(const std::string& text, int width) {
+    std::vector<std::string> rows(1);
+    std::string word;
+    for (char symbol : text) {
+        word.push_back(symbol);
+        if (symbol != ' ' && symbol != '\n') {
+            continue;
+        }
+        if (rows.back().size() + word.size() > size_t(width)) {
+            rows.emplace_back();
+        }
+        rows.back() += word;
+        word.clear();
+        if (symbol == '\n') {
+            rows.emplace_back();
+        }
+    }
+    rows.pop_back();
+    return rows;
+}
+
+TEST(OptimalCompositor_Compose1, OptimalCompose_WhenCalled_BreaksAfterSpacesWithLessRaggedness) {
+    std::string text;
+    for (int i = 0; i < 60; ++i) {
+        for (int j = 0; j < 40; ++j) {
+            text += std::string(1 + (i + j * j) % 80, 'a' + j % 26) + " ";
+        }
+        text += "\n";
+    }
+    auto compositor = std::make_shared<OptimalCompositor>();
+    Document document(compositor);
+    std::istringstream is(text);
+    ASSERT_TRUE(document.ImportText(is));
+    document.LoadAll();
+
+    EXPECT_EQ(GetLayoutText(document), text);
+    int width = pageWidth - compositor->GetLeftIndent() -
+                compositor->GetRightIndent();
+    std::vector<std::string> rows = GetRowTexts(document);
+    for (const std::string& row : rows) {
+        ASSERT_LE(row.size(), width);
+        EXPECT_TRUE(row.back() == ' ' || row.back() == '\n');
+    }
+    std::vector<std::string> wrapped = WrapWords(text, width);
+    EXPECT_LT(GetRaggedness(rows, width), GetRaggedness(wrapped, width));
+    ExpectSameLayoutAsFullCompose(document);
+
+    // words wider than the row are broken
+    document.InsertText(std::string(1000, 'w'));
+    rows = GetRowTexts(document);
+    EXPECT_NE(std::find(rows.begin(), rows.end(), std::string(width, 'w')),
+              rows.end());
+    ExpectSameLayoutAsFullCompose(document);
+}
+
+TEST(OptimalCompositor_Compose2, OptimalComposeEdit_WhenCalled_SolvesOnlyEditedParagraph) {
+    std::string text;
+    for (int i = 0; i < 40; ++i) {
+        text += GetSampleText(1000 + i * 10) + "\n";
+    }
+    auto compositor = std::make_shared<OptimalCompositor>();
+    Document document(compositor);
+    std::istringstream is(text);
+    ASSERT_TRUE(document.ImportText(is));
+    document.LoadAll();
+    compositor->Compose();
+    size_t solved = compositor->GetSolvedParagraphsCount();
+    compositor->Compose();
+    EXPECT_EQ(compositor->GetSolvedParagraphsCount(), solved);
+    EXPECT_GE(compositor->GetCachedParagraphsCount(), 40);
+
+    for (int i = 0; i < 5000; ++i) {
+        document.MoveCursorRight();
+    }
+    for (int i = 0; i < 40; ++i) {
+        document.InsertChar(i % 5 == 4 ? ' ' : 'x');
+        EXPECT_EQ(compositor->GetSolvedParagraphsCount(), ++solved);
+    }
+    ExpectSameLayoutAsFullCompose(document);
+    EXPECT_EQ(compositor->GetSolvedParagraphsCount(), solved);
+}
+
+TEST(OptimalCompositor_Compose3, OptimalComposeEdit_WhenCalled_LayoutIsTheSameAsAfterFullCompose) {
+    Document document(std::make_shared<OptimalCompositor>());
+    std::string text;
+    for (int i = 0; i < 2000; ++i) {
+        char symbol = i % 400 == 399 ? '\n' : (i % 6 == 5 ? ' ' : 'a' + i % 26);
+        document.InsertChar(symbol);
+        if (i % 3 == 2) {
+            document.MoveCursorLeft();
+        }
+        if (i % 7 == 6) {
+            document.RemoveChar();
+        }
+        if (i % 100 == 0) {
+            ExpectSameLayoutAsFullCompose(document);
+        }
+    }
+    ExpectSameLayoutAsFullCompose(document);
+}
+
+//----------------------------------------Kernels----------------------------------------------------
+TEST(MetricsKernels_All, MetricsKernels_WhenCalled_AllInstructionSetsMatchScalar) {
+    MetricsKernels::InstructionSet supported =
+        MetricsKernels::GetSupportedInstructionSet();
+    for (size_t count : {0, 1, 3, 4, 7, 8, 9, 17, 64, 100}) {
+        std::vector<int> values(count);
+        for (size_t i = 0; i < count; ++i) {
+            values[i] = int((i * 37 + count) % 23) - 5;
+        }
+        MetricsKernels::SetInstructionSet(MetricsKernels::SCALAR);
+        int sum = MetricsKernels::Sum(values.data(), count);
+        int max = MetricsKernels::Max(values.data(), count);
+        std::vector<int> sums(count);
+        MetricsKernels::PrefixSum(values.data(), count, sums.data());
+        std::vector<size_t> found;
+        for (int limit : {-10, 0, 10, 50, 1000}) {
+            found.push_back(MetricsKernels::FindGreater(sums.data(), count, limit));
+        }
+
+        for (auto set : {MetricsKernels::SSE2, MetricsKernels::AVX2}) {
+            MetricsKernels::SetInstructionSet(set);
+            EXPECT_EQ(MetricsKernels::GetInstructionSet(), std::min(set, supported));
+            EXPECT_EQ(MetricsKernels::Sum(values.data(), count), sum);
+            EXPECT_EQ(MetricsKernels::Max(values.data(), count), max);
+            std::vector<int> setSums = values;
+            MetricsKernels::PrefixSum(setSums.data(), count, setSums.data());
+            EXPECT_EQ(setSums, sums);
+            size_t i = 0;
+            for (int limit : {-10, 0, 10, 50, 1000}) {
+                EXPECT_EQ(MetricsKernels::FindGreater(sums.data(), count, limit),
+                          found[i++]);
+            }
+        }
+    }
+    MetricsKernels::SetInstructionSet(supported);
+}
+
+//----------------------------------------Metrics----------------------------------------------------
+void ExpectMetricsOfComponents(const Glyph::GlyphPtr& glyph) {
+    auto container = std::dynamic_pointer_cast<GlyphContainer>(glyph);
+    if (container == nullptr) {
+        return;
+    }
+    const GlyphMetrics& metrics = container->GetMetrics();
+    Glyph::ChildrenRange children = container->GetChildren();
+    ASSERT_EQ(metrics.GetSize(),
+              size_t(std::distance(children.begin(), children.end())));
+    size_t i = 0;
+    for (const auto& component : children) {
+        EXPECT_EQ(metrics.GetRect(i), component->GetRect());
+        auto character = std::dynamic_pointer_cast<Character>(component);
+        EXPECT_EQ(metrics.symbols[i],
+                  character != nullptr ? character->GetChar() : '\0');
+        ExpectMetricsOfComponents(component);
+        ++i;
+    }
+}
+
+TEST(GlyphMetrics_Row, RowEdit_WhenCalled_MetricsMatchCharacters) {
+    auto row = std::make_shared<Row>(0, 0, 100, 1);
+    Glyph::GlyphPtr first = std::make_shared<Character>(0, 0, 2, 1, 'a');
+    Glyph::GlyphPtr second = std::make_shared<Character>(0, 0, 3, 4, 'b');
+    Glyph::GlyphPtr third = std::make_shared<Character>(0, 0, 1, 1, 'c');
+    row->Add(first);
+    row->InsertAfter(Glyph::GlyphVector{second, third}, nullptr);
+    ExpectMetricsOfComponents(row);
+    EXPECT_EQ(row->GetMetrics().symbols, std::vector<char>({'b', 'c', 'a'}));
+
+    first->SetPosition(10, 2);
+    std::static_pointer_cast<Character>(third)->SetChar('d');
+    row->Remove(second);
+    ExpectMetricsOfComponents(row);
+    EXPECT_EQ(row->GetMetrics().x, std::vector<int>({3, 10}));
+    EXPECT_EQ(row->GetMetrics().symbols, std::vector<char>({'d', 'a'}));
+}
+
+TEST(GlyphMetrics_Detach, RowRemove_WhenCalled_GlyphKeepsItsMetrics) {
+    auto row = std::make_shared<Row>(0, 0, 100, 1);
+    Glyph::GlyphPtr glyph = std::make_shared<Character>(0, 0, 2, 1, 'a');
+    row->Add(glyph);
+    // a placed glyph is changed through the metrics of its row
+    glyph->SetGlyphParams(5, 6, 7, 8);
+    std::static_pointer_cast<Character>(glyph)->SetChar('z');
+    EXPECT_EQ(row->GetMetrics().GetRect(0), Rect(5, 6, 7, 8));
+    EXPECT_EQ(row->GetMetrics().symbols[0], 'z');
+
+    row->Remove(glyph);
+    EXPECT_EQ(glyph->GetParent(), nullptr);
+    EXPECT_EQ(glyph->GetRect(), Rect(5, 6, 7, 8));
+    EXPECT_EQ(std::static_pointer_cast<Character>(glyph)->GetChar(), 'z');
+    glyph->SetWidth(3);
+    EXPECT_EQ(glyph->GetWidth(), 3);
+}
+
+TEST(GlyphMetrics_Document, DocumentEdit_WhenCalled_MetricsMatchGlyphs) {
+    Document document(std::make_shared<SimpleCompositor>());
+    for (int i = 0; i < 3000; ++i) {
+        document.InsertChar(i % 300 == 299 ? '\n' : 'a' + i % 26);
+        if (i % 5 == 4) {
+            document.MoveCursorLeft();
+        }
+        if (i % 7 == 6) {
+            document.RemoveChar();
+        }
+    }
+    for (const auto& page : document.GetPages()) {
+        ExpectMetricsOfComponents(page);
+    }
+}
+
+//----------------------------------------Kinds------------------------------------------------------
+TEST(Glyph_As, GlyphAs_WhenCalled_CastsOnlyToClassOfGlyph) {
+    Glyph::GlyphPtr character = std::make_shared<Character>(0, 0, 1, 1, 'a');
+    Glyph::GlyphPtr row = std::make_shared<Row>(0, 0, 10, 1);
+    Glyph::GlyphPtr column = std::make_shared<Column>(0, 0, 10, 10);
+    Glyph::GlyphPtr page = std::make_shared<Page>(0, 0, 10, 10);
+
+    EXPECT_EQ(character->GetKind(), Glyph::CHARACTER);
+    EXPECT_EQ(row->GetKind(), Glyph::ROW);
+    EXPECT_EQ(column->GetKind(), Glyph::COLUMN);
+    EXPECT_EQ(page->GetKind(), Glyph::PAGE);
+    EXPECT_EQ(character->Clone()->GetKind(), Glyph::CHARACTER);
+
+    EXPECT_EQ(character->As<Character>(), character.get());
+    EXPECT_EQ(row->As<Row>(), row.get());
+    EXPECT_EQ(character->As<Row>(), nullptr);
+    EXPECT_EQ(row->As<Character>(), nullptr);
+    EXPECT_EQ(page->As<Column>(), nullptr);
+
+    EXPECT_FALSE(character->IsContainer());
+    EXPECT_TRUE(row->IsContainer());
+    EXPECT_TRUE(column->IsContainer());
+    EXPECT_TRUE(page->IsContainer());
+}
+
+class CountingVisitor : public GlyphVisitor {
+   public:
+    int characters = 0;
+    int rows = 0;
+
+    void VisitCharacter(Character&) override { ++characters; }
+    void VisitRow(Row& row) override {
+        ++rows;
+        for (const auto& glyph : row.GetChildren()) {
+            glyph->Accept(*this);
+        }
+    }
+    void VisitColumn(Column& column) override {
+        for (const auto& glyph : column.GetChildren()) {
+            glyph->Accept(*this);
+        }
+    }
+    void VisitPage(Page& page) override {
+        for (const auto& glyph : page.GetChildren()) {
+            glyph->Accept(*this);
+        }
+    }
+};
+
+TEST(GlyphVisitor_Accept, GlyphAccept_WhenCalled_VisitsByClassOfGlyph) {
+    Document document(std::make_shared<SimpleCompositor>());
+    std::string text = "abc\ndef";
+    for (char c : text) {
+        document.InsertChar(c);
+    }
+    CountingVisitor visitor;
+    for (const auto& page : document.GetPages()) {
+        page->Accept(visitor);
+    }
+    EXPECT_EQ(visitor.characters, static_cast<int>(text.size()));
+    EXPECT_EQ(visitor.rows, 2);
+}
+
+//----------------------------------------Cursor-----------------------------------------------------
+TEST(Document_CursorAffinity, DocumentSetCursor_WhenOnRowBoundary_DrawsByAffinity) {
+    auto renderer = std::make_shared<FramebufferRenderer>();
+    Document document(std::make_shared<SimpleCompositor>());
+    document.SetRenderer(renderer);
+    document.InsertText(std::string(600, 'a'));
+    std::vector<Glyph::GlyphPtr> rows(document.GetRows().begin(),
+                                      document.GetRows().end());
+    ASSERT_EQ(rows.size(), 2);
+    size_t boundary = std::distance(rows[0]->GetChildren().begin(),
+                                    rows[0]->GetChildren().end());
+    Glyph::GlyphPtr last = rows[0]->GetLastGlyph();
+    Glyph::GlyphPtr next = rows[1]->GetFirstGlyph();
+
+    Cursor cursor;
+    cursor.offset = boundary;
+    document.SetCursor(cursor);
+    document.DrawDocument();
+    EXPECT_EQ(renderer->GetCursorPosition().x, last->GetRightBorder());
+    EXPECT_EQ(renderer->GetCursorPosition().y, last->GetPosition().y);
+
+    cursor.affinity = Cursor::DOWNSTREAM;
+    document.SetCursor(cursor);
+    document.DrawDocument();
+    EXPECT_EQ(renderer->GetCursorPosition().x, next->GetPosition().x);
+    EXPECT_EQ(renderer->GetCursorPosition().y, next->GetPosition().y);
+
+    // the affinity changes only where the cursor is drawn
+    document.InsertChar('b');
+    EXPECT_EQ(document.GetText().GetText(boundary, 1), "b");
+    EXPECT_EQ(document.GetCursorOffset(), boundary + 1);
+}
+
+TEST(Document_CursorCompose, DocumentCompose_WhenRowsChange_KeepsCursorOffset) {
+    Document document(std::make_shared<SimpleCompositor>());
+    std::string text;
+    for (int i = 0; i < 3000; ++i) {
+        text.push_back(i % 400 == 399 ? '\n' : 'a' + i % 26);
+    }
+    document.InsertText(text);
+    document.SetCursorOffset(1234);
+
+    // other indents move characters to other rows
+    document.SetCompositor(std::make_shared<SimpleCompositor>(
+        10, 10, 30, 30, Compositor::LEFT, 5));
+    EXPECT_EQ(document.GetCursorOffset(), 1234);
+    auto selected =
+        std::static_pointer_cast<Character>(document.GetSelectedGlyph());
+    EXPECT_EQ(selected->GetChar(), text[1233]);
+
+    document.RemoveChar();
+    EXPECT_EQ(document.GetCursorOffset(), 1233);
+    EXPECT_EQ(document.GetText().GetText(), text.erase(1233, 1));
+}
+
+TEST(Document_CursorPage, DocumentInsertChar_WhenCursorOnNextPage_InsertsAtCursorOffset) {
+    Document document(std::make_shared<SimpleCompositor>());
+    std::string text;
+    for (int i = 0; i < 50000; ++i) {
+        text.push_back(i % 97 == 96 ? '\n' : 'a' + i % 26);
+    }
+    std::istringstream is(text);
+    document.ImportText(is);
+    document.LoadAll();
+    ASSERT_GT(document.GetPagesCount(), 1);
+
+    document.SetCursorOffset(40000);
+    document.InsertChar('X');
+    EXPECT_EQ(document.GetText().GetText().find('X'), 40000);
+    EXPECT_EQ(document.GetCursorOffset(), 40001);
+    // the character is placed on the page of the cursor
+    const Glyph* page = document.GetSelectedGlyph().get();
+    while (page->GetParent() != nullptr) {
+        page = page->GetParent();
+    }
+    EXPECT_NE(page, document.GetFirstPage().get());
+}